@@ -0,0 +1,83 @@
+#include "ternion.h"
+
+/**
+ * GPIO toggle-rate benchmark.
+ * Toggles LED0 (RB4) with the gpio.h API, the fastio runtime table and the FASTIO macros,
+ * and prints the toggle rate and the cycles per toggle to UART1.
+ * The loop overhead (empty loop) is subtracted from the results.
+ */
+
+#define BENCH_ITERATIONS	50000UL
+
+static volatile uint16_t bench_sink;
+
+static uint32_t bench_empty(void)
+{
+	uint32_t i, t0 = system_tick_get_ticks();
+	for (i = 0; i < BENCH_ITERATIONS; i++)
+	{
+		bench_sink = i;
+	}
+	return system_tick_get_ticks() - t0;
+}
+
+static uint32_t bench_gpio_api(gpio_num_t gpio_num)
+{
+	uint32_t i, t0 = system_tick_get_ticks();
+	for (i = 0; i < BENCH_ITERATIONS; i++)
+	{
+		bench_sink = i;
+		gpio_toggle_level(gpio_num);
+	}
+	return system_tick_get_ticks() - t0;
+}
+
+static uint32_t bench_fastio_table(gpio_num_t gpio_num)
+{
+	uint32_t i, t0 = system_tick_get_ticks();
+	for (i = 0; i < BENCH_ITERATIONS; i++)
+	{
+		bench_sink = i;
+		fastio_toggle(gpio_num);
+	}
+	return system_tick_get_ticks() - t0;
+}
+
+static uint32_t bench_fastio_macro(void)
+{
+	uint32_t i, t0 = system_tick_get_ticks();
+	for (i = 0; i < BENCH_ITERATIONS; i++)
+	{
+		bench_sink = i;
+		FASTIO_TOGGLE(GPIO_LED_NUM_0);
+	}
+	return system_tick_get_ticks() - t0;
+}
+
+static void bench_report(const char *name, uint32_t ms, uint32_t empty_ms)
+{
+	uint32_t net = (ms > empty_ms) ? (ms - empty_ms) : 1;
+	double cycles = (double)net * 1e-3 * FCY / BENCH_ITERATIONS;
+	double rate = BENCH_ITERATIONS / ((double)net * 1e-3);
+	uart_printf(UART_NUM_1, "%-16s %6lu ms  %8.0f toggles/s  %6.1f cycles/toggle\r\n", name, ms, rate, cycles);
+}
+
+int main(void)
+{
+	// Initialize the system.
+	ternion_init(0);
+
+	// Use a runtime pin number for the API and the table versions.
+	volatile gpio_num_t led = (gpio_num_t)GPIO_LED_NUM_0;
+
+	uart_printf(UART_NUM_1, "GPIO toggle benchmark, %lu toggles, FCY %lu Hz\r\n", BENCH_ITERATIONS, (uint32_t)FCY);
+
+	uint32_t empty = bench_empty();
+	bench_report("empty loop", empty, 0);
+	bench_report("gpio_toggle", bench_gpio_api(led), empty);
+	bench_report("fastio_toggle", bench_fastio_table(led), empty);
+	bench_report("FASTIO_TOGGLE", bench_fastio_macro(), empty);
+
+	// Start the system.
+	ternion_start(0);
+}
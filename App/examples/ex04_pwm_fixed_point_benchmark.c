@@ -0,0 +1,89 @@
+#include "ternion.h"
+
+/**
+ * PWM update benchmark.
+ * Updates the duty of PWM0 (LED0, RB4) with the float API (pwm_set_duty_ratio) and the
+ * fixed-point API (pwmfx_set_duty_q15, pwmfx_set_duty_ticks), and prints the cycles per update
+ * to UART1. The loop overhead (empty loop) is subtracted from the results.
+ */
+
+#define BENCH_ITERATIONS	20000UL
+
+static volatile uint16_t bench_sink;
+
+static uint32_t bench_empty(void)
+{
+	uint32_t i, t0 = system_tick_get_ticks();
+	for (i = 0; i < BENCH_ITERATIONS; i++)
+	{
+		bench_sink = i;
+	}
+	return system_tick_get_ticks() - t0;
+}
+
+static uint32_t bench_float(void)
+{
+	uint32_t i, t0 = system_tick_get_ticks();
+	for (i = 0; i < BENCH_ITERATIONS; i++)
+	{
+		bench_sink = i;
+		pwm_set_duty_ratio(PWM_NUM_0, (float)(i & 0x7FFF) * (1.0f / 32768.0f));
+	}
+	return system_tick_get_ticks() - t0;
+}
+
+static uint32_t bench_q15(void)
+{
+	uint32_t i, t0 = system_tick_get_ticks();
+	for (i = 0; i < BENCH_ITERATIONS; i++)
+	{
+		bench_sink = i;
+		pwmfx_set_duty_q15(PWM_NUM_0, (pwmfx_q15_t)(i & 0x7FFF));
+	}
+	return system_tick_get_ticks() - t0;
+}
+
+static uint32_t bench_ticks(void)
+{
+	uint32_t i, t0 = system_tick_get_ticks();
+	for (i = 0; i < BENCH_ITERATIONS; i++)
+	{
+		bench_sink = i;
+		pwmfx_set_duty_ticks(PWM_NUM_0, (uint16_t)i & 0x1FFF);
+	}
+	return system_tick_get_ticks() - t0;
+}
+
+static void bench_report(const char *name, uint32_t ms, uint32_t empty_ms)
+{
+	uint32_t net = (ms > empty_ms) ? (ms - empty_ms) : 1;
+	double cycles = (double)net * 1e-3 * FCY / BENCH_ITERATIONS;
+	uart_printf(UART_NUM_1, "%-20s %6lu ms  %6.1f cycles/update\r\n", name, ms, cycles);
+}
+
+int main(void)
+{
+	// Initialize the system.
+	ternion_init(0);
+
+	// 1 kHz PWM on LED0.
+	pwm_create(PWM_NUM_0, PWM_GROUP_A, 1000, 0.5, 0.0, (rpo_num_t)GPIO_LED_NUM_0);
+	pwm_start(PWM_NUM_0);
+
+	uart_printf(UART_NUM_1, "PWM duty update benchmark, %lu updates, FCY %lu Hz\r\n", BENCH_ITERATIONS, (uint32_t)FCY);
+
+	uint32_t empty = bench_empty();
+	bench_report("empty loop", empty, 0);
+	bench_report("pwm_set_duty_ratio", bench_float(), empty);
+	bench_report("pwmfx_set_duty_q15", bench_q15(), empty);
+	bench_report("pwmfx_set_duty_ticks", bench_ticks(), empty);
+
+	// Frequency change with a precomputed period.
+	pwmfx_period_t period_2k;
+	pwmfx_period_compute(2000, &period_2k);
+	pwmfx_set_period(PWM_GROUP_A, &period_2k);
+	uart_printf(UART_NUM_1, "2 kHz: PR %u, TCKPS %u, duty %u ticks\r\n", period_2k.pr, period_2k.tckps, pwmfx_get_duty_ticks(PWM_NUM_0));
+
+	// Start the system.
+	ternion_start(0);
+}
@@ -0,0 +1,51 @@
+#include "ternion.h"
+
+/**
+ * Stepper step-rate test.
+ * Runs moves of 20000 steps on a step/dir driver (STEP: RB10, DIR: RB11) with rising cruise
+ * rates, and prints the peak rate measured on the step pin and the late steps (slips) of each
+ * move to UART1. The highest rate reached without slips is the maximum step rate of the OC interrupt.
+ * Two servos (RB8, RB9) run at the same time.
+ */
+
+#define STEP_MOVE_STEPS		20000L
+#define STEP_ACCEL			50000UL
+
+static const gpio_num_t servo_pins[2] = { GPIO_NUM_24, GPIO_NUM_25 };	// RB8, RB9
+static const uint16_t step_rates[] = { 5000, 10000, 20000, 30000, 40000, 50000 };
+
+int main(void)
+{
+	uint16_t i;
+
+	// Initialize the system.
+	ternion_init(0);
+
+	// OC3-OC5 on the free-running Timer3 (0.5 us ticks).
+	ocgen_init(OCGEN_TIMER_3, 0x1C);
+
+	motion_servo_init(servo_pins, 2);
+	motion_servo_set_us(0, 1000);
+	motion_servo_set_us(1, 2000);
+
+	motion_stepper_create(MOTION_STEPPER_0, GPIO_NUM_26, GPIO_NUM_27);	// RB10, RB11
+	motion_stepper_t *stepper = motion_stepper_get_object(MOTION_STEPPER_0);
+
+	uart_printf(UART_NUM_1, "Step rate test, %ld steps, %lu steps/s^2\r\n", STEP_MOVE_STEPS, STEP_ACCEL);
+	for (i = 0; i < sizeof(step_rates) / sizeof(step_rates[0]); i++)
+	{
+		uint16_t slips = stepper->slips;
+		if (motion_stepper_move(MOTION_STEPPER_0, (i & 1) ? -STEP_MOVE_STEPS : STEP_MOVE_STEPS, step_rates[i], STEP_ACCEL, NULL) != SYS_OK)
+		{
+			uart_printf(UART_NUM_1, "%5u steps/s: rejected\r\n", step_rates[i]);
+			continue;
+		}
+		while (stepper->state != MOTION_STATE_IDLE);
+		uart_printf(UART_NUM_1, "%5u steps/s: measured %lu steps/s, %u slips\r\n",
+			step_rates[i], motion_stepper_get_peak_rate(MOTION_STEPPER_0), stepper->slips - slips);
+	}
+	uart_printf(UART_NUM_1, "Servo slips: %u\r\n", motion_servo_get_slips());
+
+	// Start the system.
+	ternion_start(0);
+}
@@ -0,0 +1,91 @@
+#include "ternion.h"
+
+/**
+ * Command dispatch benchmark.
+ * Dispatches typical command lines with cmdex_dispatch() (the path of the line receiver
+ * callback without the replies) and prints the commands per second to UART1.
+ * The copy of the line (the tokenizer works in place) is measured separately and subtracted.
+ * After the benchmark, the commands are served from the UART1 line receiver.
+ */
+
+#define BENCH_ITERATIONS	5000UL
+
+static volatile int32_t bench_sink;
+
+static sys_error_t cmd_gain(const cmdex_args_t *args)
+{
+	bench_sink = args->value[1] + args->value[2];
+	return SYS_OK;
+}
+
+static sys_error_t cmd_mode(const cmdex_args_t *args)
+{
+	bench_sink = (args->argc > 2) ? args->value[2] : 0;
+	return SYS_OK;
+}
+
+static sys_error_t cmd_stop(const cmdex_args_t *args)
+{
+	bench_sink = 0;
+	return SYS_OK;
+}
+
+/** Sorted by name */
+static const cmdex_command_t commands[] = {
+	{ "gain", cmd_gain, "ii",  "gain <kp> <ki>" },
+	{ "mode", cmd_mode, "s?i", "mode <name> [level]" },
+	{ "stop", cmd_stop, "",    "stop" }
+};
+
+static const char *bench_lines[] = {
+	"gain 1200 -35",
+	"mode fast 0x1F",
+	"stop",
+	"pwm 0 250"
+};
+
+#define BENCH_LINE_COUNT	(sizeof(bench_lines) / sizeof(bench_lines[0]))
+
+static uint32_t bench_run(bool dispatch)
+{
+	char line[32];
+	uint32_t i, t0 = system_tick_get_ticks();
+	for (i = 0; i < BENCH_ITERATIONS; i++)
+	{
+		strcpy(line, bench_lines[i % BENCH_LINE_COUNT]);
+		if (dispatch)
+		{
+			cmdex_dispatch(line, SERIAL_NUM_1);
+		}
+		else
+		{
+			bench_sink = line[0];
+		}
+	}
+	return system_tick_get_ticks() - t0;
+}
+
+int main(void)
+{
+	// Initialize the system.
+	ternion_init(0);
+
+	cmdex_register(commands, sizeof(commands) / sizeof(commands[0]));
+
+	// 1 kHz PWM on LED0 for the "pwm" built-in.
+	pwm_create(PWM_NUM_0, PWM_GROUP_A, 1000, 0.5, 0.0, (rpo_num_t)GPIO_LED_NUM_0);
+	pwm_start(PWM_NUM_0);
+
+	uint32_t copy = bench_run(false);
+	uint32_t total = bench_run(true);
+	uint32_t net = (total > copy) ? (total - copy) : 1;
+
+	uart_printf(UART_NUM_1, "cmdex: %lu lines in %lu ms (copy %lu ms), %lu commands/s, %.1f cycles/command\r\n",
+		BENCH_ITERATIONS, total, copy, BENCH_ITERATIONS * 1000UL / net, (double)net * 1e-3 * FCY / BENCH_ITERATIONS);
+
+	// Serve the commands of UART1.
+	cmdex_init(SERIAL_NUM_1, 64);
+
+	// Start the system.
+	ternion_start(0);
+}
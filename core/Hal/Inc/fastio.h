@@ -0,0 +1,362 @@
+/*
+************************************************************
+* FASTIO Header File                                       *
+* (Inline GPIO access)                                     *
+************************************************************
+* File:    fastio.h                                        *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+/**
+ * The gpio_set_level(), gpio_toggle_level() and gpio_get_level() resolve the
+ * register and the bit mask at runtime (gpio_get_lat_reg, gpio_select_reg,
+ * gpio_get_bit_mask) on every call.
+ *
+ * The FASTIO_* macros resolve a constant gpio_num_t at compile time. With a constant
+ * argument the compiler emits a single BSET/BCLR/BTG/BTSC instruction on LATx/PORTx,
+ * which is also atomic with respect to the interrupts.
+ *
+ *   FASTIO_SET(GPIO_LED_NUM_0);          // bset LATB, #4
+ *   FASTIO_TOGGLE(GPIO_RB_8);            // btg  LATB, #8
+ *   if (FASTIO_GET(GPIO_PSW_NUM_0)) ...  // btsc PORTB, #0
+ *
+ * Runtime (non-constant) pin numbers use the const descriptor table, gpio_pin_table[],
+ * through the fastio_* inline functions. They cost a table lookup and a read-modify-write.
+ *
+ * The fastio_port_* functions access a whole port (masked write, set, clear, toggle and
+ * snapshot read), and a fastio_group_t maps logical bit indices (e.g. LED<3:0>, PSW<3:0>)
+ * to port masks once, so the four LEDs or PSWs are read or written with one register access.
+ */
+
+#ifndef __FASTIO_H__
+#define __FASTIO_H__
+
+#include <gpio.h>
+
+/**
+ * Compile-time register and mask of a gpio_num_t constant.
+ * Bit 4 of the gpio_num selects the port (GPIO_RA_x = 0x00-0x04, GPIO_RB_x = 0x10-0x1F).
+ */
+#define FASTIO_LAT(gpio_num)		(*((((gpio_num) & 0x10) != 0) ? &LATB  : &LATA))
+#define FASTIO_PORT(gpio_num)		(*((((gpio_num) & 0x10) != 0) ? &PORTB : &PORTA))
+#define FASTIO_TRIS(gpio_num)		(*((((gpio_num) & 0x10) != 0) ? &TRISB : &TRISA))
+#define FASTIO_MASK(gpio_num)		(1u << ((gpio_num) & 0x0F))
+
+/**
+ * Compile-time pin operations. The gpio_num should be a constant expression.
+ * Note:
+ * - The GPIO must be configured (digital mode and direction) before using these macros.
+ */
+#define FASTIO_SET(gpio_num)		(FASTIO_LAT(gpio_num) |=  FASTIO_MASK(gpio_num))
+#define FASTIO_CLEAR(gpio_num)		(FASTIO_LAT(gpio_num) &= ~FASTIO_MASK(gpio_num))
+#define FASTIO_TOGGLE(gpio_num)		(FASTIO_LAT(gpio_num) ^=  FASTIO_MASK(gpio_num))
+#define FASTIO_GET(gpio_num)		((FASTIO_PORT(gpio_num) & FASTIO_MASK(gpio_num)) != 0)
+#define FASTIO_WRITE(gpio_num, level)	((level) ? FASTIO_SET(gpio_num) : FASTIO_CLEAR(gpio_num))
+#define FASTIO_OUTPUT(gpio_num)		(FASTIO_TRIS(gpio_num) &= ~FASTIO_MASK(gpio_num))
+#define FASTIO_INPUT(gpio_num)		(FASTIO_TRIS(gpio_num) |=  FASTIO_MASK(gpio_num))
+
+/**
+ * Pin descriptor.
+ * Members:
+ * - lat: Pointer to LATA or LATB.
+ * - port: Pointer to PORTA or PORTB.
+ * - mask: Bit mask of the pin, 0 for the pins that are not available (RA5-RA15).
+ */
+typedef struct GPIO_PIN_STRUCT
+{
+	volatile uint16_t *lat;
+	volatile uint16_t *port;
+	uint16_t mask;
+} gpio_pin_t;
+
+/**
+ * Compile-time initializer of a pin descriptor, e.g.
+ * static const gpio_pin_t led = FASTIO_PIN_INIT(GPIO_LED_NUM_0);
+ */
+#define FASTIO_PIN_INIT(gpio_num)	{ &FASTIO_LAT(gpio_num), &FASTIO_PORT(gpio_num), FASTIO_MASK(gpio_num) }
+
+/**
+ * Number of entries of the descriptor table (GPIO_RA_0 to GPIO_RB_15).
+ */
+#define FASTIO_PIN_COUNT		32
+
+/**
+ * Const descriptor table indexed by gpio_num_t, stored in flash (PSV).
+ */
+extern const gpio_pin_t gpio_pin_table[FASTIO_PIN_COUNT];
+
+/**
+ * Returns the descriptor of a runtime pin number.
+ * Parameter:
+ * - gpio_num: Id of the GPIO.
+ */
+static inline const gpio_pin_t *fastio_get_pin(gpio_num_t gpio_num)
+{
+	return &gpio_pin_table[gpio_num & (FASTIO_PIN_COUNT - 1)];
+}
+
+/**
+ * Sets the LAT bit of a runtime pin number.
+ * Parameter:
+ * - gpio_num: Id of the GPIO.
+ */
+static inline void fastio_set(gpio_num_t gpio_num)
+{
+	const gpio_pin_t *pin = fastio_get_pin(gpio_num);
+	*pin->lat |= pin->mask;
+}
+
+/**
+ * Clears the LAT bit of a runtime pin number.
+ * Parameter:
+ * - gpio_num: Id of the GPIO.
+ */
+static inline void fastio_clear(gpio_num_t gpio_num)
+{
+	const gpio_pin_t *pin = fastio_get_pin(gpio_num);
+	*pin->lat &= ~pin->mask;
+}
+
+/**
+ * Toggles the LAT bit of a runtime pin number.
+ * Parameter:
+ * - gpio_num: Id of the GPIO.
+ */
+static inline void fastio_toggle(gpio_num_t gpio_num)
+{
+	const gpio_pin_t *pin = fastio_get_pin(gpio_num);
+	*pin->lat ^= pin->mask;
+}
+
+/**
+ * Writes the level to the LAT bit of a runtime pin number.
+ * Parameters:
+ * - gpio_num: Id of the GPIO.
+ * - gpio_level: Logic level to be written.
+ */
+static inline void fastio_write(gpio_num_t gpio_num, gpio_level_t gpio_level)
+{
+	const gpio_pin_t *pin = fastio_get_pin(gpio_num);
+	if (gpio_level)
+	{
+		*pin->lat |= pin->mask;
+	}
+	else
+	{
+		*pin->lat &= ~pin->mask;
+	}
+}
+
+/**
+ * Returns the level (0 or 1) of the PORT bit of a runtime pin number.
+ * Parameter:
+ * - gpio_num: Id of the GPIO.
+ */
+static inline int16_t fastio_get(gpio_num_t gpio_num)
+{
+	const gpio_pin_t *pin = fastio_get_pin(gpio_num);
+	return (*pin->port & pin->mask) != 0;
+}
+
+/*******************************************************************/
+/*                        PORT-WIDE ACCESS                         */
+/*******************************************************************/
+
+/**
+ * Returns the LAT register of the port.
+ * Parameter:
+ * - gpio_group: GPIO_GROUP_A (PORTA) or GPIO_GROUP_B (PORTB).
+ */
+static inline volatile uint16_t *fastio_port_lat(gpio_group_t gpio_group)
+{
+	return (gpio_group == GPIO_GROUP_A) ? &LATA : &LATB;
+}
+
+/**
+ * Writes the masked bits of the value to the LAT register, other bits are not changed.
+ * Parameters:
+ * - gpio_group: GPIO_GROUP_A or GPIO_GROUP_B.
+ * - mask: Bits to be written.
+ * - value: Bit values.
+ * Note:
+ * - The read-modify-write is not atomic, do not share the port with an ISR that writes it.
+ */
+static inline void fastio_port_write(gpio_group_t gpio_group, uint16_t mask, uint16_t value)
+{
+	volatile uint16_t *lat = fastio_port_lat(gpio_group);
+	*lat = (*lat & ~mask) | (value & mask);
+}
+
+/**
+ * Sets the masked bits of the LAT register (single IOR instruction).
+ * Parameters:
+ * - gpio_group: GPIO_GROUP_A or GPIO_GROUP_B.
+ * - mask: Bits to be set.
+ */
+static inline void fastio_port_set(gpio_group_t gpio_group, uint16_t mask)
+{
+	*fastio_port_lat(gpio_group) |= mask;
+}
+
+/**
+ * Clears the masked bits of the LAT register (single AND instruction).
+ * Parameters:
+ * - gpio_group: GPIO_GROUP_A or GPIO_GROUP_B.
+ * - mask: Bits to be cleared.
+ */
+static inline void fastio_port_clear(gpio_group_t gpio_group, uint16_t mask)
+{
+	*fastio_port_lat(gpio_group) &= ~mask;
+}
+
+/**
+ * Toggles the masked bits of the LAT register (single XOR instruction).
+ * Parameters:
+ * - gpio_group: GPIO_GROUP_A or GPIO_GROUP_B.
+ * - mask: Bits to be toggled.
+ */
+static inline void fastio_port_toggle(gpio_group_t gpio_group, uint16_t mask)
+{
+	*fastio_port_lat(gpio_group) ^= mask;
+}
+
+/**
+ * Returns the PORT register (pin levels) of the port.
+ * Parameter:
+ * - gpio_group: GPIO_GROUP_A or GPIO_GROUP_B.
+ */
+static inline uint16_t fastio_port_read(gpio_group_t gpio_group)
+{
+	return (gpio_group == GPIO_GROUP_A) ? PORTA : PORTB;
+}
+
+/**
+ * Returns the LAT register (output latches) of the port.
+ * Parameter:
+ * - gpio_group: GPIO_GROUP_A or GPIO_GROUP_B.
+ */
+static inline uint16_t fastio_port_read_lat(gpio_group_t gpio_group)
+{
+	return *fastio_port_lat(gpio_group);
+}
+
+/**
+ * Holds a snapshot of both ports, the same layout as the CN callback data.
+ */
+typedef gpio_inputs_change_data_t fastio_snapshot_t;
+
+/**
+ * Reads PORTA and PORTB back to back.
+ * Parameter:
+ * - snapshot: Output snapshot.
+ */
+static inline void fastio_port_snapshot(fastio_snapshot_t *snapshot)
+{
+	snapshot->gpio_ra_data = PORTA;
+	snapshot->gpio_rb_data = PORTB;
+}
+
+/*******************************************************************/
+/*                          PIN GROUPS                             */
+/*******************************************************************/
+
+/**
+ * Maximum number of pins in a group.
+ */
+#define FASTIO_GROUP_PINS_MAX		16
+
+/**
+ * Group of pins addressed by logical bit indices.
+ * Members:
+ * - mask_a: Port mask of the pins in PORTA.
+ * - mask_b: Port mask of the pins in PORTB.
+ * - count: Number of pins.
+ * - group: Port of the pins if they are contiguous.
+ * - shift: Bit index of logical bit 0 if the pins are contiguous and ascending in one port, otherwise -1.
+ * - pins: gpio_num of each logical bit.
+ */
+typedef struct FASTIO_GROUP_STRUCT
+{
+	uint16_t mask_a;
+	uint16_t mask_b;
+	uint8_t count;
+	gpio_group_t group;
+	int8_t shift;
+	uint8_t pins[FASTIO_GROUP_PINS_MAX];
+} fastio_group_t;
+
+/**
+ * Initializes a group from a pin list, e.g. gpio_get_led_pins().
+ * The port masks are computed once.
+ * Parameters:
+ * - group: Group object.
+ * - pins: gpio_num of each logical bit.
+ * - count: Number of pins (1-FASTIO_GROUP_PINS_MAX).
+ */
+sys_error_t fastio_group_init(fastio_group_t *group, const uint8_t *pins, uint8_t count);
+
+/**
+ * Converts logical bits to a port mask.
+ * Parameters:
+ * - group: Group object.
+ * - bits: Logical bits, bit n is the n-th pin of the group.
+ * - gpio_group: Port of the returned mask.
+ */
+uint16_t fastio_group_to_port_mask(const fastio_group_t *group, uint16_t bits, gpio_group_t gpio_group);
+
+/**
+ * Returns the pin levels of the group as logical bits.
+ * One PORT read (shift and mask) if the pins are contiguous.
+ * Parameter:
+ * - group: Group object.
+ */
+uint16_t fastio_group_read(const fastio_group_t *group);
+
+/**
+ * Returns the LAT bits of the group as logical bits.
+ * Parameter:
+ * - group: Group object.
+ */
+uint16_t fastio_group_read_lat(const fastio_group_t *group);
+
+/**
+ * Writes logical bits to the LAT bits of the group.
+ * One masked write per port.
+ * Parameters:
+ * - group: Group object.
+ * - bits: Logical bits, bit n is the n-th pin of the group.
+ */
+void fastio_group_write(const fastio_group_t *group, uint16_t bits);
+
+/**
+ * Returns the LED<3:0> group, initialized from gpio_get_led_pins() on the first call.
+ */
+const fastio_group_t *fastio_get_led_group(void);
+
+/**
+ * Returns the PSW<3:0> group, initialized from gpio_get_psw_pins() on the first call.
+ */
+const fastio_group_t *fastio_get_psw_group(void);
+
+/**
+ * Returns the LAT levels of LED<3:0> as bits <3:0>, a single LATB access on the Ternion board.
+ */
+uint8_t fastio_read_led_data(void);
+
+/**
+ * Returns the pin levels of PSW<3:0> as bits <3:0>, a single PORTB access on the Ternion board.
+ */
+uint8_t fastio_read_psw_data(void);
+
+/**
+ * Writes LED<3:0> LAT levels from bits <3:0> with one masked write.
+ * Parameter:
+ * - data: LAT levels (the LEDs are active-low).
+ */
+void fastio_write_led_data(uint8_t data);
+
+#endif // __FASTIO_H__
@@ -0,0 +1,145 @@
+/*
+************************************************************
+* ICAP Header File                                         *
+* (Input capture frequency and pulse-width measurement)    *
+************************************************************
+* File:    icap.h                                          *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+/**
+ * The input capture modules (IC1-IC5) latch the value of Timer2 or Timer3 on the input edges
+ * in hardware, so the measured period does not depend on the interrupt latency.
+ * The input of an IC module is mapped to an RPn pin (RB<15:0>) using RPINR7-RPINR9.
+ *
+ * The timer values are extended to 32 bits by counting the timer periods in the timer ISR.
+ * If the timer is already used by a PWM group, its period (PRx) and prescaler are kept,
+ * otherwise it is started as a free-running 16-bit timer at FCY (62.5 ns).
+ *
+ * The frequency is computed from the first and the last capture of an averaging window of N
+ * captures: f = N * edges_per_capture * timer_clock / (t_last - t_first). With the 16-edge
+ * prescaler only one interrupt is taken every 16 periods, e.g. 100 kHz gives 6250 interrupts
+ * per second, and a window of 16 captures (2.56 ms) gives a resolution of 25 ppm.
+ *
+ * The duty ratio is measured by a second IC module mapped to the same pin that captures the
+ * falling edges (icap_enable_duty). It is limited to the frequencies where both ISRs can be
+ * served within one period (about 20 kHz).
+ *
+ *   icap_create(ICAP_NUM_0, GPIO_RB_8, ICAP_TIMER_3, ICAP_PRESCALE_16, 16, 100);
+ *   ...
+ *   float f = icap_get_object(ICAP_NUM_0)->frequency;
+ */
+
+#ifndef __ICAP_H__
+#define __ICAP_H__
+
+#include <gpio.h>
+
+typedef enum ICAP_NUM_TYPE
+{
+	ICAP_NUM_0,		/** IC1 */
+	ICAP_NUM_1,		/** IC2 */
+	ICAP_NUM_2,		/** IC3 */
+	ICAP_NUM_3,		/** IC4 */
+	ICAP_NUM_4,		/** IC5 */
+	ICAP_NUM_COUNT
+}icap_num_t;
+
+typedef enum ICAP_TIMER_TYPE
+{
+	ICAP_TIMER_2,	/** Timer2, shared with PWM_GROUP_A */
+	ICAP_TIMER_3	/** Timer3, shared with PWM_GROUP_B */
+}icap_timer_t;
+
+/**
+ * Rising edges per capture, the values are the ICM<2:0> modes.
+ */
+typedef enum ICAP_PRESCALE_TYPE
+{
+	ICAP_PRESCALE_1  = 3,	/** Every rising edge		*/
+	ICAP_PRESCALE_4  = 4,	/** Every 4th rising edge	*/
+	ICAP_PRESCALE_16 = 5	/** Every 16th rising edge	*/
+}icap_prescale_t;
+
+/**
+ * Members:
+ * - id: Id of the IC module.
+ * - gpio_num: Input pin (RB<15:0>).
+ * - timer: Timebase of the capture.
+ * - prescale: Rising edges per capture.
+ * - window: Captures per result (averaging window).
+ * - timeout: Milliseconds without a capture before the input is reported as stopped.
+ * - timer_clock: Timer clock in Hz.
+ * - period_ticks: Average period in timer ticks of the last window.
+ * - frequency: Average frequency in Hz of the last window, 0 if stopped.
+ * - duty_ratio: Average duty ratio (0.0-1.0) of the last window, if enabled.
+ * - valid: The results are valid (a window was completed and no timeout).
+ * - updated: Set when a new result is computed, cleared by the user.
+ * - overflows: Number of the capture FIFO overflows.
+ */
+typedef struct ICAP_STRUCT
+{
+	icap_num_t		id;
+	gpio_num_t		gpio_num;
+	icap_timer_t	timer;
+	icap_prescale_t	prescale;
+	uint16_t		window;
+	uint16_t		timeout;
+	uint32_t		timer_clock;
+	float			period_ticks;
+	float			frequency;
+	float			duty_ratio;
+	bool			valid;
+	bool			updated;
+	uint16_t		overflows;
+}icap_t;
+
+/**
+ * Returns the object of the IC module.
+ * Parameter:
+ * - icap_num: Id of the IC module, ICAP_NUM_<4:0>.
+ */
+icap_t *icap_get_object(icap_num_t icap_num);
+
+/**
+ * Creates a frequency measurement on an RPn pin.
+ * Parameters:
+ * - icap_num: Id of the IC module.
+ * - gpio_num: Input pin, GPIO_RB_<15:0>. It is set to digital input.
+ * - icap_timer: Timebase, ICAP_TIMER_2 or ICAP_TIMER_3.
+ * - prescale: Rising edges per capture, use ICAP_PRESCALE_16 above 10 kHz.
+ * - window: Captures per result (1-65535).
+ * - timeout: Milliseconds without a capture before the frequency is set to 0 (1-65535).
+ * Note:
+ * - If the timer is used by a PWM group, create the PWM group first.
+ * - The period of the PWM group is locked while the timer is used by an IC module,
+ *   pwmfx_set_period() and pwm_set_frequency() of the group return SYS_ERR.
+ */
+sys_error_t icap_create(icap_num_t icap_num, gpio_num_t gpio_num, icap_timer_t icap_timer, icap_prescale_t prescale, uint16_t window, uint16_t timeout);
+
+/**
+ * Enables the duty ratio measurement using a second IC module on the same pin.
+ * Parameters:
+ * - icap_num: Id of the IC module created by icap_create(), its prescale must be ICAP_PRESCALE_1.
+ * - falling_num: Id of a free IC module, it captures the falling edges.
+ */
+sys_error_t icap_enable_duty(icap_num_t icap_num, icap_num_t falling_num);
+
+/**
+ * Stops the IC module (and its falling-edge module).
+ * Parameter:
+ * - icap_num: Id of the IC module.
+ */
+sys_error_t icap_delete(icap_num_t icap_num);
+
+/**
+ * Computes the results of the completed windows and handles the timeouts.
+ * This function must be called by the main loop every 1 ms.
+ */
+void icap_exec(void);
+
+#endif // __ICAP_H__
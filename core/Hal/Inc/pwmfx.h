@@ -0,0 +1,234 @@
+/*
+************************************************************
+* PWMFX Header File                                        *
+* (Fixed-point PWM control)                                *
+************************************************************
+* File:    pwmfx.h                                         *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+/**
+ * Integer versions of pwm_set_duty_ratio(), pwm_set_phase_shift() and pwm_set_frequency().
+ * The PWM channels run the OC modules in the dual-compare continuous-pulse mode, the output
+ * rises at OCxR (shift) and falls at OCxRS (shift + duty) in every period of the group timer.
+ * These functions write the compare registers directly, without float math and divisions.
+ *
+ * - Ticks: timer ticks of the group timer, 0 to pwmfx_get_period_ticks().
+ * - Q15: ratio in 1/32768 units, PWMFX_Q15_ONE (0x8000) is 1.0. One 16x16 multiply per update.
+ * - Period: computed once by pwmfx_period_compute() and applied by pwmfx_set_period().
+ *
+ *   pwmfx_period_t period_1k;
+ *   pwmfx_period_compute(1000, &period_1k);         // at the initialization
+ *   pwmfx_set_period(PWM_GROUP_A, &period_1k);
+ *   pwmfx_set_duty_q15(PWM_NUM_0, PWMFX_Q15(0.25));
+ *   pwmfx_set_duty_q15(PWM_NUM_0, u);               // in the control loop
+ *
+ * The float API of pwm.h is a wrapper of these functions: pwm_set_duty_ratio() and
+ * pwm_set_phase_shift() convert the ratios to Q15 and call pwmfx_set_q15(), pwm_set_frequency()
+ * computes the period with floats and calls pwmfx_set_period().
+ *
+ * The float fields of the pwm_t objects are not updated by these functions,
+ * call pwmfx_sync_object() before reading them.
+ *
+ * Staged updates: the pwmfx_set_* functions write the registers immediately, a write in the
+ * middle of a period can produce one runt pulse and the channels change one after another.
+ * pwmfx_stage_ticks() and pwmfx_stage_q15() write shadow values, pwmfx_commit() hands them to
+ * the timer ISR, which writes the registers of all committed channels of a group at the start
+ * of its next period. A channel never shows a new shift with an old duty or the other way round.
+ *
+ *   pwmfx_stage_q15(PWM_NUM_0, 0, PWMFX_Q15(0.25));
+ *   pwmfx_stage_q15(PWM_NUM_1, PWMFX_Q15(0.5), PWMFX_Q15(0.25));
+ *   pwmfx_commit((1 << PWM_NUM_0) | (1 << PWM_NUM_1));
+ *
+ * The registers are written a few microseconds (ISR latency) after the period starts, an edge
+ * earlier than that would be missed in that period and produce a runt or a long pulse.
+ * The staged edges are therefore never earlier than PWMFX_STAGE_EDGE_MIN_CYCLES (8 us, 128
+ * ticks at 1:1, 16 ticks at 1:8): a smaller shift is moved to it, and an active time that wraps
+ * to the next period ends no earlier than it. tests/host/test_pwmfx.c checks the output of a
+ * register model of the timer and the OC modules against writes at the exact period start.
+ *
+ * The period interrupts of Timer2 and Timer3 are shared by the modules through the period
+ * handler slots (pwmfx_period_attach), the interrupt is enabled while a handler is attached.
+ */
+
+#ifndef __PWMFX_H__
+#define __PWMFX_H__
+
+#include <pwm.h>
+
+/**
+ * Q15 ratio, 0 to PWMFX_Q15_ONE.
+ */
+typedef uint16_t pwmfx_q15_t;
+
+#define PWMFX_Q15_ONE		0x8000u
+
+/**
+ * Converts a constant ratio (0.0-1.0) to Q15 at compile time.
+ */
+#define PWMFX_Q15(ratio)	((pwmfx_q15_t)((ratio) * 32768.0 + 0.5))
+
+/**
+ * Earliest edge of a staged channel in instruction cycles after the start of the period.
+ * It covers the entry of the timer ISR and the register writes of the stage handler, which
+ * is called first. An ISR of the same or a higher priority that runs at the start of the
+ * period delays the writes further.
+ */
+#define PWMFX_STAGE_EDGE_MIN_CYCLES	128
+
+/**
+ * Precomputed timer period of a PWM group.
+ * Members:
+ * - pr: Value of the PRx register, the period is pr + 1 ticks.
+ * - tckps: Timer prescaler selection (TCKPS<1:0>), 0: 1:1, 1: 1:8, 2: 1:64, 3: 1:256.
+ */
+typedef struct PWMFX_PERIOD_STRUCT
+{
+	uint16_t pr;
+	uint16_t tckps;
+}pwmfx_period_t;
+
+
+/**
+ * Period handler slots, the handlers of a group are called in this order.
+ */
+typedef enum PWMFX_PERIOD_SLOT_TYPE
+{
+	PWMFX_PERIOD_SLOT_STAGE,	/** Staged updates (pwmfx_commit)		*/
+	PWMFX_PERIOD_SLOT_ICAP,		/** Timer overflow counting of the icap	*/
+	PWMFX_PERIOD_SLOT_CONTROL,	/** Control loops of the pidctl		*/
+	PWMFX_PERIOD_SLOT_PROFILE,	/** Ramps and chirps of the pwmprof		*/
+	PWMFX_PERIOD_SLOT_COUNT
+}pwmfx_period_slot_t;
+
+/**
+ * Called from the timer ISR at the start of each period of the group.
+ */
+typedef void (*pwmfx_period_handler_t)(pwm_group_t pwm_group);
+
+
+/**
+ * Computes the timer period of the given frequency, with the smallest prescaler (best resolution).
+ * Parameters:
+ * - frequency: Frequency in Hz, 1 Hz to FCY/2.
+ * - period: Result.
+ */
+sys_error_t pwmfx_period_compute(uint32_t frequency, pwmfx_period_t *period);
+
+/**
+ * Sets the timer period of the group. The duty and the shift of the channels of the group
+ * are rescaled to the new period.
+ * Parameters:
+ * - pwm_group: PWM_GROUP_A or PWM_GROUP_B.
+ * - period: Period computed by pwmfx_period_compute().
+ * Return:
+ * - SYS_ERR if the period is locked (pwmfx_period_locked).
+ */
+sys_error_t pwmfx_set_period(pwm_group_t pwm_group, const pwmfx_period_t *period);
+
+/**
+ * Returns true while an icap module uses the timer of the group. The icap caches the timer
+ * clock and the timer modulus (PRx + 1) when it starts, the period and the prescaler of the
+ * group must not change until it is deleted.
+ */
+bool pwmfx_period_locked(pwm_group_t pwm_group);
+
+/**
+ * Returns the period of the group in timer ticks (PRx + 1).
+ */
+uint16_t pwmfx_get_period_ticks(pwm_group_t pwm_group);
+
+/**
+ * Sets the active (high) time of the channel in timer ticks, the shift is kept.
+ * The ticks are clamped to the period.
+ */
+sys_error_t pwmfx_set_duty_ticks(pwm_num_t pwm_num, uint16_t ticks);
+
+/**
+ * Sets the duty ratio of the channel in Q15.
+ */
+sys_error_t pwmfx_set_duty_q15(pwm_num_t pwm_num, pwmfx_q15_t duty);
+
+/**
+ * Sets the phase shift (rising edge) of the channel in timer ticks, the duty is kept.
+ */
+sys_error_t pwmfx_set_shift_ticks(pwm_num_t pwm_num, uint16_t ticks);
+
+/**
+ * Sets the phase shift of the channel in Q15.
+ */
+sys_error_t pwmfx_set_shift_q15(pwm_num_t pwm_num, pwmfx_q15_t shift);
+
+/**
+ * Sets the phase shift and the duty ratio of the channel in Q15 with one register update.
+ */
+sys_error_t pwmfx_set_q15(pwm_num_t pwm_num, pwmfx_q15_t shift, pwmfx_q15_t duty);
+
+/**
+ * Returns the active (high) time of the channel in timer ticks.
+ */
+uint16_t pwmfx_get_duty_ticks(pwm_num_t pwm_num);
+
+/**
+ * Returns the phase shift of the channel in timer ticks.
+ */
+uint16_t pwmfx_get_shift_ticks(pwm_num_t pwm_num);
+
+/**
+ * Converts a Q15 ratio to timer ticks of the group period.
+ */
+uint16_t pwmfx_q15_to_ticks(pwm_group_t pwm_group, pwmfx_q15_t ratio);
+
+/**
+ * Updates `frequency`, `duty_ratio` and `shift_ratio` of the pwm_t object from the registers.
+ */
+sys_error_t pwmfx_sync_object(pwm_num_t pwm_num);
+
+/**
+ * Writes the shadow values of the channel, the registers are not changed.
+ * Parameters:
+ * - pwm_num: Id of the channel.
+ * - shift: Rising edge in timer ticks, PWMFX_STAGE_EDGE_MIN_CYCLES at least.
+ * - duty: Active (high) time in timer ticks, clamped to the period.
+ */
+sys_error_t pwmfx_stage_ticks(pwm_num_t pwm_num, uint16_t shift, uint16_t duty);
+
+/**
+ * Writes the shadow values of the channel in Q15, see pwmfx_stage_ticks().
+ */
+sys_error_t pwmfx_stage_q15(pwm_num_t pwm_num, pwmfx_q15_t shift, pwmfx_q15_t duty);
+
+/**
+ * Commits the staged channels, the timer ISR writes them at the next period of their group.
+ * A commit that was not written yet is replaced by the new values.
+ * Parameter:
+ * - pwm_mask: Channels to be committed, bit n is PWM_NUM_n. Channels that were not staged are ignored.
+ */
+sys_error_t pwmfx_commit(uint16_t pwm_mask);
+
+/**
+ * Drops the staged values of the channels, a later commit ignores them until they are staged again.
+ * Parameter:
+ * - pwm_mask: Channels to be dropped, bit n is PWM_NUM_n.
+ */
+void pwmfx_discard(uint16_t pwm_mask);
+
+/**
+ * Returns the channels that are committed but not written yet, bit n is PWM_NUM_n.
+ */
+uint16_t pwmfx_get_pending(void);
+
+/**
+ * Attaches a handler to the period interrupt of the group timer, or detaches it if `handler` is NULL.
+ * Parameters:
+ * - pwm_group: PWM_GROUP_A (Timer2) or PWM_GROUP_B (Timer3).
+ * - slot: Slot of the module.
+ * - handler: Handler, NULL to detach.
+ */
+sys_error_t pwmfx_period_attach(pwm_group_t pwm_group, pwmfx_period_slot_t slot, pwmfx_period_handler_t handler);
+
+#endif // __PWMFX_H__
@@ -0,0 +1,220 @@
+/*
+************************************************************
+* FASTIO Source File                                       *
+* (Inline GPIO access)                                     *
+************************************************************
+* File:    fastio.c                                        *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+#include <fastio.h>
+
+/**
+ * Descriptor table of the runtime pin numbers, indexed by gpio_num_t.
+ */
+const gpio_pin_t gpio_pin_table[FASTIO_PIN_COUNT] = {
+	FASTIO_PIN_INIT(GPIO_RA_0),	/*  0: RA0	*/
+	FASTIO_PIN_INIT(GPIO_RA_1),	/*  1: RA1	*/
+	FASTIO_PIN_INIT(GPIO_RA_2),	/*  2: RA2	*/
+	FASTIO_PIN_INIT(GPIO_RA_3),	/*  3: RA3	*/
+	FASTIO_PIN_INIT(GPIO_RA_4),	/*  4: RA4	*/
+	{ &LATA, &PORTA, 0 },		/*  5: N/A	*/
+	{ &LATA, &PORTA, 0 },		/*  6: N/A	*/
+	{ &LATA, &PORTA, 0 },		/*  7: N/A	*/
+	{ &LATA, &PORTA, 0 },		/*  8: N/A	*/
+	{ &LATA, &PORTA, 0 },		/*  9: N/A	*/
+	{ &LATA, &PORTA, 0 },		/* 10: N/A	*/
+	{ &LATA, &PORTA, 0 },		/* 11: N/A	*/
+	{ &LATA, &PORTA, 0 },		/* 12: N/A	*/
+	{ &LATA, &PORTA, 0 },		/* 13: N/A	*/
+	{ &LATA, &PORTA, 0 },		/* 14: N/A	*/
+	{ &LATA, &PORTA, 0 },		/* 15: N/A	*/
+	FASTIO_PIN_INIT(GPIO_RB_0),	/* 16: RB0	*/
+	FASTIO_PIN_INIT(GPIO_RB_1),	/* 17: RB1	*/
+	FASTIO_PIN_INIT(GPIO_RB_2),	/* 18: RB2	*/
+	FASTIO_PIN_INIT(GPIO_RB_3),	/* 19: RB3	*/
+	FASTIO_PIN_INIT(GPIO_RB_4),	/* 20: RB4	*/
+	FASTIO_PIN_INIT(GPIO_RB_5),	/* 21: RB5	*/
+	FASTIO_PIN_INIT(GPIO_RB_6),	/* 22: RB6	*/
+	FASTIO_PIN_INIT(GPIO_RB_7),	/* 23: RB7	*/
+	FASTIO_PIN_INIT(GPIO_RB_8),	/* 24: RB8	*/
+	FASTIO_PIN_INIT(GPIO_RB_9),	/* 25: RB9	*/
+	FASTIO_PIN_INIT(GPIO_RB_10),	/* 26: RB10	*/
+	FASTIO_PIN_INIT(GPIO_RB_11),	/* 27: RB11	*/
+	FASTIO_PIN_INIT(GPIO_RB_12),	/* 28: RB12	*/
+	FASTIO_PIN_INIT(GPIO_RB_13),	/* 29: RB13	*/
+	FASTIO_PIN_INIT(GPIO_RB_14),	/* 30: RB14	*/
+	FASTIO_PIN_INIT(GPIO_RB_15),	/* 31: RB15	*/
+};
+
+
+sys_error_t fastio_group_init(fastio_group_t *group, const uint8_t *pins, uint8_t count)
+{
+	uint8_t i;
+
+	if (count == 0 || count > FASTIO_GROUP_PINS_MAX)
+	{
+		return SYS_ERR;
+	}
+
+	group->mask_a = 0;
+	group->mask_b = 0;
+	group->count = count;
+	group->group = (pins[0] & 0x10) ? GPIO_GROUP_B : GPIO_GROUP_A;
+	group->shift = pins[0] & 0x0F;
+
+	for (i = 0; i < count; i++)
+	{
+		const gpio_pin_t *pin = fastio_get_pin((gpio_num_t)pins[i]);
+		group->pins[i] = pins[i];
+
+		if (pins[i] & 0x10)
+		{
+			group->mask_b |= pin->mask;
+		}
+		else
+		{
+			group->mask_a |= pin->mask;
+		}
+
+		/** Contiguous means the same port and ascending consecutive bits */
+		if (pins[i] != pins[0] + i)
+		{
+			group->shift = -1;
+		}
+	}
+
+	return SYS_OK;
+}
+
+
+uint16_t fastio_group_to_port_mask(const fastio_group_t *group, uint16_t bits, gpio_group_t gpio_group)
+{
+	uint16_t mask = 0;
+	uint8_t i;
+
+	if (group->shift >= 0)
+	{
+		if (gpio_group != group->group)
+		{
+			return 0;
+		}
+		return (bits << group->shift) & (group->group == GPIO_GROUP_A ? group->mask_a : group->mask_b);
+	}
+
+	for (i = 0; i < group->count; i++)
+	{
+		uint8_t pin = group->pins[i];
+		if ((bits & (1 << i)) && (((pin & 0x10) != 0) == (gpio_group == GPIO_GROUP_B)))
+		{
+			mask |= fastio_get_pin((gpio_num_t)pin)->mask;
+		}
+	}
+	return mask;
+}
+
+
+/**
+ * Gathers the group bits from the port images.
+ */
+static uint16_t fastio_group_gather(const fastio_group_t *group, uint16_t data_a, uint16_t data_b)
+{
+	uint16_t bits = 0;
+	uint8_t i;
+
+	if (group->shift >= 0)
+	{
+		uint16_t data = (group->group == GPIO_GROUP_A) ? (data_a & group->mask_a) : (data_b & group->mask_b);
+		return data >> group->shift;
+	}
+
+	for (i = 0; i < group->count; i++)
+	{
+		uint8_t pin = group->pins[i];
+		uint16_t data = (pin & 0x10) ? data_b : data_a;
+		if (data & fastio_get_pin((gpio_num_t)pin)->mask)
+		{
+			bits |= 1 << i;
+		}
+	}
+	return bits;
+}
+
+
+uint16_t fastio_group_read(const fastio_group_t *group)
+{
+	if (group->shift >= 0)
+	{
+		return fastio_group_gather(group, group->group == GPIO_GROUP_A ? PORTA : 0, group->group == GPIO_GROUP_B ? PORTB : 0);
+	}
+	return fastio_group_gather(group, PORTA, PORTB);
+}
+
+
+uint16_t fastio_group_read_lat(const fastio_group_t *group)
+{
+	if (group->shift >= 0)
+	{
+		return fastio_group_gather(group, group->group == GPIO_GROUP_A ? LATA : 0, group->group == GPIO_GROUP_B ? LATB : 0);
+	}
+	return fastio_group_gather(group, LATA, LATB);
+}
+
+
+void fastio_group_write(const fastio_group_t *group, uint16_t bits)
+{
+	if (group->mask_a)
+	{
+		fastio_port_write(GPIO_GROUP_A, group->mask_a, fastio_group_to_port_mask(group, bits, GPIO_GROUP_A));
+	}
+	if (group->mask_b)
+	{
+		fastio_port_write(GPIO_GROUP_B, group->mask_b, fastio_group_to_port_mask(group, bits, GPIO_GROUP_B));
+	}
+}
+
+
+static fastio_group_t _fastio_led_group;
+static fastio_group_t _fastio_psw_group;
+
+
+const fastio_group_t *fastio_get_led_group(void)
+{
+	if (_fastio_led_group.count == 0)
+	{
+		fastio_group_init(&_fastio_led_group, gpio_get_led_pins(), 4);
+	}
+	return &_fastio_led_group;
+}
+
+
+const fastio_group_t *fastio_get_psw_group(void)
+{
+	if (_fastio_psw_group.count == 0)
+	{
+		fastio_group_init(&_fastio_psw_group, gpio_get_psw_pins(), 4);
+	}
+	return &_fastio_psw_group;
+}
+
+
+uint8_t fastio_read_led_data(void)
+{
+	return (uint8_t)fastio_group_read_lat(fastio_get_led_group());
+}
+
+
+uint8_t fastio_read_psw_data(void)
+{
+	return (uint8_t)fastio_group_read(fastio_get_psw_group());
+}
+
+
+void fastio_write_led_data(uint8_t data)
+{
+	fastio_group_write(fastio_get_led_group(), data);
+}
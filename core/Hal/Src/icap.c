@@ -0,0 +1,537 @@
+/*
+************************************************************
+* ICAP Source File                                         *
+* (Input capture frequency and pulse-width measurement)    *
+************************************************************
+* File:    icap.c                                          *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+#include <icap.h>
+#include <pwmfx.h>
+
+/**
+ * ICxCON bits.
+ */
+#define ICAP_CON_ICTMR		0x0080	/** 1: Timer2, 0: Timer3	*/
+#define ICAP_CON_ICOV		0x0010	/** FIFO overflow			*/
+#define ICAP_CON_ICBNE		0x0008	/** FIFO not empty			*/
+#define ICAP_CON_ICM_FALLING	0x0002	/** Every falling edge		*/
+
+/**
+ * TxCON bits.
+ */
+#define ICAP_TCON_TON		0x8000
+#define ICAP_TCON_TCKPS		0x0030
+
+/**
+ * Interrupt bits of the timers and the IC modules.
+ */
+#define ICAP_T2_INT_MASK	(1 << 7)	/** IFS0/IEC0	*/
+#define ICAP_T3_INT_MASK	(1 << 8)	/** IFS0/IEC0	*/
+
+/**
+ * Internal state of an IC module.
+ * Members:
+ * - first: Timestamp of the first capture of the window.
+ * - last: Timestamp of the last rising-edge capture.
+ * - last_period: Ticks between the last two captures.
+ * - count: Captures in the current window.
+ * - high_sum, high_count: High times measured by the falling-edge module in the current window.
+ * - result_*: Result of the last completed window, valid while ready is set.
+ * - captures: Incremented by the ISR on every capture (timeout detection).
+ * - falling: Falling-edge module of this module, or -1.
+ * - owner: Module served by this falling-edge module, or -1.
+ */
+typedef struct ICAP_STATE_STRUCT
+{
+	uint32_t first;
+	uint32_t last;
+	uint32_t last_period;
+	uint16_t count;
+	uint32_t high_sum;
+	uint16_t high_count;
+	uint32_t result_ticks;
+	uint16_t result_count;
+	uint32_t result_high;
+	uint16_t result_high_count;
+	volatile bool ready;
+	volatile bool started;
+	volatile uint16_t captures;
+	uint16_t seen_captures;
+	uint16_t idle_ms;
+	int8_t falling;
+	int8_t owner;
+	bool used;
+}icap_state_t;
+
+static icap_t _icap_objects[ICAP_NUM_COUNT];
+static icap_state_t _icap_states[ICAP_NUM_COUNT];
+
+/** Timer periods counted by the timer ISRs, and the timer moduli (PRx + 1) */
+static volatile uint32_t _icap_timer_overflows[2];
+static uint32_t _icap_timer_modulus[2];
+static uint16_t _icap_timer_users;
+
+/** ICxBUF and ICxCON of IC1-IC5, ICxCON follows ICxBUF */
+static volatile uint16_t *const _icap_buf[ICAP_NUM_COUNT] = { &IC1BUF, &IC2BUF, &IC3BUF, &IC4BUF, &IC5BUF };
+
+/** Interrupt flag/enable registers and masks of IC1-IC5 */
+static volatile uint16_t *const _icap_ifs[ICAP_NUM_COUNT] = { &IFS0, &IFS0, &IFS2, &IFS2, &IFS2 };
+static volatile uint16_t *const _icap_iec[ICAP_NUM_COUNT] = { &IEC0, &IEC0, &IEC2, &IEC2, &IEC2 };
+static const uint16_t _icap_int_mask[ICAP_NUM_COUNT] = { 1 << 1, 1 << 5, 1 << 5, 1 << 6, 1 << 7 };
+
+static const uint16_t _icap_timer_int_mask[2] = { ICAP_T2_INT_MASK, ICAP_T3_INT_MASK };
+
+
+icap_t *icap_get_object(icap_num_t icap_num)
+{
+	if (icap_num >= ICAP_NUM_COUNT)
+	{
+		return NULL;
+	}
+	return &_icap_objects[icap_num];
+}
+
+
+/**
+ * Maps the input of the IC module to the RPn pin. Masked, a remap from an interrupt would re-lock
+ * the pin mapping between the unlock and the write.
+ */
+static void icap_map_input(icap_num_t icap_num, uint8_t rp)
+{
+	PERFORM_CRITICAL_SECTION({
+		mcu_unlock_remap();
+		switch (icap_num)
+		{
+			case ICAP_NUM_0: RPINR7bits.IC1R = rp; break;
+			case ICAP_NUM_1: RPINR7bits.IC2R = rp; break;
+			case ICAP_NUM_2: RPINR8bits.IC3R = rp; break;
+			case ICAP_NUM_3: RPINR8bits.IC4R = rp; break;
+			default:         RPINR9bits.IC5R = rp; break;
+		}
+		mcu_lock_remap();
+	});
+}
+
+
+/**
+ * Counts the timer periods, called from the timer ISR.
+ */
+static void icap_timer_period(pwm_group_t pwm_group)
+{
+	_icap_timer_overflows[pwm_group]++;
+}
+
+
+/**
+ * Starts the timer if it is not running and enables its period interrupt.
+ */
+static void icap_timer_init(icap_timer_t icap_timer, uint32_t *timer_clock)
+{
+	static const uint16_t prescalers[4] = { 1, 8, 64, 256 };
+	volatile uint16_t *tcon = (icap_timer == ICAP_TIMER_2) ? &T2CON : &T3CON;
+	volatile uint16_t *pr   = (icap_timer == ICAP_TIMER_2) ? &PR2   : &PR3;
+
+	if (!(*tcon & ICAP_TCON_TON))
+	{
+		/** Free-running at FCY */
+		*tcon = 0;
+		*((icap_timer == ICAP_TIMER_2) ? &TMR2 : &TMR3) = 0;
+		*pr = 0xFFFF;
+		*tcon = ICAP_TCON_TON;
+	}
+
+	*timer_clock = FCY / prescalers[(*tcon & ICAP_TCON_TCKPS) >> 4];
+
+	if (!(_icap_timer_users & (1 << icap_timer)))
+	{
+		_icap_timer_modulus[icap_timer] = (uint32_t)*pr + 1;
+		_icap_timer_overflows[icap_timer] = 0;
+		pwmfx_period_attach((pwm_group_t)icap_timer, PWMFX_PERIOD_SLOT_ICAP, icap_timer_period);
+	}
+}
+
+
+/**
+ * Starts the IC module, the FIFO is flushed.
+ */
+static void icap_module_start(icap_num_t icap_num, icap_timer_t icap_timer, uint16_t mode)
+{
+	volatile uint16_t *buf = _icap_buf[icap_num];
+	volatile uint16_t *con = buf + 1;
+
+	*_icap_iec[icap_num] &= ~_icap_int_mask[icap_num];
+	*con = 0;
+	while (*con & ICAP_CON_ICBNE)
+	{
+		(void)*buf;
+	}
+	*con = ((icap_timer == ICAP_TIMER_2) ? ICAP_CON_ICTMR : 0) | mode;
+	*_icap_ifs[icap_num] &= ~_icap_int_mask[icap_num];
+	*_icap_iec[icap_num] |= _icap_int_mask[icap_num];
+}
+
+
+/**
+ * Stops the IC module.
+ */
+static void icap_module_stop(icap_num_t icap_num)
+{
+	*_icap_iec[icap_num] &= ~_icap_int_mask[icap_num];
+	*(_icap_buf[icap_num] + 1) = 0;
+	*_icap_ifs[icap_num] &= ~_icap_int_mask[icap_num];
+}
+
+
+/**
+ * Releases the timer, its period interrupt is disabled when it has no users.
+ */
+static void icap_timer_release(icap_num_t icap_num)
+{
+	icap_timer_t icap_timer = _icap_objects[icap_num].timer;
+	int16_t i;
+
+	for (i = 0; i < ICAP_NUM_COUNT; i++)
+	{
+		if (i != (int16_t)icap_num && _icap_states[i].used && _icap_objects[i].timer == icap_timer)
+		{
+			return;
+		}
+	}
+	pwmfx_period_attach((pwm_group_t)icap_timer, PWMFX_PERIOD_SLOT_ICAP, NULL);
+	_icap_timer_users &= ~(1 << icap_timer);
+}
+
+
+sys_error_t icap_create(icap_num_t icap_num, gpio_num_t gpio_num, icap_timer_t icap_timer, icap_prescale_t prescale, uint16_t window, uint16_t timeout)
+{
+	if (icap_num >= ICAP_NUM_COUNT || (gpio_num & 0xF0) != GPIO_RB_0 || window == 0 || timeout == 0)
+	{
+		return SYS_ERR;
+	}
+	if (prescale != ICAP_PRESCALE_1 && prescale != ICAP_PRESCALE_4 && prescale != ICAP_PRESCALE_16)
+	{
+		return SYS_ERR;
+	}
+
+	if (_icap_states[icap_num].used)
+	{
+		icap_delete(icap_num);
+	}
+
+	icap_t *icap = &_icap_objects[icap_num];
+	icap_state_t *state = &_icap_states[icap_num];
+
+	gpio_set_mode(gpio_num, GPIO_MODE_DIGITAL);
+	gpio_set_direction(gpio_num, GPIO_DIRECTION_INPUT);
+	icap_map_input(icap_num, gpio_num & 0x0F);
+
+	icap->id           = icap_num;
+	icap->gpio_num     = gpio_num;
+	icap->timer        = icap_timer;
+	icap->prescale     = prescale;
+	icap->window       = window;
+	icap->timeout      = timeout;
+	icap->period_ticks = 0;
+	icap->frequency    = 0;
+	icap->duty_ratio   = 0;
+	icap->valid        = false;
+	icap->updated      = false;
+	icap->overflows    = 0;
+
+	state->started       = false;
+	state->ready         = false;
+	state->count         = 0;
+	state->high_sum      = 0;
+	state->high_count    = 0;
+	state->last_period   = 0;
+	state->captures      = 0;
+	state->seen_captures = 0;
+	state->idle_ms       = 0;
+	state->falling       = -1;
+	state->owner         = -1;
+
+	icap_timer_init(icap_timer, &icap->timer_clock);
+	_icap_timer_users |= 1 << icap_timer;
+	state->used = true;
+
+	icap_module_start(icap_num, icap_timer, prescale);
+	return SYS_OK;
+}
+
+
+sys_error_t icap_enable_duty(icap_num_t icap_num, icap_num_t falling_num)
+{
+	if (icap_num >= ICAP_NUM_COUNT || falling_num >= ICAP_NUM_COUNT || icap_num == falling_num)
+	{
+		return SYS_ERR;
+	}
+
+	icap_t *icap = &_icap_objects[icap_num];
+	icap_state_t *state = &_icap_states[icap_num];
+	icap_state_t *falling = &_icap_states[falling_num];
+
+	if (!state->used || state->owner >= 0 || icap->prescale != ICAP_PRESCALE_1 || falling->used)
+	{
+		return SYS_ERR;
+	}
+
+	icap_map_input(falling_num, icap->gpio_num & 0x0F);
+
+	_icap_objects[falling_num].id    = falling_num;
+	_icap_objects[falling_num].timer = icap->timer;
+	falling->owner   = icap_num;
+	falling->falling = -1;
+	falling->used    = true;
+	state->falling   = falling_num;
+
+	icap_module_start(falling_num, icap->timer, ICAP_CON_ICM_FALLING);
+	return SYS_OK;
+}
+
+
+sys_error_t icap_delete(icap_num_t icap_num)
+{
+	if (icap_num >= ICAP_NUM_COUNT || !_icap_states[icap_num].used)
+	{
+		return SYS_ERR;
+	}
+
+	icap_state_t *state = &_icap_states[icap_num];
+
+	if (state->owner >= 0)
+	{
+		/** Deleting a falling-edge module disables the duty measurement of its owner */
+		_icap_states[state->owner].falling = -1;
+	}
+	else if (state->falling >= 0)
+	{
+		icap_module_stop(state->falling);
+		_icap_states[state->falling].used = false;
+		state->falling = -1;
+	}
+
+	icap_module_stop(icap_num);
+	icap_timer_release(icap_num);
+	state->used  = false;
+	state->owner = -1;
+	return SYS_OK;
+}
+
+
+/**
+ * Extends a captured timer value to a 32-bit timestamp.
+ * The period interrupt cannot preempt the IC ISR, a pending period flag with a small
+ * captured value means the capture happened after the timer period.
+ */
+static uint32_t icap_timestamp(icap_timer_t icap_timer, uint16_t value)
+{
+	uint32_t overflows = _icap_timer_overflows[icap_timer];
+	uint32_t modulus = _icap_timer_modulus[icap_timer];
+
+	if ((IFS0 & _icap_timer_int_mask[icap_timer]) && value < (modulus >> 1))
+	{
+		overflows++;
+	}
+	return overflows * modulus + value;
+}
+
+
+/**
+ * Processes a rising-edge capture of the frequency module.
+ */
+static void icap_capture_rising(icap_t *icap, icap_state_t *state, uint32_t timestamp)
+{
+	if (!state->started)
+	{
+		state->first      = timestamp;
+		state->count      = 0;
+		state->high_sum   = 0;
+		state->high_count = 0;
+		state->started    = true;
+	}
+	else
+	{
+		state->last_period = timestamp - state->last;
+		if (++state->count >= icap->window)
+		{
+			/** The result is dropped if the previous one was not read by icap_exec() */
+			if (!state->ready)
+			{
+				state->result_ticks      = timestamp - state->first;
+				state->result_count      = state->count;
+				state->result_high       = state->high_sum;
+				state->result_high_count = state->high_count;
+				state->ready             = true;
+			}
+			state->first      = timestamp;
+			state->count      = 0;
+			state->high_sum   = 0;
+			state->high_count = 0;
+		}
+	}
+	state->last = timestamp;
+	state->captures++;
+}
+
+
+/**
+ * Processes a falling-edge capture, the high time since the last rising edge.
+ */
+static void icap_capture_falling(icap_state_t *owner, uint32_t timestamp)
+{
+	uint32_t high;
+
+	if (!owner->started)
+	{
+		return;
+	}
+
+	high = timestamp - owner->last;
+	if (owner->last_period == 0 || high < owner->last_period)
+	{
+		owner->high_sum += high;
+		owner->high_count++;
+	}
+}
+
+
+/**
+ * Drains the FIFO of the IC module.
+ */
+static void icap_isr(icap_num_t icap_num)
+{
+	volatile uint16_t *buf = _icap_buf[icap_num];
+	volatile uint16_t *con = buf + 1;
+	icap_state_t *state = &_icap_states[icap_num];
+	icap_t *icap = &_icap_objects[icap_num];
+
+	if (*con & ICAP_CON_ICOV)
+	{
+		/** Captures were lost, restart the module and the window */
+		uint16_t mode = *con;
+		*con = 0;
+		while (*con & ICAP_CON_ICBNE)
+		{
+			(void)*buf;
+		}
+		*con = mode & ~ICAP_CON_ICOV;
+
+		if (state->owner >= 0)
+		{
+			_icap_objects[state->owner].overflows++;
+			_icap_states[state->owner].started = false;
+		}
+		else
+		{
+			icap->overflows++;
+			state->started = false;
+		}
+	}
+
+	while (*con & ICAP_CON_ICBNE)
+	{
+		uint32_t timestamp = icap_timestamp(icap->timer, *buf);
+
+		if (state->owner >= 0)
+		{
+			icap_capture_falling(&_icap_states[state->owner], timestamp);
+		}
+		else
+		{
+			icap_capture_rising(icap, state, timestamp);
+		}
+	}
+
+	*_icap_ifs[icap_num] &= ~_icap_int_mask[icap_num];
+}
+
+
+void icap_exec(void)
+{
+	static const uint8_t edges[6] = { 0, 0, 0, 1, 4, 16 };
+	int16_t i;
+
+	for (i = 0; i < ICAP_NUM_COUNT; i++)
+	{
+		icap_t *icap = &_icap_objects[i];
+		icap_state_t *state = &_icap_states[i];
+
+		if (!state->used || state->owner >= 0)
+		{
+			continue;
+		}
+
+		/** Timeout */
+		uint16_t captures = state->captures;
+		if (captures != state->seen_captures)
+		{
+			state->seen_captures = captures;
+			state->idle_ms = 0;
+		}
+		else if (state->idle_ms < icap->timeout && ++state->idle_ms >= icap->timeout)
+		{
+			PERFORM_CRITICAL_SECTION({
+				state->started = false;
+				state->ready   = false;
+			});
+			icap->frequency  = 0;
+			icap->duty_ratio = 0;
+			icap->valid      = false;
+			icap->updated    = true;
+		}
+
+		if (state->ready)
+		{
+			uint32_t ticks  = state->result_ticks;
+			uint16_t count  = state->result_count;
+			uint32_t high   = state->result_high;
+			uint16_t highs  = state->result_high_count;
+			state->ready = false;
+
+			icap->period_ticks = (float)ticks / ((float)count * edges[icap->prescale]);
+			icap->frequency    = (float)icap->timer_clock / icap->period_ticks;
+			if (state->falling >= 0 && highs > 0)
+			{
+				icap->duty_ratio = ((float)high / highs) / icap->period_ticks;
+			}
+			icap->valid   = true;
+			icap->updated = true;
+		}
+	}
+}
+
+
+void __attribute__((__interrupt__, no_auto_psv)) _IC1Interrupt(void)
+{
+	icap_isr(ICAP_NUM_0);
+}
+
+
+void __attribute__((__interrupt__, no_auto_psv)) _IC2Interrupt(void)
+{
+	icap_isr(ICAP_NUM_1);
+}
+
+
+void __attribute__((__interrupt__, no_auto_psv)) _IC3Interrupt(void)
+{
+	icap_isr(ICAP_NUM_2);
+}
+
+
+void __attribute__((__interrupt__, no_auto_psv)) _IC4Interrupt(void)
+{
+	icap_isr(ICAP_NUM_3);
+}
+
+
+void __attribute__((__interrupt__, no_auto_psv)) _IC5Interrupt(void)
+{
+	icap_isr(ICAP_NUM_4);
+}
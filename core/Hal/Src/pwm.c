@@ -0,0 +1,269 @@
+/*
+************************************************************
+* PWM Source File                                          *
+* (Float PWM API, a wrapper of the pwmfx functions)        *
+************************************************************
+* File:    pwm.c                                           *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+#include <pwmfx.h>
+#include <serial.h>
+
+/**
+ * TxCON and OCxCON bits.
+ */
+#define PWM_TCON_TON		0x8000
+#define PWM_CON_OCTSEL		0x0008	/** 1: Timer3, 0: Timer2				*/
+#define PWM_CON_OCM_PWM		0x0005	/** Dual compare, continuous pulses	*/
+
+/**
+ * Operation time of a channel without a timed stop.
+ */
+#define PWM_OPERATION_NONE	0xFFFF
+
+static pwm_t _pwm_objects[PWM_NUM_COUNT];
+
+static volatile uint16_t *const _pwm_tmr[2]  = { &TMR2, &TMR3 };
+static volatile uint16_t *const _pwm_tcon[2] = { &T2CON, &T3CON };
+
+
+pwm_t *pwm_get_object(pwm_num_t pwm_num)
+{
+	return &_pwm_objects[pwm_num];
+}
+
+
+pwm_group_t pwm_get_group_from_num(pwm_num_t pwm_num)
+{
+	return _pwm_objects[pwm_num].group;
+}
+
+
+/**
+ * Returns OCxCON of the channel.
+ */
+static inline volatile uint16_t *pwm_oc_con(pwm_num_t pwm_num)
+{
+	return &OC1CON + 3 * pwm_num;
+}
+
+
+/**
+ * Converts a ratio (0.0-1.0) to Q15, the only float math of a duty or shift update.
+ */
+static pwmfx_q15_t pwm_ratio_to_q15(float ratio)
+{
+	if (ratio <= 0.0f)
+	{
+		return 0;
+	}
+	if (ratio >= 1.0f)
+	{
+		return PWMFX_Q15_ONE;
+	}
+	return (pwmfx_q15_t)(ratio * 32768.0f + 0.5f);
+}
+
+
+sys_error_t pwm_set_group(pwm_num_t pwm_num, pwm_group_t pwm_group)
+{
+	volatile uint16_t *con = pwm_oc_con(pwm_num);
+
+	_pwm_objects[pwm_num].group = pwm_group;
+	if (pwm_group == PWM_GROUP_B)
+	{
+		*con |= PWM_CON_OCTSEL;
+	}
+	else
+	{
+		*con &= ~PWM_CON_OCTSEL;
+	}
+	return SYS_OK;
+}
+
+
+sys_error_t pwm_start(pwm_num_t pwm_num)
+{
+	pwm_group_t group = _pwm_objects[pwm_num].group;
+
+	*pwm_oc_con(pwm_num) |= PWM_CON_OCM_PWM;
+	*_pwm_tmr[group] = pwmfx_get_shift_ticks(pwm_num);
+	*_pwm_tcon[group] |= PWM_TCON_TON;
+	return SYS_OK;
+}
+
+
+sys_error_t pwm_stop(pwm_num_t pwm_num)
+{
+	*pwm_oc_con(pwm_num) &= ~PWM_CON_OCM_PWM;
+	return SYS_OK;
+}
+
+
+sys_error_t pwm_group_start(pwm_group_t pwm_group)
+{
+	int16_t i;
+	for (i = 0; i < PWM_NUM_COUNT; i++)
+	{
+		if (_pwm_objects[i].group == pwm_group)
+		{
+			pwm_start((pwm_num_t)i);
+		}
+	}
+	return SYS_OK;
+}
+
+
+sys_error_t pwm_group_stop(pwm_group_t pwm_group)
+{
+	int16_t i;
+	for (i = 0; i < PWM_NUM_COUNT; i++)
+	{
+		if (_pwm_objects[i].group == pwm_group)
+		{
+			pwm_stop((pwm_num_t)i);
+		}
+	}
+	return SYS_OK;
+}
+
+
+sys_error_t pwm_stop_all(void)
+{
+	pwm_group_stop(PWM_GROUP_A);
+	pwm_group_stop(PWM_GROUP_B);
+	return SYS_OK;
+}
+
+
+sys_error_t pwm_start_all(void)
+{
+	pwm_group_start(PWM_GROUP_A);
+	pwm_group_start(PWM_GROUP_B);
+	return SYS_OK;
+}
+
+
+sys_error_t pwm_set_frequency(pwm_group_t pwm_group, float frequency)
+{
+	static const uint16_t prescalers[4] = { 1, 8, 64, 256 };
+	pwmfx_period_t period;
+	float ticks = 0.0f;
+	int16_t i;
+
+	/** Smallest prescaler whose longest period (65536 ticks) is longer than the requested one */
+	for (i = 0; i < 4; i++)
+	{
+		if ((float)FCY / (prescalers[i] * 65536.0f) < frequency)
+		{
+			ticks = (float)FCY / prescalers[i] / frequency + 0.5f;
+			break;
+		}
+	}
+	if (i == 4 || ticks > 65535.0f || ticks < 1.0f)
+	{
+		serial_printf_async(SERIAL_NUM_1, "\r\nError Overflow!\r\n");
+		return SYS_ERR;
+	}
+
+	period.pr    = (uint16_t)ticks - 1;
+	period.tckps = i;
+
+	/** Rejected while the timer is shared with the icap */
+	if (pwmfx_set_period(pwm_group, &period) != SYS_OK)
+	{
+		return SYS_ERR;
+	}
+
+	for (i = 0; i < PWM_NUM_COUNT; i++)
+	{
+		if (_pwm_objects[i].group == pwm_group)
+		{
+			_pwm_objects[i].frequency    = frequency;
+			_pwm_objects[i].cycle_time   = 1.0f / frequency;
+			_pwm_objects[i].period_ticks = period.pr + 1;
+		}
+	}
+	return SYS_OK;
+}
+
+
+sys_error_t pwm_set_duty_ratio(pwm_num_t pwm_num, float duty_ratio)
+{
+	pwm_t *pwm = &_pwm_objects[pwm_num];
+
+	/** The active time ends in the period, the shift gives way to the duty */
+	if (duty_ratio + pwm->shift_ratio > 1.0f)
+	{
+		pwm->shift_ratio = 1.0f - duty_ratio;
+		serial_printf_async(SERIAL_NUM_1, "Warn: duty_ratio: %3.3f, shift_ratio %3.3f\r\n", (double)duty_ratio, (double)pwm->shift_ratio);
+	}
+	pwm->duty_ratio = duty_ratio;
+	return pwmfx_set_q15(pwm_num, pwm_ratio_to_q15(pwm->shift_ratio), pwm_ratio_to_q15(duty_ratio));
+}
+
+
+sys_error_t pwm_set_phase_shift(pwm_num_t pwm_num, float shift_ratio)
+{
+	pwm_t *pwm = &_pwm_objects[pwm_num];
+
+	/** The active time ends in the period, the duty gives way to the shift */
+	if (shift_ratio + pwm->duty_ratio >= 1.0f)
+	{
+		pwm->duty_ratio = 1.0f - shift_ratio;
+		serial_printf_async(SERIAL_NUM_1, "Warn: duty_ratio: %3.3f, shift_ratio %3.3f\r\n", (double)pwm->duty_ratio, (double)shift_ratio);
+	}
+	pwm->shift_ratio = shift_ratio;
+	return pwmfx_set_q15(pwm_num, pwm_ratio_to_q15(shift_ratio), pwm_ratio_to_q15(pwm->duty_ratio));
+}
+
+
+sys_error_t pwm_create(pwm_num_t pwm_num, pwm_group_t pwm_group, float frequency, float duty_ratio, float phase_shift, rpo_num_t rpo_num)
+{
+	pwm_t *pwm = &_pwm_objects[pwm_num];
+
+	pwm->id             = pwm_num;
+	pwm->group          = pwm_group;
+	pwm->rpo_num        = rpo_num;
+	pwm->operation_tick = PWM_OPERATION_NONE;
+
+	gpio_set_level((gpio_num_t)rpo_num, GPIO_LEVEL_HIGH);
+	gpio_set_mode((gpio_num_t)rpo_num, GPIO_MODE_DIGITAL);
+	gpio_set_direction((gpio_num_t)rpo_num, GPIO_DIRECTION_OUTPUT);
+	PERFORM_CRITICAL_SECTION({
+		pmap_map_peripheral_to_pin((pf_num_t)(PF_OC1 + pwm_num), rpo_num);
+	});
+
+	pwm_set_group(pwm_num, pwm_group);
+	pwm_set_frequency(pwm_group, frequency);
+	pwm_set_duty_ratio(pwm_num, duty_ratio);
+	pwm_set_phase_shift(pwm_num, phase_shift);
+	pwm_start(pwm_num);
+	return SYS_OK;
+}
+
+
+sys_error_t pwm_set_operation_time(pwm_num_t pwm_num, uint16_t operation_time)
+{
+	_pwm_objects[pwm_num].operation_tick = operation_time;
+	return SYS_OK;
+}
+
+
+void pwm_exec(void)
+{
+	int16_t i;
+	for (i = 0; i < PWM_NUM_COUNT; i++)
+	{
+		pwm_t *pwm = &_pwm_objects[i];
+		if (pwm->operation_tick != PWM_OPERATION_NONE && --pwm->operation_tick == 0)
+		{
+			pwm_stop((pwm_num_t)i);
+		}
+	}
+}
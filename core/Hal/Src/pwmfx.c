@@ -0,0 +1,485 @@
+/*
+************************************************************
+* PWMFX Source File                                        *
+* (Fixed-point PWM control)                                *
+************************************************************
+* File:    pwmfx.c                                         *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+#include <pwmfx.h>
+
+/**
+ * TxCON and OCxCON bits.
+ */
+#define PWMFX_TCON_TCKPS	0x0030
+#define PWMFX_CON_OCM		0x0007
+
+/**
+ * Period interrupt bits of Timer2 and Timer3 (IFS0/IEC0).
+ */
+#define PWMFX_T2_INT_MASK	(1 << 7)
+#define PWMFX_T3_INT_MASK	(1 << 8)
+
+/**
+ * Compare values of a channel, in the register order.
+ */
+typedef struct PWMFX_COMPARE_STRUCT
+{
+	uint16_t fall;		/** OCxRS	*/
+	uint16_t rise;		/** OCxR	*/
+}pwmfx_compare_t;
+
+static volatile uint16_t *const _pwmfx_pr[2]   = { &PR2, &PR3 };
+static volatile uint16_t *const _pwmfx_tmr[2]  = { &TMR2, &TMR3 };
+static volatile uint16_t *const _pwmfx_tcon[2] = { &T2CON, &T3CON };
+static const uint16_t _pwmfx_prescalers[4] = { 1, 8, 64, 256 };
+static const uint16_t _pwmfx_timer_int_mask[2] = { PWMFX_T2_INT_MASK, PWMFX_T3_INT_MASK };
+
+static pwmfx_period_handler_t _pwmfx_period_handlers[2][PWMFX_PERIOD_SLOT_COUNT];
+
+/** Shadow values written by the stage functions, and the values handed to the ISR */
+static pwmfx_compare_t		_pwmfx_staged[PWM_NUM_COUNT];
+static uint16_t				_pwmfx_staged_mask;
+static pwmfx_compare_t		_pwmfx_committed[PWM_NUM_COUNT];
+static volatile uint16_t	_pwmfx_pending[2];
+
+
+/**
+ * Returns OCxRS of the channel, OCxR and OCxCON are the next registers.
+ */
+static inline volatile uint16_t *pwmfx_oc_regs(pwm_num_t pwm_num)
+{
+	return &OC1RS + 3 * pwm_num;
+}
+
+
+/**
+ * Computes the compare values of the rising edge and the active time.
+ * The falling edge wraps to the next period if shift + duty is longer than the period.
+ */
+static void pwmfx_compare(uint16_t pr, uint16_t rise, uint16_t ticks, pwmfx_compare_t *compare)
+{
+	uint32_t period = (uint32_t)pr + 1;
+	uint32_t fall;
+
+	if (rise > pr)
+	{
+		rise = pr;
+	}
+	if (ticks >= period)
+	{
+		/** Never matched, the output stays high */
+		fall = period;
+	}
+	else
+	{
+		fall = (uint32_t)rise + ticks;
+		if (fall >= period)
+		{
+			fall -= period;
+		}
+	}
+	compare->fall = (uint16_t)fall;
+	compare->rise = rise;
+}
+
+
+/**
+ * Writes the compare registers of the rising edge and the active time.
+ */
+static void pwmfx_write(pwm_num_t pwm_num, uint16_t pr, uint16_t rise, uint16_t ticks)
+{
+	volatile uint16_t *regs = pwmfx_oc_regs(pwm_num);
+	pwmfx_compare_t compare;
+
+	pwmfx_compare(pr, rise, ticks, &compare);
+	regs[0] = compare.fall;
+	regs[1] = compare.rise;
+}
+
+
+/**
+ * Reads the active time from the compare registers.
+ */
+static uint16_t pwmfx_read_duty(pwm_num_t pwm_num, uint16_t pr)
+{
+	volatile uint16_t *regs = pwmfx_oc_regs(pwm_num);
+	uint16_t fall = regs[0];
+	uint16_t rise = regs[1];
+
+	if (fall > pr)
+	{
+		return pr + 1;
+	}
+	return (fall >= rise) ? (fall - rise) : (uint16_t)(fall + pr + 1 - rise);
+}
+
+
+sys_error_t pwmfx_period_compute(uint32_t frequency, pwmfx_period_t *period)
+{
+	uint16_t tckps;
+
+	if (frequency == 0 || frequency > FCY / 2 || period == NULL)
+	{
+		return SYS_ERR;
+	}
+
+	for (tckps = 0; tckps < 4; tckps++)
+	{
+		uint32_t ticks = (uint32_t)FCY / ((uint32_t)_pwmfx_prescalers[tckps] * frequency);
+		if (ticks <= 0xFFFF)
+		{
+			period->pr    = (uint16_t)(ticks - 1);
+			period->tckps = tckps;
+			return SYS_OK;
+		}
+	}
+	return SYS_ERR;
+}
+
+
+bool pwmfx_period_locked(pwm_group_t pwm_group)
+{
+	/** The icap extends its captures with the timer modulus cached at its start */
+	return _pwmfx_period_handlers[pwm_group][PWMFX_PERIOD_SLOT_ICAP] != NULL;
+}
+
+
+uint16_t pwmfx_get_period_ticks(pwm_group_t pwm_group)
+{
+	return *_pwmfx_pr[pwm_group] + 1;
+}
+
+
+uint16_t pwmfx_q15_to_ticks(pwm_group_t pwm_group, pwmfx_q15_t ratio)
+{
+	uint16_t pr = *_pwmfx_pr[pwm_group];
+
+	if (ratio >= PWMFX_Q15_ONE)
+	{
+		return pr + 1;
+	}
+	/** (pr + 1) * ratio / 32768, one 16x16 multiply */
+	return (uint16_t)(((uint32_t)pr * ratio + ratio) >> 15);
+}
+
+
+sys_error_t pwmfx_set_period(pwm_group_t pwm_group, const pwmfx_period_t *period)
+{
+	int16_t i;
+
+	if (pwm_group > PWM_GROUP_B || period == NULL || period->tckps > 3)
+	{
+		return SYS_ERR;
+	}
+	if (pwmfx_period_locked(pwm_group))
+	{
+		return SYS_ERR;
+	}
+
+	PERFORM_CRITICAL_SECTION({
+		uint16_t old_pr = *_pwmfx_pr[pwm_group];
+		uint32_t old_period = (uint32_t)old_pr + 1;
+		uint32_t new_period = (uint32_t)period->pr + 1;
+
+		*_pwmfx_tcon[pwm_group] = (*_pwmfx_tcon[pwm_group] & ~PWMFX_TCON_TCKPS) | (period->tckps << 4);
+		*_pwmfx_pr[pwm_group] = period->pr;
+		if (*_pwmfx_tmr[pwm_group] > period->pr)
+		{
+			*_pwmfx_tmr[pwm_group] = 0;
+		}
+
+		for (i = 0; i < PWM_NUM_COUNT; i++)
+		{
+			if (pwm_get_object((pwm_num_t)i)->group == pwm_group && (pwmfx_oc_regs((pwm_num_t)i)[2] & PWMFX_CON_OCM))
+			{
+				uint32_t rise = pwmfx_oc_regs((pwm_num_t)i)[1];
+				uint32_t duty = pwmfx_read_duty((pwm_num_t)i, old_pr);
+				pwmfx_write((pwm_num_t)i, period->pr, (uint16_t)(rise * new_period / old_period), (uint16_t)(duty * new_period / old_period));
+			}
+		}
+	});
+	return SYS_OK;
+}
+
+
+sys_error_t pwmfx_set_duty_ticks(pwm_num_t pwm_num, uint16_t ticks)
+{
+	if (pwm_num >= PWM_NUM_COUNT)
+	{
+		return SYS_ERR;
+	}
+	pwm_group_t group = pwm_get_object(pwm_num)->group;
+	pwmfx_write(pwm_num, *_pwmfx_pr[group], pwmfx_oc_regs(pwm_num)[1], ticks);
+	return SYS_OK;
+}
+
+
+sys_error_t pwmfx_set_duty_q15(pwm_num_t pwm_num, pwmfx_q15_t duty)
+{
+	if (pwm_num >= PWM_NUM_COUNT)
+	{
+		return SYS_ERR;
+	}
+	pwm_group_t group = pwm_get_object(pwm_num)->group;
+	pwmfx_write(pwm_num, *_pwmfx_pr[group], pwmfx_oc_regs(pwm_num)[1], pwmfx_q15_to_ticks(group, duty));
+	return SYS_OK;
+}
+
+
+sys_error_t pwmfx_set_shift_ticks(pwm_num_t pwm_num, uint16_t ticks)
+{
+	if (pwm_num >= PWM_NUM_COUNT)
+	{
+		return SYS_ERR;
+	}
+	uint16_t pr = *_pwmfx_pr[pwm_get_object(pwm_num)->group];
+	pwmfx_write(pwm_num, pr, ticks, pwmfx_read_duty(pwm_num, pr));
+	return SYS_OK;
+}
+
+
+sys_error_t pwmfx_set_shift_q15(pwm_num_t pwm_num, pwmfx_q15_t shift)
+{
+	if (pwm_num >= PWM_NUM_COUNT)
+	{
+		return SYS_ERR;
+	}
+	return pwmfx_set_shift_ticks(pwm_num, pwmfx_q15_to_ticks(pwm_get_object(pwm_num)->group, shift));
+}
+
+
+sys_error_t pwmfx_set_q15(pwm_num_t pwm_num, pwmfx_q15_t shift, pwmfx_q15_t duty)
+{
+	if (pwm_num >= PWM_NUM_COUNT)
+	{
+		return SYS_ERR;
+	}
+	pwm_group_t group = pwm_get_object(pwm_num)->group;
+	pwmfx_write(pwm_num, *_pwmfx_pr[group], pwmfx_q15_to_ticks(group, shift), pwmfx_q15_to_ticks(group, duty));
+	return SYS_OK;
+}
+
+
+uint16_t pwmfx_get_duty_ticks(pwm_num_t pwm_num)
+{
+	if (pwm_num >= PWM_NUM_COUNT)
+	{
+		return 0;
+	}
+	return pwmfx_read_duty(pwm_num, *_pwmfx_pr[pwm_get_object(pwm_num)->group]);
+}
+
+
+uint16_t pwmfx_get_shift_ticks(pwm_num_t pwm_num)
+{
+	if (pwm_num >= PWM_NUM_COUNT)
+	{
+		return 0;
+	}
+	return pwmfx_oc_regs(pwm_num)[1];
+}
+
+
+sys_error_t pwmfx_sync_object(pwm_num_t pwm_num)
+{
+	if (pwm_num >= PWM_NUM_COUNT)
+	{
+		return SYS_ERR;
+	}
+	pwm_t *pwm = pwm_get_object(pwm_num);
+	uint16_t pr = *_pwmfx_pr[pwm->group];
+	uint16_t prescaler = _pwmfx_prescalers[(*_pwmfx_tcon[pwm->group] & PWMFX_TCON_TCKPS) >> 4];
+	float period = (float)pr + 1.0f;
+
+	pwm->frequency   = (float)FCY / (prescaler * period);
+	pwm->duty_ratio  = pwmfx_read_duty(pwm_num, pr) / period;
+	pwm->shift_ratio = pwmfx_oc_regs(pwm_num)[1] / period;
+	return SYS_OK;
+}
+
+
+sys_error_t pwmfx_stage_ticks(pwm_num_t pwm_num, uint16_t shift, uint16_t duty)
+{
+	if (pwm_num >= PWM_NUM_COUNT)
+	{
+		return SYS_ERR;
+	}
+	pwm_group_t group = pwm_get_object(pwm_num)->group;
+	uint16_t pr = *_pwmfx_pr[group];
+	uint16_t prescaler = _pwmfx_prescalers[(*_pwmfx_tcon[group] & PWMFX_TCON_TCKPS) >> 4];
+	uint16_t edge_min = (PWMFX_STAGE_EDGE_MIN_CYCLES + prescaler - 1) / prescaler;
+	pwmfx_compare_t *compare = &_pwmfx_staged[pwm_num];
+
+	/** No edge before the ISR writes the registers, see PWMFX_STAGE_EDGE_MIN_CYCLES */
+	if (shift < edge_min)
+	{
+		shift = edge_min;
+	}
+	pwmfx_compare(pr, shift, duty, compare);
+	if (compare->fall < edge_min)
+	{
+		/** Wrapped to the next period: the active time is extended to the earliest edge */
+		compare->fall = (edge_min < compare->rise) ? edge_min : pr + 1;
+	}
+	_pwmfx_staged_mask |= 1 << pwm_num;
+	return SYS_OK;
+}
+
+
+sys_error_t pwmfx_stage_q15(pwm_num_t pwm_num, pwmfx_q15_t shift, pwmfx_q15_t duty)
+{
+	if (pwm_num >= PWM_NUM_COUNT)
+	{
+		return SYS_ERR;
+	}
+	pwm_group_t group = pwm_get_object(pwm_num)->group;
+	return pwmfx_stage_ticks(pwm_num, pwmfx_q15_to_ticks(group, shift), pwmfx_q15_to_ticks(group, duty));
+}
+
+
+/**
+ * Writes the committed channels of the group, called at the start of its period.
+ */
+static void pwmfx_stage_period(pwm_group_t pwm_group)
+{
+	uint16_t mask = _pwmfx_pending[pwm_group];
+	int16_t i;
+
+	for (i = 0; i < PWM_NUM_COUNT; i++)
+	{
+		if (mask & (1 << i))
+		{
+			volatile uint16_t *regs = pwmfx_oc_regs((pwm_num_t)i);
+			regs[0] = _pwmfx_committed[i].fall;
+			regs[1] = _pwmfx_committed[i].rise;
+		}
+	}
+	_pwmfx_pending[pwm_group] = 0;
+	pwmfx_period_attach(pwm_group, PWMFX_PERIOD_SLOT_STAGE, NULL);
+}
+
+
+sys_error_t pwmfx_commit(uint16_t pwm_mask)
+{
+	uint16_t mask = pwm_mask & _pwmfx_staged_mask;
+	uint16_t groups[2] = { 0, 0 };
+	int16_t i;
+
+	for (i = 0; i < PWM_NUM_COUNT; i++)
+	{
+		if (mask & (1 << i))
+		{
+			groups[pwm_get_object((pwm_num_t)i)->group] |= 1 << i;
+		}
+	}
+
+	/** The ISR never sees a channel with a new rise and an old fall */
+	PERFORM_CRITICAL_SECTION({
+		for (i = 0; i < PWM_NUM_COUNT; i++)
+		{
+			if (mask & (1 << i))
+			{
+				_pwmfx_committed[i] = _pwmfx_staged[i];
+			}
+		}
+		_pwmfx_pending[PWM_GROUP_A] |= groups[PWM_GROUP_A];
+		_pwmfx_pending[PWM_GROUP_B] |= groups[PWM_GROUP_B];
+	});
+	_pwmfx_staged_mask &= ~mask;
+
+	for (i = PWM_GROUP_A; i <= PWM_GROUP_B; i++)
+	{
+		if (groups[i])
+		{
+			pwmfx_period_attach((pwm_group_t)i, PWMFX_PERIOD_SLOT_STAGE, pwmfx_stage_period);
+		}
+	}
+	return SYS_OK;
+}
+
+
+void pwmfx_discard(uint16_t pwm_mask)
+{
+	_pwmfx_staged_mask &= ~pwm_mask;
+}
+
+
+uint16_t pwmfx_get_pending(void)
+{
+	return _pwmfx_pending[PWM_GROUP_A] | _pwmfx_pending[PWM_GROUP_B];
+}
+
+
+sys_error_t pwmfx_period_attach(pwm_group_t pwm_group, pwmfx_period_slot_t slot, pwmfx_period_handler_t handler)
+{
+	uint16_t int_mask;
+	int16_t i;
+
+	if (pwm_group > PWM_GROUP_B || slot >= PWMFX_PERIOD_SLOT_COUNT)
+	{
+		return SYS_ERR;
+	}
+	int_mask = _pwmfx_timer_int_mask[pwm_group];
+
+	PERFORM_CRITICAL_SECTION({
+		bool attached = false;
+		_pwmfx_period_handlers[pwm_group][slot] = handler;
+		for (i = 0; i < PWMFX_PERIOD_SLOT_COUNT; i++)
+		{
+			if (_pwmfx_period_handlers[pwm_group][i] != NULL)
+			{
+				attached = true;
+			}
+		}
+
+		if (!attached)
+		{
+			IEC0 &= ~int_mask;
+		}
+		else if (!(IEC0 & int_mask))
+		{
+			/** A stale flag of the disabled interrupt is not a period of the new handler */
+			IFS0 &= ~int_mask;
+			IEC0 |= int_mask;
+		}
+	});
+	return SYS_OK;
+}
+
+
+/**
+ * Calls the handlers of the group in the slot order.
+ */
+static inline void pwmfx_period_isr(pwm_group_t pwm_group)
+{
+	int16_t i;
+
+	/** Cleared first, a period that ends while the handlers run is not lost */
+	IFS0 &= ~_pwmfx_timer_int_mask[pwm_group];
+	for (i = 0; i < PWMFX_PERIOD_SLOT_COUNT; i++)
+	{
+		pwmfx_period_handler_t handler = _pwmfx_period_handlers[pwm_group][i];
+		if (handler != NULL)
+		{
+			handler(pwm_group);
+		}
+	}
+}
+
+
+void __attribute__((__interrupt__, no_auto_psv)) _T2Interrupt(void)
+{
+	pwmfx_period_isr(PWM_GROUP_A);
+}
+
+
+void __attribute__((__interrupt__, no_auto_psv)) _T3Interrupt(void)
+{
+	pwmfx_period_isr(PWM_GROUP_B);
+}
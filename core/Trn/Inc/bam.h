@@ -0,0 +1,121 @@
+/*
+************************************************************
+* BAM Header File                                          *
+* (Bit-angle-modulation software PWM)                      *
+************************************************************
+* File:    bam.h                                           *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+/**
+ * The BAM engine dims up to BAM_PIN_MAX GPIOs with 8-bit brightness. A frame is split into
+ * 8 bit-planes, the plane n lasts (2^n x lsb) timer ticks and drives every pin whose brightness
+ * has the bit n set:
+ *
+ * |b0|-b1-|---b2---|-------b3-------| ... |---------------b7---------------| next frame
+ *
+ * The planes are precomputed LAT images of PORTA and PORTB, so the ISR writes two registers
+ * per plane whatever the number of pins. 8 interrupts are taken per frame.
+ *
+ * The timebase is an OC module of the ocgen (ocgen_init) used only for its compare interrupt,
+ * no output pin is mapped. The pins can be any RA/RB GPIOs.
+ *
+ * The brightness levels are double-buffered: bam_set_level() stages a level, bam_commit()
+ * builds the planes in the back buffer and the ISR switches the buffers at the next frame,
+ * so a frame never shows a partial update.
+ *
+ *   static const gpio_num_t leds[4] = { GPIO_RB_4, GPIO_RB_5, GPIO_RB_6, GPIO_RB_7 };
+ *   ocgen_init(OCGEN_TIMER_3, 0x10);       // OC5 for the BAM
+ *   bam_init(leds, 4, 200);                // 200 Hz frames
+ *   bam_set_level(0, 16);
+ *   bam_set_level(3, 255);
+ *   bam_commit();
+ *
+ * Note:
+ * - The ISR rewrites the BAM pins of the port with a read-modify-write of the LAT register.
+ *   Other pins of the same port must be written with single instructions (fastio_port_set,
+ *   fastio_port_clear) or inside a critical section.
+ */
+
+#ifndef __BAM_H__
+#define __BAM_H__
+
+	#include <ocgen.h>
+	#include <fastio.h>
+
+	/**
+	 * Maximum number of pins.
+	*/
+	#define BAM_PIN_MAX				16
+
+	/**
+	 * Number of bit-planes (brightness resolution).
+	*/
+	#define BAM_PLANE_COUNT			8
+
+
+	/**
+	 * Starts the BAM engine on the given pins, all brightness levels are 0.
+	 * Parameters:
+	 * - pins: GPIOs, the brightness index n is pins[n].
+	 * - count: Number of pins, 1 to BAM_PIN_MAX.
+	 * - frame_hz: Frame rate. The shortest plane must be longer than the OC interrupt,
+	 *   about 490 Hz is the maximum at FCY/8.
+	 * Return:
+	 * - SYS_ERR if ocgen_init() was not called, no OC module is free or the frame rate is out of range.
+	*/
+	sys_error_t bam_init(const gpio_num_t *pins, uint8_t count, uint16_t frame_hz);
+
+
+	/**
+	 * Stops the engine, releases the OC module and drives all BAM pins low.
+	*/
+	void bam_stop(void);
+
+
+	/**
+	 * Stages the brightness of a pin, it is shown after bam_commit().
+	 * Parameters:
+	 * - index: Index of the pin in the `pins` of bam_init().
+	 * - level: Brightness, 0 (off) to 255 (on).
+	*/
+	sys_error_t bam_set_level(uint8_t index, uint8_t level);
+
+
+	/**
+	 * Returns the staged brightness of a pin.
+	*/
+	uint8_t bam_get_level(uint8_t index);
+
+
+	/**
+	 * Builds the bit-planes of the staged levels. They are shown from the next frame.
+	 * A commit that was not shown yet is replaced by this one.
+	*/
+	sys_error_t bam_commit(void);
+
+
+	/**
+	 * Stages all brightness levels and commits them.
+	 * Parameter:
+	 * - levels: `count` levels, see bam_init().
+	*/
+	sys_error_t bam_write(const uint8_t *levels);
+
+
+	/**
+	 * Returns true while a commit is waiting for the next frame.
+	*/
+	bool bam_is_pending(void);
+
+
+	/**
+	 * Returns the number of planes that started late (ISR latency longer than the plane).
+	*/
+	uint16_t bam_get_slips(void);
+
+#endif //__BAM_H__
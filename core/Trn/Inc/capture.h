@@ -0,0 +1,179 @@
+/*
+************************************************************
+* CAPTURE Header File                                      *
+* (Triggered capture of the analog channels)               *
+************************************************************
+* File:    capture.h                                       *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+#ifndef __CAPTURE_H__
+#define __CAPTURE_H__
+
+    #include <analog.h>
+    #include <serial.h>
+    #include <crc.h>
+
+    /**
+     * Number of 10-bit samples (all channels) stored in the capture ring.
+     * One record holds one sample of every channel selected in the channel mask.
+    */
+    #define CAPTURE_BUFFER_LENGTH   256
+
+
+    /**
+     * Header bytes of the binary capture block.
+    */
+    #define CAPTURE_BLOCK_SYNC_0    'C'
+    #define CAPTURE_BLOCK_SYNC_1    'P'
+
+
+    typedef enum CAPTURE_TRIGGER_TYPE {
+        CAPTURE_TRIGGER_NONE,           /** Triggered immediately after the pre-trigger is filled */
+        CAPTURE_TRIGGER_ANALOG_RISING,  /** Analog value crosses the level upward      */
+        CAPTURE_TRIGGER_ANALOG_FALLING, /** Analog value crosses the level downward    */
+        CAPTURE_TRIGGER_ANALOG_ABOVE,   /** Analog value is greater than the level      */
+        CAPTURE_TRIGGER_ANALOG_BELOW,   /** Analog value is less than the level         */
+        CAPTURE_TRIGGER_GPIO_RISING,    /** GPIO changes from LOW to HIGH               */
+        CAPTURE_TRIGGER_GPIO_FALLING,   /** GPIO changes from HIGH to LOW               */
+        CAPTURE_TRIGGER_GPIO_CHANGE     /** GPIO changes in any direction               */
+    }capture_trigger_t;
+
+
+    typedef enum CAPTURE_STATE_TYPE {
+        CAPTURE_STATE_IDLE,             /** Not armed                                   */
+        CAPTURE_STATE_ARMED,            /** Filling the pre-trigger, waiting for trigger*/
+        CAPTURE_STATE_TRIGGERED,        /** Filling the post-trigger                    */
+        CAPTURE_STATE_COMPLETED         /** Capture is ready to be read                 */
+    }capture_state_t;
+
+
+    typedef void (*capture_callback_t)(void *);
+
+
+    typedef struct CAPTURE_STRUCT {
+        uint8_t             channel_mask;       /** Captured channels, bit n is ANALOG_NUM_n    */
+        uint8_t             channel_count;      /** Number of captured channels (record size)   */
+        capture_trigger_t   trigger;            /** Trigger type                                */
+        analog_num_t        trigger_analog;     /** Trigger source of the analog triggers       */
+        gpio_num_t          trigger_gpio;       /** Trigger source of the GPIO triggers         */
+        int16_t             trigger_level;      /** Trigger level of the analog triggers        */
+        uint16_t            pre_trigger;        /** Records kept before the trigger             */
+        uint16_t            post_trigger;       /** Records captured after the trigger          */
+        uint16_t            sampling_interval;  /** Ticks (ms) between records                  */
+        capture_state_t     state;              /** Capture state                               */
+        capture_callback_t  callback;           /** Called when the capture is completed        */
+        uint32_t            trigger_tick;       /** System tick of the trigger event            */
+        uint16_t            records;            /** Internally used: capacity in records        */
+        uint16_t            put;                /** Internally used: next record index          */
+        uint16_t            count;              /** Internally used: stored records             */
+        uint16_t            remain;             /** Internally used: post-trigger records left  */
+        uint16_t            ticks;              /** Internally used: sampling tick counter      */
+        int16_t             previous;           /** Internally used: previous trigger input     */
+    }capture_t;
+
+
+    /**
+     * Returns the capture object.
+    */
+    capture_t * capture_get_object(void);
+
+
+    /**
+     * Creates a capture of the given analog channels.
+     * Parameters:
+     * - channel_mask: Channels to be captured, bit n selects ANALOG_NUM_n.
+     * - sampling_interval: Time interval (in milliseconds) between the records (1-65535).
+     * - pre_trigger: Number of records kept before the trigger.
+     * - post_trigger: Number of records captured after the trigger (including the trigger record).
+     * Note:
+     * - The channels must be initialized using the analog_init function.
+     * - The pre_trigger + post_trigger must not exceed CAPTURE_BUFFER_LENGTH / channel count.
+    */
+    sys_error_t capture_create(uint8_t channel_mask, uint16_t sampling_interval, uint16_t pre_trigger, uint16_t post_trigger);
+
+
+    /**
+     * Sets an analog trigger of the capture.
+     * Parameters:
+     * - trigger: CAPTURE_TRIGGER_ANALOG_<RISING|FALLING|ABOVE|BELOW>.
+     * - analog_num: Trigger source, it does not need to be a captured channel.
+     * - level: Trigger level, 0-1023.
+    */
+    sys_error_t capture_set_analog_trigger(capture_trigger_t trigger, analog_num_t analog_num, int16_t level);
+
+
+    /**
+     * Sets a GPIO trigger of the capture.
+     * Parameters:
+     * - trigger: CAPTURE_TRIGGER_GPIO_<RISING|FALLING|CHANGE>.
+     * - gpio_num: Trigger source, the GPIO must be a digital input.
+    */
+    sys_error_t capture_set_gpio_trigger(capture_trigger_t trigger, gpio_num_t gpio_num);
+
+
+    /**
+     * Sets the callback function called when the capture is completed.
+     * Parameter:
+     * - callback: Callback function, the capture object is passed as its parameter.
+    */
+    sys_error_t capture_set_callback(capture_callback_t callback);
+
+
+    /**
+     * Clears the ring buffer and arms the trigger.
+     * The trigger is accepted only after the pre-trigger records are filled.
+    */
+    sys_error_t capture_arm(void);
+
+
+    /**
+     * Forces the trigger of an armed capture.
+    */
+    sys_error_t capture_force_trigger(void);
+
+
+    /**
+     * Stops the capture. The stored records are kept.
+    */
+    sys_error_t capture_stop(void);
+
+
+    /**
+     * Copies the captured records (oldest first) of one channel to the given buffer.
+     * Parameters:
+     * - analog_num: Channel to be copied, it must be selected in the channel mask.
+     * - buffer: Output buffer.
+     * - length: Length of the output buffer (samples).
+     * Return:
+     * - Number of samples copied, or -1 on error.
+    */
+    int16_t capture_read_channel(analog_num_t analog_num, int16_t *buffer, uint16_t length);
+
+
+    /**
+     * Sends a completed capture as a single binary block (synchronous).
+     * Parameter:
+     * - serial_num: Id of the target uart.
+     *
+     * Block layout, all multi-byte fields are little-endian:
+     * | 'C' | 'P' | mask (1) | channels (1) | interval (2) | records (2) | pre-trigger (2) | trigger tick (4) |
+     * | samples, records x channels x int16, oldest record first | CRC-16/CCITT of all previous bytes (2) |
+     *
+     * Note:
+     * - The pre-trigger field holds the number of records before the trigger record.
+    */
+    sys_error_t capture_send(serial_num_t serial_num);
+
+
+    /**
+     * Executes the capture sampling and trigger detection.
+     * This function must be called by the main loop every 1 ms (system tick), after analog_exec_read().
+    */
+    void capture_exec(void);
+
+#endif // __CAPTURE_H__
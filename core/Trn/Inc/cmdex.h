@@ -1,25 +1,219 @@
 /*
 ************************************************************
 * CMDEX Header File                                        *
+* (Command line registry and dispatcher)                   *
 ************************************************************
 * File:    cmdex.h                                         *
 * Author:  Asst.Prof.Dr.Santi Nuratch                      *
 *          Embedded Computing and Control Laboratory       *
 *          ECC-Lab, INC, KMUTT, Thailand                   *
-* Update:  28 March 2023                                   *
+* Update:  19 October 2026                                 *
 ************************************************************
 */
 
+/**
+ * A command line is a name and up to CMDEX_ARG_MAX arguments separated by spaces, tabs or commas:
+ *
+ *   pwm 0 250
+ *   gain 2,-0x10
+ *
+ * The commands are entries of const tables sorted by name, the user table is registered by
+ * cmdex_register() and searched (binary search, strcmp) before the built-in table (adc, help, pwm, watch).
+ * The line is split in place (the separators are replaced by '\0'), no memory is allocated.
+ *
+ * The schema of a command gives the type of each argument, one character per argument:
+ * - 'i': Integer, decimal, 0x hexadecimal or 0b binary, with an optional sign. The value is in `value[n]`.
+ * - 's': Word, `argv[n]` only.
+ * - '?': The following arguments are optional.
+ * The arguments are checked against the schema before the handler is called, the handler only
+ * reads `argv` and `value`.
+ *
+ *   static sys_error_t cmd_gain(const cmdex_args_t *args) { ... args->value[1] ... }
+ *   static sys_error_t cmd_mode(const cmdex_args_t *args) { ... args->argv[1] ... }
+ *
+ *   static const cmdex_command_t commands[] = {     // sorted by name
+ *       { "gain", cmd_gain, "ii",  "gain <kp> <ki>" },
+ *       { "mode", cmd_mode, "s?i", "mode <name> [level]" }
+ *   };
+ *   cmdex_register(commands, 2);
+ *   cmdex_init(SERIAL_NUM_1, 64);                   // line receiver of UART1
+ *
+ * Replies: "ERR <reason>" for a line that cannot be dispatched or a handler that returns SYS_ERR,
+ * the handlers print their own results.
+ *
+ * Batches: a line of up to CMDEX_BATCH_MAX commands separated by ';' is applied as one batch:
+ *
+ *   pwm 0 250; pwm 1 750; mode fast
+ *
+ * The batch runs in two passes, nothing is applied unless every command passes its checks:
+ * - All commands are parsed and checked against their schemas.
+ * - Check pass: every handler is called with cmdex_batch_checking() true. It checks its arguments
+ *   and returns SYS_OK if it would succeed, without applying anything.
+ * - Apply pass: the handlers are called again with the system tick interrupt masked, so the tick
+ *   sees all effects of the batch or none of them. The PWM writes of cmdex_pwm_write() are staged,
+ *   then committed together by cmdex_batch_end(), and the channels of a group change at the same period.
+ * One status is replied: "OK <count>", or "ERR <index> <reason>" with the index (from 0) of the
+ * first command that failed. A failure in the check pass means no handler applied anything.
+ * An apply pass that takes longer than one system tick (the handlers must be short, a masked tick
+ * is late) replies "ERR <count> tick overrun", and its PWM writes are dropped before the commit.
+ * The effects that the handlers apply themselves are not staged and not undone, a handler that
+ * cannot be applied with the tick masked returns SYS_ERR while cmdex_batch_active() (watch does).
+ */
+
 #ifndef __CMDEX_H__
 #define __CMDEX_H__
 
 	#include <pwm.h>
+	#include <pwmfx.h>
 	#include <analog.h>
 	#include <switch.h>
 	#include <pdsgen.h>
-    #include <serial.h>
+	#include <serial.h>
+
+	/**
+	 * Maximum number of tokens of a line, the name included.
+	*/
+	#define CMDEX_ARG_MAX		8
+
+	/**
+	 * Maximum number of commands of a batch, and their separator.
+	*/
+	#define CMDEX_BATCH_MAX		6
+	#define CMDEX_BATCH_SEPARATOR	';'
+
+	/**
+	 * Shift of cmdex_pwm_write() that keeps the current shift of the channel.
+	*/
+	#define CMDEX_PWM_KEEP		0xFFFFu
+
+
+	typedef struct CMDEX_ARGS_STRUCT {
+		serial_num_t 	serial_num;				/** Port of the replies					*/
+		uint8_t 		argc;					/** Number of tokens, the name included	*/
+		char 			*argv[CMDEX_ARG_MAX];	/** Tokens, argv[0] is the name			*/
+		int32_t 		value[CMDEX_ARG_MAX];	/** Values of the 'i' arguments			*/
+	}cmdex_args_t;
+
+
+	typedef sys_error_t (*cmdex_handler_t)(const cmdex_args_t *args);
+
+
+	typedef struct CMDEX_COMMAND_STRUCT {
+		const char 		*name;					/** Name, the table is sorted by name	*/
+		cmdex_handler_t handler;				/** Called with the parsed arguments	*/
+		const char 		*schema;				/** Argument types, see above			*/
+		const char 		*help;					/** Usage printed by `help`				*/
+	}cmdex_command_t;
+
+
+	/**
+	 * Creates the line receiver of the serial port, its lines are passed to cmdex_exec().
+	 * Parameters:
+	 * - serial_num: Id of the serial port, initialized by serial_init().
+	 * - max_length: Maximum length of a line.
+	*/
+	sys_error_t cmdex_init(serial_num_t serial_num, uint16_t max_length);
+
+
+	/**
+	 * Registers the user command table, it replaces the previous table.
+	 * Parameters:
+	 * - commands: Table (const, in flash), sorted by name in strcmp order without duplicates.
+	 * - count: Number of commands.
+	*/
+	sys_error_t cmdex_register(const cmdex_command_t *commands, uint16_t count);
+
+
+	/**
+	 * Returns the command of the name, or NULL.
+	*/
+	const cmdex_command_t * cmdex_find(const char *name);
+
+
+	/**
+	 * Splits the line in place into tokens.
+	 * Return:
+	 * - Number of tokens, or -1 if there are more than `max_tokens`.
+	*/
+	int16_t cmdex_tokenize(char *line, char **tokens, uint8_t max_tokens);
+
 
+	/**
+	 * Parses a decimal, 0x hexadecimal or 0b binary integer with an optional sign.
+	 * The whole token must be a number that fits int32_t.
+	*/
+	sys_error_t cmdex_parse_int(const char *token, int32_t *value);
 
+
+	/**
+	 * Parses and dispatches a command line or a batch without replies.
+	 * Return:
+	 * - SYS_OK if the handlers were called and returned SYS_OK.
+	*/
+	sys_error_t cmdex_dispatch(char *p_line, serial_num_t serial_num);
+
+
+	/**
+	 * Parses and dispatches a command line or a batch, errors and the status of a batch are
+	 * replied to the port of cmdex_init(). The line is modified.
+	*/
 	void cmdex_exec(char *p_line);
-	
+
+
+	/**
+	 * Like cmdex_exec(), the replies and the output started by the commands (watch) go to
+	 * `serial_num`. Used by receivers other than the line receiver of cmdex_init() (rpc).
+	*/
+	void cmdex_exec_on(char *p_line, serial_num_t serial_num);
+
+
+	/**
+	 * Starts a batch in the check pass, cmdex_pwm_write() only checks its arguments.
+	 * Used by the batches of cmdex and rpc.
+	*/
+	void cmdex_batch_begin(void);
+
+
+	/**
+	 * Ends the check pass, the following cmdex_pwm_write() calls are staged.
+	 * The caller masks the system tick (TIMER1_ISR_DISABLE) before the apply pass and enables it
+	 * after cmdex_batch_end() and its own staged writes.
+	*/
+	void cmdex_batch_apply(void);
+
+
+	/**
+	 * Ends the batch and commits the staged PWM channels (pwmfx_commit).
+	 * Parameters:
+	 * - commit: false drops the staged channels (a command failed).
+	 * Return:
+	 * - SYS_OK if the channels were committed. The staged channels are dropped if the batch
+	 *   ends in the check pass or its apply pass took longer than one system tick.
+	*/
+	sys_error_t cmdex_batch_end(bool commit);
+
+
+	/**
+	 * Returns true in the check pass of a batch, the handlers only check their arguments.
+	*/
+	bool cmdex_batch_checking(void);
+
+
+	/**
+	 * Returns true between cmdex_batch_begin() and cmdex_batch_end().
+	*/
+	bool cmdex_batch_active(void);
+
+
+	/**
+	 * Sets the shift and the duty of a PWM channel from a command handler.
+	 * In a batch the values are checked only (check pass) or staged and committed by
+	 * cmdex_batch_end() (apply pass), otherwise they are written immediately.
+	 * Parameters:
+	 * - pwm_num: Id of the channel.
+	 * - shift: Shift in Q15, or CMDEX_PWM_KEEP to keep the current shift.
+	 * - duty: Duty in Q15.
+	*/
+	sys_error_t cmdex_pwm_write(pwm_num_t pwm_num, uint16_t shift, pwmfx_q15_t duty);
+
 #endif // __CMDEX_H__
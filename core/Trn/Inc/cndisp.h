@@ -0,0 +1,67 @@
+/*
+************************************************************
+* CNDISP Header File                                       *
+* (Change notification dispatcher)                         *
+************************************************************
+* File:    cndisp.h                                        *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+/**
+ * The gpio module takes a single change notification (CN) callback. The dispatcher is that
+ * callback and calls the handler of each slot in the slot order, so debounce, edge, qenc and
+ * the user can all use the CN at the same time. Each module has its own slot and attaches to it
+ * when it is created.
+ *
+ *   cndisp_attach(CNDISP_SLOT_USER, my_cn_handler);
+ *
+ * Note:
+ * - Do not call gpio_change_notification_set_callback() directly, it disconnects all slots.
+ * - The handlers are called in ISR context with the same port snapshots.
+ */
+
+#ifndef __CNDISP_H__
+#define __CNDISP_H__
+
+    #include <gpio.h>
+
+    typedef enum CNDISP_SLOT_TYPE {
+        CNDISP_SLOT_DEBOUNCE,
+        CNDISP_SLOT_EDGE,
+        CNDISP_SLOT_QENC,
+        CNDISP_SLOT_USER,
+        CNDISP_SLOT_COUNT
+    }cndisp_slot_t;
+
+
+    /**
+     * Sets the handler of the slot and registers the dispatcher as the CN callback.
+     * Parameters:
+     * - slot: Slot of the handler, CNDISP_SLOT_USER for the user code.
+     * - handler: Handler called from the CN ISR, it replaces the previous handler of the slot.
+    */
+    sys_error_t cndisp_attach(cndisp_slot_t slot, gpio_inputs_change_callback_t handler);
+
+
+    /**
+     * Clears the handler of the slot, the other slots are kept.
+     * Parameter:
+     * - slot: Slot of the handler.
+    */
+    sys_error_t cndisp_detach(cndisp_slot_t slot);
+
+
+    /**
+     * Calls the handlers of all slots, registered as the CN callback by cndisp_attach().
+     * Parameter:
+     * - data: Port snapshots passed by the CN ISR.
+     * Note:
+     * - Called in ISR context.
+    */
+    void cndisp_handler(gpio_inputs_change_data_t *data);
+
+#endif // __CNDISP_H__
@@ -0,0 +1,42 @@
+/*
+************************************************************
+* CRC Header File                                          *
+************************************************************
+* File:    crc.h                                           *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+#ifndef __CRC_H__
+#define __CRC_H__
+
+    #include <hal.h>
+
+    /**
+     * Initial value of the CRC-16/CCITT-FALSE checksum.
+    */
+    #define CRC16_INIT      0xFFFF
+
+
+    /**
+     * Updates the CRC-16/CCITT-FALSE (poly 0x1021) checksum with a single byte.
+     * Parameters:
+     * - crc: Current checksum value, CRC16_INIT for the first byte.
+     * - byte: Byte data to be added to the checksum.
+    */
+    uint16_t crc16_update(uint16_t crc, uint8_t byte);
+
+
+    /**
+     * Computes the CRC-16/CCITT-FALSE checksum of the given bytes.
+     * Parameters:
+     * - crc: Current checksum value, CRC16_INIT for a new checksum.
+     * - bytes: Bytes data to be added to the checksum.
+     * - length: Number of bytes of the byte data.
+    */
+    uint16_t crc16_compute(uint16_t crc, const uint8_t *bytes, uint16_t length);
+
+#endif // __CRC_H__
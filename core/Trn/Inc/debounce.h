@@ -0,0 +1,203 @@
+/*
+************************************************************
+* DEBOUNCE Header File                                     *
+* (Event-driven switch debouncing)                         *
+************************************************************
+* File:    debounce.h                                      *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+/**
+ * The switch_exec() polls and runs the debounce FSM of every switch each tick.
+ * The debounce module arms the FSM of a switch only after a change notification (CN)
+ * edge on its pin. Idle switches are not touched, debounce_exec() returns immediately
+ * when no switch is active. A switch stays active while it is pressed (hold/repeat timing)
+ * and until its released level is stable again.
+ *
+ * The callbacks receive a switch_t object, the same as the switch module.
+ *
+ * The vertical engine (debounce_vertical_*) debounces all inputs of one port at once.
+ * It reads the PORTA or PORTB image once per sample and runs a 2-bit vertical counter
+ * per pin (4 equal samples change the state) with bitwise operations, so its cost does not
+ * depend on the number of inputs. The hold and repeat timing uses a bit-sliced counter.
+ * Every sample produces press, release, hold and repeat event masks.
+ */
+
+#ifndef __DEBOUNCE_H__
+#define __DEBOUNCE_H__
+
+    #include <switch.h>
+    #include <cndisp.h>
+
+    /**
+     * Default timing in ticks (ms).
+    */
+    #define DEBOUNCE_STABLE_TICKS       20
+    #define DEBOUNCE_HOLD_TICKS         1000
+    #define DEBOUNCE_REPEAT_TICKS       200
+
+    /**
+     * Number of bit planes of the vertical hold/repeat counter.
+     * The hold and repeat times are limited to DEBOUNCE_VERTICAL_SAMPLES_MAX (2^bits - 1) samples,
+     * 1023 samples hold the default 1000 ms at a sampling interval of 1 ms.
+    */
+    #define DEBOUNCE_VERTICAL_TIMER_BITS    10
+    #define DEBOUNCE_VERTICAL_SAMPLES_MAX   ((1 << DEBOUNCE_VERTICAL_TIMER_BITS) - 1)
+
+
+    typedef struct DEBOUNCE_VERTICAL_STRUCT {
+        volatile uint16_t   *port;          /** PORTA or PORTB                              */
+        gpio_group_t        group;          /** Debounced port                              */
+        uint16_t            mask;           /** Debounced pins                              */
+        uint16_t            invert;         /** Pins whose ON level is 0                    */
+        uint16_t            state;          /** Debounced state, 1 is ON                    */
+        uint16_t            press;          /** Event mask: OFF to ON in the last sample    */
+        uint16_t            release;        /** Event mask: ON to OFF in the last sample    */
+        uint16_t            hold;           /** Event mask: hold time reached               */
+        uint16_t            repeat;         /** Event mask: repeat time reached             */
+        uint16_t            holding;        /** Pins in the HOLD/REPEAT state               */
+        uint16_t            sampling_interval;  /** Ticks between the samples           */
+        uint16_t            hold_samples;   /** Samples from ON to HOLD, 0 disables         */
+        uint16_t            repeat_samples; /** Samples between REPEATs, 0 disables         */
+        callback_t          callback;       /** Called with this object when any event      */
+        uint16_t            ticks;          /** Internally used: sampling tick counter      */
+        uint16_t            count0;         /** Internally used: vertical counter, bit 0    */
+        uint16_t            count1;         /** Internally used: vertical counter, bit 1    */
+        uint16_t            timer[DEBOUNCE_VERTICAL_TIMER_BITS];    /** Internally used: hold/repeat counter */
+    }debounce_vertical_t;
+
+
+    /**
+     * Returns the switch object of the debouncer specified by the switch_num.
+     * Parameter:
+     * - switch_num: Id of the switch, SWITCH_NUM_<3:0>.
+    */
+    switch_t * debounce_get_object(switch_num_t switch_num);
+
+
+    /**
+     * Creates an event-driven switch detector.
+     * Parameters:
+     * - switch_num: Id of the switch, SWITCH_NUM_<3:0>.
+     * - gpio_num: GPIO connected to the switch. It is set to digital input with CN enabled.
+     * - switch_callback: Callback function called when the switch state is changed.
+     * Note:
+     * - Do not create the same switch with switch_create_detector(), it would be polled by switch_exec().
+     * - The ON level is 0 by default, see debounce_set_on_level().
+    */
+    sys_error_t debounce_create_detector(switch_num_t switch_num, gpio_num_t gpio_num, switch_callback_t switch_callback);
+
+
+    /**
+     * Deletes the detector. The CN of the GPIO is kept enabled.
+     * Parameter:
+     * - switch_num: Id of the switch.
+    */
+    sys_error_t debounce_delete(switch_num_t switch_num);
+
+
+    /**
+     * Sets on-level value of the switch.
+     * Parameters:
+     * - switch_num: Id of the switch.
+     * - switch_on_value: ON value of the switch, 0 or 1.
+    */
+    sys_error_t debounce_set_on_level(switch_num_t switch_num, int16_t switch_on_value);
+
+
+    /**
+     * Sets the debounce timing of all detectors.
+     * Parameters:
+     * - stable_ticks: Ticks the level must be stable (1-32767).
+     * - hold_ticks: Ticks from ON to HOLD, 0 disables hold and repeat.
+     * - repeat_ticks: Ticks between the REPEAT events, 0 disables repeat.
+     * Return:
+     * - SYS_ERR if the vertical debouncer is running and the hold or repeat time is longer than
+     *   DEBOUNCE_VERTICAL_SAMPLES_MAX samples of it, the timing is not changed.
+    */
+    sys_error_t debounce_set_timing(int16_t stable_ticks, int16_t hold_ticks, int16_t repeat_ticks);
+
+
+    /**
+     * Returns the bit mask of the active switches (bit n is SWITCH_NUM_n).
+    */
+    uint16_t debounce_get_active_mask(void);
+
+
+    /**
+     * Change notification handler of the debouncer.
+     * It is attached to CNDISP_SLOT_DEBOUNCE of the CN dispatcher by debounce_create_detector().
+     * Parameter:
+     * - data: Port snapshots passed by the CN ISR.
+     * Note:
+     * - Called in ISR context.
+    */
+    void debounce_cn_handler(gpio_inputs_change_data_t *data);
+
+
+    /**
+     * Returns the vertical debouncer object.
+    */
+    debounce_vertical_t * debounce_vertical_get_object(void);
+
+
+    /**
+     * Starts the vertical debouncer on the given port.
+     * Parameters:
+     * - gpio_group: Port to be debounced, GPIO_GROUP_A or GPIO_GROUP_B.
+     * - mask: Pins to be debounced. They must be configured as digital inputs.
+     * - on_levels: ON level of each pin, 0 bits are active-low pins (e.g. the PSWs).
+     * - sampling_interval: Ticks between the samples (1-65535), the debounce time is 4 samples.
+     * Return:
+     * - SYS_ERR if the hold or repeat time of debounce_set_timing() is longer than
+     *   DEBOUNCE_VERTICAL_SAMPLES_MAX samples (1023 ms at a sampling interval of 1 ms).
+     * Note:
+     * - The hold and repeat times are set by debounce_set_timing() and rounded up to samples.
+    */
+    sys_error_t debounce_vertical_start(gpio_group_t gpio_group, uint16_t mask, uint16_t on_levels, uint16_t sampling_interval);
+
+
+    /**
+     * Stops the vertical debouncer.
+    */
+    sys_error_t debounce_vertical_stop(void);
+
+
+    /**
+     * Sets the callback function called with the debouncer object when any event mask is not zero.
+     * Parameter:
+     * - callback: Callback function.
+    */
+    sys_error_t debounce_vertical_set_callback(callback_t callback);
+
+
+    /**
+     * Creates a switch detector served by the vertical debouncer.
+     * Its callback is dispatched from the event masks with the same switch_t object and states as
+     * the detectors created by debounce_create_detector(). The CN of the pin is not used.
+     * Parameters:
+     * - switch_num: Id of the switch, SWITCH_NUM_<3:0>.
+     * - gpio_num: GPIO connected to the switch, it must be in the debounced port and mask.
+     * - switch_callback: Callback function called when the switch state is changed.
+    */
+    sys_error_t debounce_vertical_create_detector(switch_num_t switch_num, gpio_num_t gpio_num, switch_callback_t switch_callback);
+
+
+    /**
+     * Executes the vertical debouncer and dispatches its events.
+     * This function must be called by the main loop every 1 ms.
+    */
+    void debounce_vertical_exec(void);
+
+
+    /**
+     * Executes the debounce FSM of the active switches.
+     * This function must be called by the main loop every 1 ms.
+    */
+    void debounce_exec(void);
+
+#endif // __DEBOUNCE_H__
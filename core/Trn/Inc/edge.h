@@ -0,0 +1,136 @@
+/*
+************************************************************
+* EDGE Header File                                         *
+* (Timestamped input edges from change notification)       *
+************************************************************
+* File:    edge.h                                          *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+/**
+ * The gpio_inputs_change_callback_t receives only the PORTA/PORTB snapshots.
+ * The edge recorder runs in the CN ISR and only stores (port, changed pins, new levels,
+ * timestamp) events into a lock-free single-producer/single-consumer ring. The main loop
+ * drains the ring and decodes the rising and falling edges of each pin, with the time
+ * since the previous edge of the same pin (pulse width).
+ *
+ * The timestamp is a free-running 32-bit counter (Timer4/Timer5 in 32-bit mode) clocked
+ * at FCY, 62.5 ns resolution, it wraps after 268 seconds. The differences of two timestamps
+ * are valid across the wrap.
+ *
+ * Note:
+ * - The CN ISR latency (a few us) is included in the timestamps, pulses shorter than the
+ *   ISR time are not seen. The widths are accurate to about 1 us.
+ */
+
+#ifndef __EDGE_H__
+#define __EDGE_H__
+
+    #include <gpio.h>
+    #include <cndisp.h>
+
+    /**
+     * Number of events of the ring, it must be a power of two.
+    */
+    #define EDGE_RING_LENGTH            64
+
+    /**
+     * Timestamp ticks per microsecond.
+    */
+    #define EDGE_TICKS_PER_US           (FCY/1000000UL)
+
+
+    typedef struct EDGE_EVENT_STRUCT {
+        uint32_t            timestamp;      /** Timer4/5 counter when the CN ISR was entered    */
+        uint16_t            changed;        /** Pins of the port that changed                   */
+        uint16_t            levels;         /** Port levels after the change                    */
+        gpio_group_t        group;          /** GPIO_GROUP_A or GPIO_GROUP_B                    */
+    }edge_event_t;
+
+
+    typedef enum EDGE_TYPE_TYPE {
+        EDGE_FALLING = 0,
+        EDGE_RISING  = 1
+    }edge_type_t;
+
+
+    typedef struct EDGE_STRUCT {
+        gpio_num_t          gpio_num;       /** Pin of the edge                                 */
+        edge_type_t         type;           /** Rising or falling                               */
+        uint32_t            timestamp;      /** Timestamp of the edge                           */
+        uint32_t            width;          /** Ticks since the previous edge of the pin, i.e.
+                                                the high time at a falling edge and the low time
+                                                at a rising edge, 0 for the first edge          */
+    }edge_t;
+
+
+    typedef void (*edge_callback_t)(edge_t *edge);
+
+
+    /**
+     * Starts the edge recorder.
+     * Parameters:
+     * - ra_mask: PORTA pins to be recorded.
+     * - rb_mask: PORTB pins to be recorded.
+     * Note:
+     * - The pins are set to digital inputs with CN enabled, and edge_cn_handler() is attached to CNDISP_SLOT_EDGE.
+     * - Timer4 and Timer5 are used as the 32-bit timestamp counter.
+    */
+    sys_error_t edge_start(uint16_t ra_mask, uint16_t rb_mask);
+
+
+    /**
+     * Stops recording. The pending events can still be drained.
+    */
+    sys_error_t edge_stop(void);
+
+
+    /**
+     * Returns the current 32-bit timestamp.
+    */
+    uint32_t edge_get_timestamp(void);
+
+
+    /**
+     * Change notification handler of the edge recorder.
+     * Parameter:
+     * - data: Port snapshots passed by the CN ISR.
+     * Note:
+     * - Called in ISR context.
+    */
+    void edge_cn_handler(gpio_inputs_change_data_t *data);
+
+
+    /**
+     * Reads the oldest raw event from the ring.
+     * Parameter:
+     * - event: Output event.
+     * Return:
+     * - true if an event was read, false if the ring is empty.
+    */
+    bool edge_read_event(edge_event_t *event);
+
+
+    /**
+     * Returns the number of events lost because the ring was full, and clears it.
+    */
+    uint16_t edge_get_overflows(void);
+
+
+    /**
+     * Drains the ring and calls the callback for each edge of each pin, oldest first.
+     * Parameters:
+     * - edge_callback: Callback function called with the decoded edge.
+     * - max_events: Maximum number of ring events to be drained, 0 drains all.
+     * Return:
+     * - Number of edges decoded.
+     * Note:
+     * - This function is called by the main loop.
+    */
+    uint16_t edge_drain(edge_callback_t edge_callback, uint16_t max_events);
+
+#endif // __EDGE_H__
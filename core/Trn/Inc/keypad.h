@@ -0,0 +1,168 @@
+/*
+************************************************************
+* KEYPAD Header File                                       *
+* (Resistor-ladder keypads on the analog inputs)           *
+************************************************************
+* File:    keypad.h                                        *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+/**
+ * A resistor-ladder keypad connects N keys to a single analog input, each key
+ * pulls the input to a different voltage. The 10-bit value is decoded to a key
+ * index using a table of threshold bands, so 8-16 keys need only one ADC channel.
+ *
+ *          VDD
+ *           |
+ *          [Rpu]
+ *           |
+ *  ANx -----+----[R0]----+----[R1]----+---- ... ----[Rn-1]---+
+ *           |            |            |                      |
+ *         KEY0         KEY1         KEY2                  KEYn-1
+ *           |            |            |                      |
+ *          GND          GND          GND                    GND
+ *
+ * On the Ternion board, the PSW pins RB<3:0> are AN<5:2> (SWITCH_MODE_ANALOG).
+ */
+
+#ifndef __KEYPAD_H__
+#define __KEYPAD_H__
+
+    #include <analog.h>
+    #include <switch.h>
+
+    /**
+     * Maximum number of keys of a keypad.
+    */
+    #define KEYPAD_KEYS_MAX             16
+
+    /**
+     * Decoded key index when no key is pressed.
+    */
+    #define KEYPAD_KEY_NONE             (-1)
+
+    /**
+     * Default timing in ticks (ms).
+    */
+    #define KEYPAD_DEBOUNCE_TICKS       20
+    #define KEYPAD_HOLD_TICKS           1000
+    #define KEYPAD_REPEAT_TICKS         200
+
+
+    typedef enum KEYPAD_NUM_TYPE {
+        KEYPAD_NUM_0,
+        KEYPAD_NUM_1,
+        KEYPAD_NUM_2,
+        KEYPAD_NUM_3,
+        KEYPAD_NUM_COUNT
+    }keypad_num_t;
+
+
+    typedef void (*keypad_callback_t)(void *);
+
+
+    typedef struct KEYPAD_STRUCT {
+        keypad_num_t        id;
+        analog_num_t        analog_num;     /** Analog input of the ladder                          */
+        const uint16_t      *bands;         /** Upper bound (exclusive) of each key band, ascending */
+        int8_t              key_count;      /** Number of keys (1-KEYPAD_KEYS_MAX)                  */
+        int8_t              key;            /** Debounced key, the released key in the OFF callback */
+        switch_state_t      state;          /** State of the debounced key                          */
+        keypad_callback_t   callback;       /** Called on press, release, hold and repeat           */
+        uint16_t            debounce_ticks; /** Ticks a decoded key must be stable                  */
+        uint16_t            hold_ticks;     /** Ticks from press to the hold event                  */
+        uint16_t            repeat_ticks;   /** Ticks between the repeat events                     */
+        int8_t              candidate;      /** Internally used: last decoded key index             */
+        uint16_t            ticks;          /** Internally used: debounce tick counter              */
+        uint16_t            press_ticks;    /** Internally used: hold/repeat tick counter           */
+    }keypad_t;
+
+
+    /**
+     * Returns the keypad object specified by the keypad_num.
+     * Parameter:
+     * - keypad_num: Id of the keypad, KEYPAD_NUM_<3:0>.
+    */
+    keypad_t * keypad_get_object(keypad_num_t keypad_num);
+
+
+    /**
+     * Computes the threshold bands from the nominal ADC values of the keys.
+     * Each band ends at the midpoint between two adjacent nominal values, the last band
+     * ends at the midpoint between the last key and the idle (released) value.
+     * Parameters:
+     * - levels: Nominal 10-bit value of each key, ascending.
+     * - key_count: Number of keys (1-KEYPAD_KEYS_MAX).
+     * - idle_level: 10-bit value when no key is pressed, 1023 for a pull-up ladder.
+     * - bands: Output table, key_count entries.
+     * Note:
+     * - The bands can also be precomputed and stored as a const table.
+    */
+    sys_error_t keypad_compute_bands(const uint16_t *levels, int8_t key_count, uint16_t idle_level, uint16_t *bands);
+
+
+    /**
+     * Decodes a 10-bit value to a key index (binary search, 4 compares for 16 keys).
+     * Parameters:
+     * - bands: Threshold bands, key_count entries, ascending.
+     * - key_count: Number of keys.
+     * - value: 10-bit ADC value.
+     * Return:
+     * - Key index, or KEYPAD_KEY_NONE if the value is above the last band.
+    */
+    int8_t keypad_decode(const uint16_t *bands, int8_t key_count, int16_t value);
+
+
+    /**
+     * Creates a keypad detector on the given analog input.
+     * Parameters:
+     * - keypad_num: Id of the keypad, KEYPAD_NUM_<3:0>.
+     * - analog_num: Analog input of the ladder.
+     * - bands: Threshold bands, key_count entries. The table is not copied.
+     * - key_count: Number of keys (1-KEYPAD_KEYS_MAX).
+     * - keypad_callback: Callback function, the keypad object is passed as its parameter.
+     * Note:
+     * - The analog input must be initialized using the analog_init function. The keypad reads
+     *   the values sampled by analog_exec_read(), no extra conversion is started.
+    */
+    sys_error_t keypad_create(keypad_num_t keypad_num, analog_num_t analog_num, const uint16_t *bands, int8_t key_count, keypad_callback_t keypad_callback);
+
+
+    /**
+     * Sets the debounce, hold and repeat timing of the keypad.
+     * Parameters:
+     * - keypad_num: Id of the keypad.
+     * - debounce_ticks: Ticks a decoded key must be stable (1-65535).
+     * - hold_ticks: Ticks from press to the hold event, 0 disables hold and repeat.
+     * - repeat_ticks: Ticks between the repeat events, 0 disables repeat.
+    */
+    sys_error_t keypad_set_timing(keypad_num_t keypad_num, uint16_t debounce_ticks, uint16_t hold_ticks, uint16_t repeat_ticks);
+
+
+    /**
+     * Deletes the keypad detector.
+     * Parameter:
+     * - keypad_num: Id of the keypad.
+    */
+    sys_error_t keypad_delete(keypad_num_t keypad_num);
+
+
+    /**
+     * Returns the debounced key index, or KEYPAD_KEY_NONE.
+     * Parameter:
+     * - keypad_num: Id of the keypad.
+    */
+    int8_t keypad_get_key(keypad_num_t keypad_num);
+
+
+    /**
+     * Executes the keypad decoding and debouncing.
+     * This function must be called by the main loop every 1 ms, after analog_exec_read().
+    */
+    void keypad_exec(void);
+
+#endif // __KEYPAD_H__
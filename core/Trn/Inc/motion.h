@@ -0,0 +1,220 @@
+/*
+************************************************************
+* MOTION Header File                                       *
+* (RC servo pulses and stepper step trains)                *
+************************************************************
+* File:    motion.h                                        *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+/**
+ * Servos: up to MOTION_SERVO_MAX RC servo pulses share one OC module of the ocgen. The
+ * 20 ms frame is split into 2.5 ms slots, one per servo. The OC generates the pulse of a slot
+ * in the single-pulse mode and its interrupt (falling edge) remaps the OC output to the pin
+ * of the next slot, so both edges of every pulse are exact to one timer tick (0.5 us at FCY/8)
+ * whatever the interrupt latency.
+ *
+ * |<-slot 0->|<-slot 1->|<-slot 2->| ... |<-slot 7->| next frame (20 ms)
+ * |--+       |---+      |-+        |     |          |
+ *  S0         S1          S2                          (a width of 0 gives no pulse)
+ *
+ *   static const gpio_num_t servos[3] = { GPIO_RB_8, GPIO_RB_9, GPIO_RB_14 };
+ *   ocgen_init(OCGEN_TIMER_3, 0x18);       // OC4, OC5 for the motion module
+ *   motion_servo_init(servos, 3);
+ *   motion_servo_set_us(0, 1500);
+ *
+ * Steppers: each stepper driver (step/dir inputs) takes one OC module, the step pin is the
+ * OC output. A move is a trapezoidal speed profile: constant acceleration from the start
+ * speed to the maximum rate, cruise, and deceleration with the same number of steps.
+ * The step period p (timer ticks) is updated at each step without division (A. Eiderman,
+ * stepper ramping by addition and multiplication):
+ *
+ *   accelerate: p = p * (1 - m * p^2),   decelerate: p = p * (1 + m * p^2),   m = a / F^2
+ *
+ * with F the timer clock. The division-free update takes two 32x32->64-bit multiplications in the
+ * OC interrupt. The steps are timed from the previous step, not from the interrupt entry.
+ *
+ *   motion_stepper_create(MOTION_STEPPER_0, GPIO_RB_10, GPIO_RB_11);
+ *   motion_stepper_move(MOTION_STEPPER_0, 3200, 8000, 20000, NULL);   // 8 k steps/s, 20 k steps/s^2
+ *
+ * The servo and stepper pins must be remappable (GPIO_RB_<15:0>), the dir pin can be any GPIO.
+ * The servo interrupt remaps with pmap_map_peripheral_to_pin(), which locks the pin mapping
+ * (IOLOCK) when it returns. Any other remap must run with the interrupts masked
+ * (PERFORM_CRITICAL_SECTION), or its write can be lost between the unlock and the RPORx/RPINRx
+ * write. ocgen, pwm_create() and icap_map_input() do so.
+ * The completion callbacks are called by motion_exec() from the main loop.
+ */
+
+#ifndef __MOTION_H__
+#define __MOTION_H__
+
+	#include <ocgen.h>
+
+	/**
+	 * Maximum number of servos.
+	*/
+	#define MOTION_SERVO_MAX			8
+
+	/**
+	 * Servo frame and slot, the slot of the servo n starts n x MOTION_SERVO_SLOT_US after the frame.
+	*/
+	#define MOTION_SERVO_FRAME_US		20000
+	#define MOTION_SERVO_SLOT_US		(MOTION_SERVO_FRAME_US / MOTION_SERVO_MAX)
+
+	/**
+	 * Servo pulse limits, the gap to the next slot is left for the remapping.
+	*/
+	#define MOTION_SERVO_MIN_US			400
+	#define MOTION_SERVO_MAX_US			(MOTION_SERVO_SLOT_US - 50)
+
+	/**
+	 * Width of the step pulses, 2 us meets the common driver ICs (A4988, DRV8825, TMC2208).
+	*/
+	#define MOTION_STEP_PULSE_US		2
+
+	/**
+	 * Steps of the window of the measured step rate (motion_stepper_get_peak_rate).
+	*/
+	#define MOTION_STEPPER_RATE_WINDOW	64
+
+
+	typedef enum MOTION_STEPPER_NUM_TYPE {
+		MOTION_STEPPER_0,
+		MOTION_STEPPER_1,
+		MOTION_STEPPER_COUNT
+	}motion_stepper_num_t;
+
+
+	typedef enum MOTION_STATE_TYPE {
+		MOTION_STATE_IDLE,
+		MOTION_STATE_ACCEL,
+		MOTION_STATE_CRUISE,
+		MOTION_STATE_DECEL
+	}motion_state_t;
+
+
+	typedef struct MOTION_STEPPER_STRUCT {
+		motion_stepper_num_t id;
+		gpio_num_t 		step_pin;		/** Step output (OC output)					*/
+		gpio_num_t 		dir_pin;		/** Direction output, high: positive		*/
+		int8_t 			oc;				/** OC module (0: OC1), -1: not created		*/
+		volatile motion_state_t state;	/** Phase of the move						*/
+		callback_t 		callback;		/** Called with this object at the end		*/
+		volatile int32_t position;		/** Steps, written by the OC ISR			*/
+		volatile uint32_t remaining;	/** Steps to the end of the move			*/
+		uint32_t 		window_min;		/** Shortest window of steps of the move (ticks)	*/
+		volatile uint16_t slips;		/** Steps taken late (ISR latency)			*/
+		int8_t 			direction;		/** Internally used: +1 or -1				*/
+		uint32_t 		accel_steps;	/** Internally used: steps of the acceleration	*/
+		uint32_t 		period;			/** Internally used: step period, Q16.16 ticks	*/
+		uint32_t 		period_min;		/** Internally used: period at the max rate	*/
+		uint32_t 		period_start;	/** Internally used: period of the first step	*/
+		uint32_t 		m;				/** Internally used: a / F^2 in Q0.48		*/
+		uint16_t 		rise;			/** Internally used: compare of the step	*/
+		uint16_t 		frac;			/** Internally used: fraction of the rise	*/
+		uint32_t 		window_ticks;	/** Internally used: ticks of the current window	*/
+		uint8_t 		window_steps;	/** Internally used: steps of the current window	*/
+		volatile bool 	done;			/** Internally used: completion flag		*/
+	}motion_stepper_t;
+
+
+	/**
+	 * Starts the servo frames on a free OC module of the ocgen (ocgen_init).
+	 * All servos start with a width of 0 (no pulse).
+	 * Parameters:
+	 * - pins: Servo pins, GPIO_RB_<15:0>, slot n is pins[n].
+	 * - count: Number of servos, 1-MOTION_SERVO_MAX.
+	*/
+	sys_error_t motion_servo_init(const gpio_num_t *pins, uint8_t count);
+
+
+	/**
+	 * Stops the servo frames and releases the OC module, the pins are left low.
+	*/
+	void motion_servo_stop(void);
+
+
+	/**
+	 * Sets the pulse width of the servo, taken from the next slot of the servo.
+	 * Parameters:
+	 * - index: Index of the servo in the `pins` of motion_servo_init().
+	 * - us: Pulse width in microseconds, MOTION_SERVO_MIN_US to MOTION_SERVO_MAX_US, 0: no pulse.
+	*/
+	sys_error_t motion_servo_set_us(uint8_t index, uint16_t us);
+
+
+	/**
+	 * Returns the pulse width of the servo in microseconds.
+	*/
+	uint16_t motion_servo_get_us(uint8_t index);
+
+
+	/**
+	 * Returns the slots that were started late.
+	*/
+	uint16_t motion_servo_get_slips(void);
+
+
+	/**
+	 * Returns the stepper object.
+	*/
+	motion_stepper_t * motion_stepper_get_object(motion_stepper_num_t stepper_num);
+
+
+	/**
+	 * Claims an OC module for the stepper and sets the pins to low digital outputs.
+	 * Parameters:
+	 * - stepper_num: Id of the stepper.
+	 * - step_pin: Step input of the driver, GPIO_RB_<15:0>.
+	 * - dir_pin: Direction input of the driver.
+	*/
+	sys_error_t motion_stepper_create(motion_stepper_num_t stepper_num, gpio_num_t step_pin, gpio_num_t dir_pin);
+
+
+	/**
+	 * Starts a relative move, the stepper must be idle.
+	 * Parameters:
+	 * - stepper_num: Id of the stepper.
+	 * - steps: Steps to move, negative: dir pin low.
+	 * - max_rate: Cruise speed in steps/s.
+	 * - accel: Acceleration and deceleration in steps/s^2.
+	 * - callback: Called with the stepper object at the end of the move, can be NULL.
+	 * Note:
+	 * - The first step period is limited to 0x7FFF ticks (61 steps/s at FCY/8).
+	*/
+	sys_error_t motion_stepper_move(motion_stepper_num_t stepper_num, int32_t steps, uint16_t max_rate, uint32_t accel, callback_t callback);
+
+
+	/**
+	 * Decelerates to the end of the move with the acceleration of the move.
+	*/
+	sys_error_t motion_stepper_stop(motion_stepper_num_t stepper_num);
+
+
+	/**
+	 * Stops the step pulses immediately. The callback is not called.
+	*/
+	sys_error_t motion_stepper_abort(motion_stepper_num_t stepper_num);
+
+
+	/**
+	 * Returns the highest step rate (steps/s) measured on the step pin in the last move: the steps
+	 * of the shortest window of MOTION_STEPPER_RATE_WINDOW steps over its length.
+	 * Note:
+	 * - The intervals are taken from the compares of the step pulses as programmed, after the late
+	 *   steps were moved. Returns 0 before a move of MOTION_STEPPER_RATE_WINDOW steps.
+	*/
+	uint32_t motion_stepper_get_peak_rate(motion_stepper_num_t stepper_num);
+
+
+	/**
+	 * Calls the completion callbacks.
+	 * This function must be called by the main loop.
+	*/
+	void motion_exec(void);
+
+#endif //__MOTION_H__
@@ -0,0 +1,232 @@
+/*
+************************************************************
+* OCGEN Header File                                        *
+* (Output-compare backend of the pdsgen)                   *
+************************************************************
+* File:    ocgen.h                                         *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+/**
+ * The pdsgen counts the head, active and total times in 1 ms system ticks.
+ * The ocgen generates the same oneshot, repeat and continuous waveforms with the
+ * output compare modules (OC1-OC5) in the single-pulse mode (OCM = 100):
+ * the OCx pin is driven high at OCxR and low at OCxRS by the hardware.
+ *
+ * |<--head (low)--->|-->active (high)-->|<--tail (low)-->| repeat
+ *                   ^ OCxR              ^ OCxRS, OCx interrupt re-arms the next cycle
+ *
+ * The edges are exact to one timer tick (0.5 us at FCY/8) and take no CPU time.
+ * Repeat and continuous waveforms take one short OC interrupt per cycle to program
+ * the next pulse, so the tail time should be longer than about 10 us.
+ *
+ * The OC timebase is a free-running Timer2 or Timer3 (PRx = 0xFFFF). The times are limited
+ * to OCGEN_TIME_MAX_TICKS, 16383 us at FCY/8 (ocgen_get_time_max_us()). If no OC module
+ * is free, the pin is not remappable (RB<15:0>) or a time is too long, the waveform falls
+ * back to the pdsgen tick engine with the times rounded to milliseconds. The output is
+ * active-high on both engines.
+ *
+ *   ocgen_init(OCGEN_TIMER_3, 0x18);                       // OC4, OC5 for the ocgen
+ *   ocgen_create_oneshot(PDSGEN_NUM_0, GPIO_RB_8, 100, 15); // 15 us pulse after 100 us
+ */
+
+#ifndef __OCGEN_H__
+#define __OCGEN_H__
+
+	#include <pdsgen.h>
+	#include <pwm.h>
+
+	/**
+	 * Number of the output compare modules.
+	*/
+	#define OCGEN_OC_COUNT			5
+
+	/**
+	 * Maximum head, active and total time of the OC backend in timer ticks, and in microseconds
+	 * at FCY/8. A timebase started at another clock has its own limit, see ocgen_get_time_max_us().
+	*/
+	#define OCGEN_TIME_MAX_TICKS	0x7FFF
+	#define OCGEN_TIME_MAX_US		16383
+
+	/**
+	 * Pin of an OC module used only for its compare interrupt (no output pin).
+	*/
+	#define OCGEN_GPIO_NONE			((gpio_num_t)0xFF)
+
+
+	typedef enum OCGEN_TIMER_TYPE {
+		OCGEN_TIMER_2,		/** Timer2, not available if PWM_GROUP_A is used */
+		OCGEN_TIMER_3		/** Timer3, not available if PWM_GROUP_B is used */
+	}ocgen_timer_t;
+
+
+	typedef struct OCGEN_STRUCT {
+		pdsgen_num_t 	id;				/** Id of the shared pdsgen object			*/
+		pdsgen_mode_t	mode;			/** Mode of the waveform					*/
+		volatile pdsgen_state_t state;	/** State of the waveform					*/
+		gpio_num_t		gpio_num;		/** Target GPIO								*/
+		int8_t			oc;				/** OC module (0: OC1), -1: tick engine		*/
+		uint16_t		head_ticks;		/** head (low) in timer ticks				*/
+		uint16_t		active_ticks;	/** body (high) in timer ticks				*/
+		uint16_t		total_ticks;	/** period in timer ticks					*/
+		uint16_t		cycles;			/** Used in REPEAT							*/
+		uint16_t		slips;			/** Cycles started late (ISR latency)		*/
+		uint16_t		rise;			/** Internally used: compare of the rise	*/
+		uint16_t		repeat;			/** Internally used: remaining cycles		*/
+	}ocgen_t;
+
+
+	/**
+	 * Selects the timebase and the OC modules used by the ocgen.
+	 * Parameters:
+	 * - ocgen_timer: OCGEN_TIMER_2 or OCGEN_TIMER_3. If the timer is not running, it is started
+	 *   free-running at FCY/8, a running timer must be free-running (e.g. started by icap).
+	 * - oc_mask: OC modules that can be used, bit n is OC(n+1). Do not include the OCs of the PWM channels.
+	*/
+	sys_error_t ocgen_init(ocgen_timer_t ocgen_timer, uint16_t oc_mask);
+
+
+	/**
+	 * Returns the ocgen object specified by the `pdsgen_num`.
+	*/
+	ocgen_t * ocgen_get_object(pdsgen_num_t pdsgen_num);
+
+
+	/**
+	 * Creates oneshot waveform, see pdsgen_create_oneshot().
+	 * Parameters:
+	 * - pdsgen_num: Id of the pdsgen object.
+	 * - gpio_num: Target GPIO, GPIO_RB_<15:0> for the OC backend.
+	 * - head_us: Head (low) time in microseconds.
+	 * - active_us: Active (high) time in microseconds.
+	*/
+	sys_error_t ocgen_create_oneshot(pdsgen_num_t pdsgen_num, gpio_num_t gpio_num, uint32_t head_us, uint32_t active_us);
+
+
+	/**
+	 * Creates repeat waveform, see pdsgen_create_repeat().
+	 * Parameters:
+	 * - pdsgen_num: Id of the pdsgen object.
+	 * - gpio_num: Target GPIO, GPIO_RB_<15:0> for the OC backend.
+	 * - head_us: Head (low) time in microseconds.
+	 * - active_us: Active (high) time in microseconds.
+	 * - total_us: Period in microseconds.
+	 * - cycles: Number of cycles.
+	*/
+	sys_error_t ocgen_create_repeat(pdsgen_num_t pdsgen_num, gpio_num_t gpio_num, uint32_t head_us, uint32_t active_us, uint32_t total_us, uint16_t cycles);
+
+
+	/**
+	 * Creates continuous waveform, see pdsgen_create_continuous().
+	 * Parameters:
+	 * - pdsgen_num: Id of the pdsgen object.
+	 * - gpio_num: Target GPIO, GPIO_RB_<15:0> for the OC backend.
+	 * - head_us: Head (low) time in microseconds.
+	 * - active_us: Active (high) time in microseconds.
+	 * - total_us: Period in microseconds.
+	*/
+	sys_error_t ocgen_create_continuous(pdsgen_num_t pdsgen_num, gpio_num_t gpio_num, uint32_t head_us, uint32_t active_us, uint32_t total_us);
+
+
+	/**
+	 * Stops the waveform and releases its OC module. The GPIO is left low.
+	 * Parameter:
+	 * - pdsgen_num: Id of the pdsgen object.
+	*/
+	sys_error_t ocgen_terminate(pdsgen_num_t pdsgen_num);
+
+
+	/**
+	 * OC module access for other generators (e.g. pdsseq).
+	 * The handler is called from the OCx ISR with the claimed OC module and the context.
+	*/
+	typedef void (*ocgen_handler_t)(int8_t oc, void *context);
+
+
+	/**
+	 * Claims a free OC module and maps its output to the pin. The pin is set to a low digital output.
+	 * Parameters:
+	 * - gpio_num: Target GPIO, GPIO_RB_<15:0>, or OCGEN_GPIO_NONE to use only the compare interrupt.
+	 * - handler: Called from the OCx ISR.
+	 * - context: Passed to the handler.
+	 * Return:
+	 * - OC module (0: OC1), or -1 if no OC module is free or ocgen_init() was not called.
+	*/
+	int8_t ocgen_oc_claim(gpio_num_t gpio_num, ocgen_handler_t handler, void *context);
+
+
+	/**
+	 * Stops the OC module, unmaps the pin and releases the module.
+	*/
+	void ocgen_oc_release(int8_t oc, gpio_num_t gpio_num);
+
+
+	/**
+	 * Returns OCxRS of the OC module, OCxR and OCxCON are the next registers.
+	*/
+	volatile uint16_t *ocgen_oc_regs(int8_t oc);
+
+
+	/**
+	 * Compare modes (OCM<2:0>) of ocgen_oc_enable().
+	 * - OCGEN_OCM_TOGGLE: OCx toggles at each OCxR match, the interrupt is taken at the match.
+	 * - OCGEN_OCM_SINGLE_PULSE: OCx rises at OCxR and falls at OCxRS, the interrupt is taken
+	 *   at the falling edge.
+	*/
+	#define OCGEN_OCM_TOGGLE		0x0003
+	#define OCGEN_OCM_SINGLE_PULSE	0x0004
+
+
+	/**
+	 * Sets the compare mode (OCM<2:0>) and the timebase of the OC module, and enables its interrupt.
+	*/
+	void ocgen_oc_enable(int8_t oc, uint16_t ocm);
+
+
+	/**
+	 * Programs a single pulse of the OC module (OCGEN_OCM_SINGLE_PULSE) and enables its interrupt.
+	 * Parameters:
+	 * - oc: Claimed OC module.
+	 * - rise: Timer value of the rising edge, at least ocgen_get_lead_ticks() from now.
+	 * - width: Pulse width in timer ticks.
+	*/
+	void ocgen_oc_arm(int8_t oc, uint16_t rise, uint16_t width);
+
+
+	/**
+	 * Returns the timer value of the ocgen timebase.
+	*/
+	uint16_t ocgen_get_time(void);
+
+
+	/**
+	 * Returns the clock of the ocgen timebase in kHz.
+	*/
+	uint16_t ocgen_get_clock_khz(void);
+
+
+	/**
+	 * Returns the minimum ticks from programming a compare to its match.
+	*/
+	uint16_t ocgen_get_lead_ticks(void);
+
+
+	/**
+	 * Returns the maximum time of the OC backend in microseconds, OCGEN_TIME_MAX_TICKS
+	 * at the clock of the timebase (16383 us at FCY/8, 2047 us at FCY).
+	*/
+	uint16_t ocgen_get_time_max_us(void);
+
+
+	/**
+	 * Returns the state of the waveform of either backend.
+	 * Parameter:
+	 * - pdsgen_num: Id of the pdsgen object.
+	*/
+	pdsgen_state_t ocgen_get_state(pdsgen_num_t pdsgen_num);
+
+#endif //__OCGEN_H__
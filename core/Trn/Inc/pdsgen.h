@@ -53,6 +53,10 @@
 	}pdsgen_state_t;
 
 
+	/** Returned by pdsgen_get_next_deadline() when no transition is scheduled */
+	#define PDSGEN_DEADLINE_NONE	0xFFFFFFFFUL
+
+
 	typedef struct PDSGEN_STRUCT{
 		pdsgen_num_t 	id;				/** Id of the pdsgen object 	*/
 		pdsgen_mode_t   mode;			/** Mode of the pdsgen object 	*/
@@ -219,10 +223,22 @@
 	
 	/**
 	 * Executes pdsgen's operation and control GPIO's level connected to the pdsgen object.
+	 * The levels of all pdsgen objects are collected into set/clear masks and written with
+	 * one LAT write per port, so all GPIOs change at the same time.
+	 * Only the objects with a due transition (end of head, active or tail) are processed.
 	 * This function must be called by the main loop every 1 ms.
 	*/
 	void pdsgen_exec(void);
 
 
+	/**
+	 * Returns the number of ticks until the next transition of any pdsgen object,
+	 * 1 means the next pdsgen_exec() call changes a GPIO. Returns PDSGEN_DEADLINE_NONE if nothing is scheduled.
+	 * Note:
+	 * - The pdsgen_exec() must still be called every tick, the earlier calls only advance the time.
+	*/
+	uint32_t pdsgen_get_next_deadline(void);
+
+
 
 #endif //__PDSGEN_H__
@@ -0,0 +1,131 @@
+/*
+************************************************************
+* PDSSEQ Header File                                       *
+* (Table-driven waveform sequencer of the pdsgen)          *
+************************************************************
+* File:    pdsseq.h                                        *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+/**
+ * A pdsgen object expresses only head/active/tail patterns. The sequencer plays an
+ * arbitrary list of (level, duration) segments from a const table. The tables and the
+ * sequence descriptors are const, so they stay in flash and are read through the PSV
+ * window while playing, nothing is copied to RAM.
+ *
+ *   static const pdsseq_segment_t nec_header[] = {
+ *       PDSSEQ_SEGMENT(1, 9000), PDSSEQ_SEGMENT(0, 4500)
+ *   };
+ *   static const pdsseq_segment_t nec_bits[] = { ... };
+ *   static const pdsseq_sequence_t nec_frame_bits = { nec_bits, 66, 1, NULL };
+ *   static const pdsseq_sequence_t nec_frame = { nec_header, 2, 1, &nec_frame_bits };
+ *
+ *   pdsseq_play(PDSGEN_NUM_0, GPIO_RB_8, &nec_frame, PDSSEQ_UNIT_US, on_done);
+ *
+ * A sequence is played `loops` times (0: forever) and then its `next` sequence is played
+ * (chaining). The completion callback is called by pdsseq_exec() when the last segment ends.
+ * The GPIO is low when the sequence is completed.
+ *
+ * Two engines are available:
+ * - PDSSEQ_UNIT_MS: the durations are in 1 ms ticks, played by pdsseq_exec().
+ * - PDSSEQ_UNIT_US: the durations are in microseconds, played by an OC module of the ocgen
+ *   (ocgen_init) in the toggle mode. The edges are exact to one timer tick and one short OC
+ *   interrupt is taken per edge. Segments with the same level are merged, a merged run must be
+ *   shorter than 65536 timer ticks (32 ms at FCY/8).
+ *   The OC pin is RB<15:0>, a sequence cannot start with PDSSEQ_UNIT_US if no OC module is free.
+ */
+
+#ifndef __PDSSEQ_H__
+#define __PDSSEQ_H__
+
+	#include <ocgen.h>
+
+	/**
+	 * Segment: bit 15 is the level, bits <14:0> are the duration (0-32767 units).
+	*/
+	typedef uint16_t pdsseq_segment_t;
+
+	#define PDSSEQ_SEGMENT(level, duration)		((pdsseq_segment_t)(((level) ? 0x8000 : 0) | ((duration) & 0x7FFF)))
+	#define PDSSEQ_SEGMENT_LEVEL(segment)		(((segment) >> 15) & 1)
+	#define PDSSEQ_SEGMENT_DURATION(segment)	((segment) & 0x7FFF)
+
+
+	typedef struct PDSSEQ_SEQUENCE_STRUCT {
+		const pdsseq_segment_t 	*segments;	/** Segment table (const, in flash)			*/
+		uint16_t 				count;		/** Number of segments						*/
+		uint16_t 				loops;		/** Number of plays, 0: forever				*/
+		const struct PDSSEQ_SEQUENCE_STRUCT *next;	/** Played after this one, NULL ends	*/
+	}pdsseq_sequence_t;
+
+
+	typedef enum PDSSEQ_UNIT_TYPE {
+		PDSSEQ_UNIT_MS,		/** Tick engine, 1 ms			*/
+		PDSSEQ_UNIT_US		/** OC engine, 1 us				*/
+	}pdsseq_unit_t;
+
+
+	typedef void (*pdsseq_callback_t)(void *);
+
+
+	typedef struct PDSSEQ_STRUCT {
+		pdsgen_num_t 	id;				/** Id of the shared pdsgen object			*/
+		gpio_num_t 		gpio_num;		/** Target GPIO								*/
+		pdsseq_unit_t 	unit;			/** Unit of the durations					*/
+		volatile pdsgen_state_t state;	/** State of the sequence					*/
+		pdsseq_callback_t callback;		/** Called with this object when completed	*/
+		uint16_t 		slips;			/** Edges programmed late (OC engine)		*/
+		uint16_t 		overruns;		/** Runs clamped to the timer range			*/
+		const pdsseq_sequence_t *sequence;	/** Internally used: current sequence		*/
+		uint16_t 		index;			/** Internally used: next segment			*/
+		uint16_t 		loop;			/** Internally used: completed plays		*/
+		pdsseq_segment_t pending;		/** Internally used: fetched segment		*/
+		bool 			has_pending;	/** Internally used							*/
+		uint8_t 		level;			/** Internally used: current level			*/
+		uint16_t 		remain;			/** Internally used: ticks of the segment	*/
+		int8_t 			oc;				/** Internally used: OC module, -1: none	*/
+		uint16_t 		edge;			/** Internally used: time of the last edge	*/
+		volatile bool 	done;			/** Internally used: completion flag		*/
+		bool 			ending;			/** Internally used: last falling edge		*/
+		volatile bool 	tail;			/** Internally used: trailing low run		*/
+		uint16_t 		tail_ticks;		/** Internally used							*/
+		uint16_t 		tail_elapsed;	/** Internally used							*/
+	}pdsseq_t;
+
+
+	/**
+	 * Returns the sequencer object specified by the `pdsgen_num`.
+	*/
+	pdsseq_t * pdsseq_get_object(pdsgen_num_t pdsgen_num);
+
+
+	/**
+	 * Plays a sequence on the GPIO. The pdsgen/ocgen waveform of the same object is terminated.
+	 * Parameters:
+	 * - pdsgen_num: Id of the pdsgen object, PDSGEN_NUM_<7:0>.
+	 * - gpio_num: Target GPIO, GPIO_RB_<15:0> for PDSSEQ_UNIT_US.
+	 * - sequence: First sequence (const, in flash).
+	 * - unit: PDSSEQ_UNIT_MS or PDSSEQ_UNIT_US.
+	 * - callback: Called with the pdsseq object when the sequence is completed, can be NULL.
+	*/
+	sys_error_t pdsseq_play(pdsgen_num_t pdsgen_num, gpio_num_t gpio_num, const pdsseq_sequence_t *sequence, pdsseq_unit_t unit, pdsseq_callback_t callback);
+
+
+	/**
+	 * Stops the sequence, the GPIO is set low. The callback is not called.
+	 * Parameter:
+	 * - pdsgen_num: Id of the pdsgen object.
+	*/
+	sys_error_t pdsseq_stop(pdsgen_num_t pdsgen_num);
+
+
+	/**
+	 * Executes the tick engine and the completion callbacks.
+	 * This function must be called by the main loop every 1 ms.
+	*/
+	void pdsseq_exec(void);
+
+#endif //__PDSSEQ_H__
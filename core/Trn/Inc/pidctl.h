@@ -0,0 +1,176 @@
+/*
+************************************************************
+* PIDCTL Header File                                       *
+* (Fixed-rate fixed-point PID control loops)               *
+************************************************************
+* File:    pidctl.h                                        *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+/**
+ * The control loops run in the period ISR of a PWM group timer (pwmfx_period_attach), every
+ * `divider` periods, so the sampling interval is fixed by the hardware timer and does not
+ * depend on the main loop. Each loop reads an analog input from the ADC sample buffer
+ * (analog_read_raw), computes a PID in integer math and writes the duty of a PWM channel
+ * (pwmfx_set_duty_q15).
+ *
+ * Signals are Q15: the 10-bit ADC value is shifted by 5 (1023 -> 32736), the duty is 0 to
+ * PWMFX_Q15_ONE. The gains are Q8.8 (-128.0 to 127.99) and are per sample:
+ *
+ *   kp = Kp,  ki = Ki * T,  kd = Kd / T       (T: sampling interval in seconds)
+ *
+ *   e[n] = setpoint - y[n]                    (limited to the int16_t range)
+ *   i[n] = i[n-1] + ki * e[n]                 (Q15.8, not updated when the output saturates)
+ *   u[n] = kp * e[n] + i[n] - kd * (y[n] - y[n-1])   (sums saturated to the int32_t range)
+ *
+ * The derivative is taken from the measurement, a setpoint step does not kick the output.
+ * The integral is limited to the output range and is held while the output is clamped in the
+ * direction of the error (anti-windup). A negative kp, ki and kd reverse the action (cooling).
+ *
+ *   pidctl_create(PIDCTL_NUM_0, ANALOG_NUM_0, PWM_NUM_0, PIDCTL_GAIN(2.0), PIDCTL_GAIN(0.05), 0);
+ *   pidctl_set_setpoint(PIDCTL_NUM_0, PIDCTL_ADC_TO_Q15(512));
+ *   pidctl_enable(PIDCTL_NUM_0, true);
+ *   pidctl_init(PWM_GROUP_A, 10);                  // 10 kHz PWM, 1 kHz control rate
+ *
+ * The loop time of the ISR is measured with the group timer, see pidctl_get_stats().
+ */
+
+#ifndef __PIDCTL_H__
+#define __PIDCTL_H__
+
+	#include <analog.h>
+	#include <pwmfx.h>
+
+	typedef enum PIDCTL_NUM_TYPE {
+		PIDCTL_NUM_0,
+		PIDCTL_NUM_1,
+		PIDCTL_NUM_2,
+		PIDCTL_NUM_3,
+		PIDCTL_NUM_COUNT
+	}pidctl_num_t;
+
+
+	/**
+	 * Converts a constant gain to Q8.8 at compile time.
+	*/
+	#define PIDCTL_GAIN(gain)	((int16_t)((gain) * 256.0 + (((gain) < 0) ? -0.5 : 0.5)))
+
+	/**
+	 * Converts a 10-bit ADC value to Q15.
+	*/
+	#define PIDCTL_ADC_TO_Q15(raw)	((int16_t)((raw) << 5))
+
+
+	typedef struct PIDCTL_STRUCT {
+		pidctl_num_t 		id;
+		volatile bool 	enabled;		/** The loop is computed and the duty is written	*/
+		analog_num_t 	input;			/** Measured analog input							*/
+		pwm_num_t 		output;			/** Controlled PWM channel							*/
+		volatile int16_t setpoint;		/** Setpoint in Q15									*/
+		int16_t 		kp;				/** Proportional gain in Q8.8						*/
+		int16_t 		ki;				/** Integral gain per sample in Q8.8				*/
+		int16_t 		kd;				/** Derivative gain per sample in Q8.8				*/
+		pwmfx_q15_t 	out_min;		/** Lower limit of the duty in Q15					*/
+		pwmfx_q15_t 	out_max;		/** Upper limit of the duty in Q15					*/
+		volatile int16_t measurement;	/** Last measurement in Q15, written by the ISR		*/
+		volatile pwmfx_q15_t duty;		/** Last duty in Q15, written by the ISR			*/
+		volatile bool 	saturated;		/** The last output was clamped						*/
+		int32_t 		integral;		/** Internally used: integral in Q15.8				*/
+		int16_t 		last_measurement;	/** Internally used: y[n-1]						*/
+	}pidctl_t;
+
+
+	/**
+	 * Loop-time statistics, in ticks of the group timer (with its prescaler).
+	 * Members:
+	 * - runs: Executions of the control ISR.
+	 * - latency_max: Maximum timer value at the start of the loops (interrupt latency).
+	 * - exec_last, exec_max: Execution time of all loops of the last and the longest run.
+	 * - overruns: Runs that did not end in the period they started.
+	*/
+	typedef struct PIDCTL_STATS_STRUCT {
+		uint32_t 		runs;
+		uint16_t 		latency_max;
+		uint16_t 		exec_last;
+		uint16_t 		exec_max;
+		uint16_t 		overruns;
+	}pidctl_stats_t;
+
+
+	/**
+	 * Returns the pidctl object.
+	 * Parameter:
+	 * - pidctl_num: Id of the loop, PIDCTL_NUM_<3:0>.
+	*/
+	pidctl_t * pidctl_get_object(pidctl_num_t pidctl_num);
+
+
+	/**
+	 * Creates a control loop, the loop is disabled until pidctl_enable() is called.
+	 * The duty is limited to 0 to PWMFX_Q15_ONE.
+	 * Parameters:
+	 * - pidctl_num: Id of the loop.
+	 * - input: Analog input, initialized by analog_init().
+	 * - output: PWM channel, created and started by pwm_create() and pwm_start().
+	 * - kp, ki, kd: Gains in Q8.8, see PIDCTL_GAIN().
+	*/
+	sys_error_t pidctl_create(pidctl_num_t pidctl_num, analog_num_t input, pwm_num_t output, int16_t kp, int16_t ki, int16_t kd);
+
+
+	/**
+	 * Starts the control ISR on the period interrupt of the group.
+	 * Parameters:
+	 * - pwm_group: PWM_GROUP_A (Timer2) or PWM_GROUP_B (Timer3).
+	 * - divider: Number of PWM periods per sample, 1-65535.
+	 * Note:
+	 * - The sampling interval changes with the period of the group (pwmfx_set_period).
+	*/
+	sys_error_t pidctl_init(pwm_group_t pwm_group, uint16_t divider);
+
+
+	/**
+	 * Stops the control ISR, the duties are left at their current values.
+	*/
+	sys_error_t pidctl_stop(void);
+
+
+	/**
+	 * Enables or disables the loop. The integral starts from the current duty (bumpless).
+	*/
+	sys_error_t pidctl_enable(pidctl_num_t pidctl_num, bool enable);
+
+
+	/**
+	 * Sets the setpoint in Q15, see PIDCTL_ADC_TO_Q15().
+	*/
+	sys_error_t pidctl_set_setpoint(pidctl_num_t pidctl_num, int16_t setpoint);
+
+
+	/**
+	 * Sets the gains in Q8.8, the integral is kept.
+	*/
+	sys_error_t pidctl_set_gains(pidctl_num_t pidctl_num, int16_t kp, int16_t ki, int16_t kd);
+
+
+	/**
+	 * Sets the limits of the duty in Q15, 0 <= out_min <= out_max <= PWMFX_Q15_ONE.
+	*/
+	sys_error_t pidctl_set_limits(pidctl_num_t pidctl_num, pwmfx_q15_t out_min, pwmfx_q15_t out_max);
+
+
+	/**
+	 * Copies the loop-time statistics.
+	*/
+	sys_error_t pidctl_get_stats(pidctl_stats_t *stats);
+
+
+	/**
+	 * Clears the loop-time statistics.
+	*/
+	void pidctl_reset_stats(void);
+
+#endif //__PIDCTL_H__
@@ -0,0 +1,148 @@
+/*
+************************************************************
+* PWMPROF Header File                                      *
+* (PWM duty ramps, envelopes and frequency chirps)         *
+************************************************************
+* File:    pwmprof.h                                       *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+/**
+ * The profile engine changes the duty ratio of a PWM channel once per PWM period in the
+ * period ISR of the group timer (pwmfx_period_attach), so soft starts and fades do not
+ * depend on the main loop.
+ *
+ * An envelope is a list of segments. A segment moves the duty from its current value to
+ * the target in the given number of PWM periods:
+ * - PWMPROF_SHAPE_LINEAR: constant step.
+ * - PWMPROF_SHAPE_SCURVE: the step grows linearly to the middle and shrinks to zero at the
+ *   end (constant acceleration then deceleration), there is no step at the start and the end.
+ * A segment with the target equal to the current duty holds the duty.
+ *
+ * The steps of all segments are computed by pwmprof_play() in Q15.15, the ISR only adds them,
+ * the duty snaps to the target at the end of each segment.
+ *
+ *   static const pwmprof_segment_t fade[] = {
+ *       { PWMFX_Q15(1.0), 500, PWMPROF_SHAPE_SCURVE },    // fade in, 500 periods
+ *       { PWMFX_Q15(1.0), 1000, PWMPROF_SHAPE_LINEAR },   // hold
+ *       { 0, 500, PWMPROF_SHAPE_SCURVE }                  // fade out
+ *   };
+ *   static const pwmprof_envelope_t breathe = { fade, 3, 0 };
+ *   pwmprof_play(PWM_NUM_0, &breathe, NULL);
+ *
+ * A chirp sweeps the timer period of a group linearly from one period to another (the
+ * frequency follows 1/period). The duty and shift ratios of the channels of the group are kept.
+ *
+ * The completion callbacks are called by pwmprof_exec() from the main loop.
+ */
+
+#ifndef __PWMPROF_H__
+#define __PWMPROF_H__
+
+	#include <pwmfx.h>
+
+	/**
+	 * Maximum number of segments of an envelope.
+	*/
+	#define PWMPROF_SEGMENT_MAX		8
+
+
+	typedef enum PWMPROF_SHAPE_TYPE {
+		PWMPROF_SHAPE_LINEAR,
+		PWMPROF_SHAPE_SCURVE
+	}pwmprof_shape_t;
+
+
+	typedef enum PWMPROF_STATE_TYPE {
+		PWMPROF_STATE_IDLE,
+		PWMPROF_STATE_RUNNING,
+		PWMPROF_STATE_COMPLETED
+	}pwmprof_state_t;
+
+
+	typedef struct PWMPROF_SEGMENT_STRUCT {
+		pwmfx_q15_t 	target;			/** Duty at the end of the segment (Q15)	*/
+		uint16_t 		periods;		/** Duration in PWM periods, 1-65535		*/
+		pwmprof_shape_t shape;			/** Shape of the transition					*/
+	}pwmprof_segment_t;
+
+
+	typedef struct PWMPROF_ENVELOPE_STRUCT {
+		const pwmprof_segment_t *segments;	/** Segment table (const, in flash)			*/
+		uint8_t 		count;			/** Number of segments, 1-PWMPROF_SEGMENT_MAX	*/
+		uint16_t 		loops;			/** Number of plays, 0: forever				*/
+	}pwmprof_envelope_t;
+
+
+	typedef struct PWMPROF_STRUCT {
+		pwm_num_t 		id;				/** PWM channel								*/
+		volatile pwmprof_state_t state;	/** State of the profile					*/
+		callback_t 		callback;		/** Called with this object when completed	*/
+		const pwmprof_envelope_t *envelope;	/** Played envelope						*/
+		pwmfx_q15_t 	shift;			/** Phase shift kept during the profile		*/
+		int32_t 		steps[PWMPROF_SEGMENT_MAX];	/** Step (linear) or acceleration (S-curve)	*/
+		int32_t 		restart_step;	/** Step of the first segment in the next loops	*/
+		uint32_t 		duty;			/** Internally used: duty in Q15.15			*/
+		uint16_t 		index;			/** Internally used: current segment		*/
+		uint16_t 		elapsed;		/** Internally used: periods of the segment	*/
+		uint16_t 		loop;			/** Internally used: completed plays		*/
+		volatile bool 	done;			/** Internally used: completion flag		*/
+	}pwmprof_t;
+
+
+	/**
+	 * Returns the profile object of the PWM channel.
+	*/
+	pwmprof_t * pwmprof_get_object(pwm_num_t pwm_num);
+
+
+	/**
+	 * Plays an envelope on a running PWM channel, starting from its current duty.
+	 * The phase shift of the channel is kept.
+	 * Parameters:
+	 * - pwm_num: PWM channel.
+	 * - envelope: Envelope (const, in flash).
+	 * - callback: Called with the pwmprof object when the envelope is completed, can be NULL.
+	*/
+	sys_error_t pwmprof_play(pwm_num_t pwm_num, const pwmprof_envelope_t *envelope, callback_t callback);
+
+
+	/**
+	 * Stops the profile, the duty is left at its current value. The callback is not called.
+	*/
+	sys_error_t pwmprof_stop(pwm_num_t pwm_num);
+
+
+	/**
+	 * Sweeps the timer period of the group. The group is set to the `start` period first.
+	 * Parameters:
+	 * - pwm_group: PWM_GROUP_A or PWM_GROUP_B.
+	 * - start, end: Periods computed by pwmfx_period_compute(), with the same prescaler.
+	 * - periods: Duration of the sweep in PWM periods.
+	 * - callback: Called with NULL when the sweep is completed, can be NULL.
+	 * Return:
+	 * - SYS_ERR if the timer is used by an icap module (pwmfx_period_locked).
+	 * Note:
+	 * - An icap module created on the timer during the sweep aborts it at the next period,
+	 *   the period is left at the value cached by the icap and the callback is not called.
+	*/
+	sys_error_t pwmprof_chirp(pwm_group_t pwm_group, const pwmfx_period_t *start, const pwmfx_period_t *end, uint16_t periods, callback_t callback);
+
+
+	/**
+	 * Stops the sweep, the period is left at its current value.
+	*/
+	sys_error_t pwmprof_chirp_stop(pwm_group_t pwm_group);
+
+
+	/**
+	 * Calls the completion callbacks.
+	 * This function must be called by the main loop.
+	*/
+	void pwmprof_exec(void);
+
+#endif //__PWMPROF_H__
@@ -0,0 +1,138 @@
+/*
+************************************************************
+* QENC Header File                                         *
+* (Quadrature encoder decoding)                            *
+************************************************************
+* File:    qenc.h                                          *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+/**
+ * The A and B channels of an incremental encoder are decoded in the change notification
+ * (CN) ISR. The previous and the new AB states index a 16-entry transition table that gives
+ * +1, -1, 0 (no change) or an illegal transition (both channels changed, an edge was missed).
+ * Every transition is counted (x4 decoding) into a 32-bit position.
+ *
+ *        +---+   +---+             AB: 00 -> 10 -> 11 -> 01 -> 00  : +1 per step (A leads B)
+ *   A  --+   +---+   +---          AB: 00 -> 01 -> 11 -> 10 -> 00  : -1 per step (B leads A)
+ *          +---+   +---+
+ *   B  ----+   +---+   +---
+ *
+ * The velocity is computed by qenc_exec() from the position change of a fixed sampling
+ * interval. The ISR work is a table lookup and a 32-bit add, 50k transitions/s per encoder
+ * take about a third of the 16 MIPS core including the CN ISR entry.
+ */
+
+#ifndef __QENC_H__
+#define __QENC_H__
+
+    #include <gpio.h>
+    #include <cndisp.h>
+
+    typedef enum QENC_NUM_TYPE {
+        QENC_NUM_0,
+        QENC_NUM_1,
+        QENC_NUM_COUNT
+    }qenc_num_t;
+
+
+    typedef struct QENC_STRUCT {
+        qenc_num_t          id;
+        gpio_num_t          gpio_a;             /** Channel A                                       */
+        gpio_num_t          gpio_b;             /** Channel B                                       */
+        int8_t              direction;          /** +1 or -1, reverses the counting direction       */
+        uint16_t            sampling_interval;  /** Ticks (ms) between the velocity samples         */
+        volatile int32_t    position;           /** Counts, written by the CN ISR                   */
+        volatile uint16_t   errors;             /** Illegal transitions, written by the CN ISR      */
+        int32_t             delta;              /** Counts of the last sampling interval            */
+        float               velocity;           /** Counts per second of the last sampling interval */
+        uint8_t             state;              /** Internally used: last AB state                  */
+        int32_t             last_position;      /** Internally used: position of the last sample    */
+        uint16_t            ticks;              /** Internally used: sampling tick counter          */
+    }qenc_t;
+
+
+    /**
+     * Returns the encoder object.
+     * Parameter:
+     * - qenc_num: Id of the encoder, QENC_NUM_<1:0>.
+    */
+    qenc_t * qenc_get_object(qenc_num_t qenc_num);
+
+
+    /**
+     * Creates an encoder decoder.
+     * Parameters:
+     * - qenc_num: Id of the encoder.
+     * - gpio_a: Channel A. It is set to digital input with CN enabled.
+     * - gpio_b: Channel B. It is set to digital input with CN enabled.
+     * - sampling_interval: Ticks (ms) between the velocity samples (1-65535).
+     * Note:
+     * - qenc_cn_handler() is attached to CNDISP_SLOT_QENC of the CN dispatcher.
+    */
+    sys_error_t qenc_create(qenc_num_t qenc_num, gpio_num_t gpio_a, gpio_num_t gpio_b, uint16_t sampling_interval);
+
+
+    /**
+     * Deletes the encoder decoder. The CN of the pins is kept enabled.
+     * Parameter:
+     * - qenc_num: Id of the encoder.
+    */
+    sys_error_t qenc_delete(qenc_num_t qenc_num);
+
+
+    /**
+     * Reverses the counting direction.
+     * Parameters:
+     * - qenc_num: Id of the encoder.
+     * - reverse: true to count down when A leads B.
+    */
+    sys_error_t qenc_set_reverse(qenc_num_t qenc_num, bool reverse);
+
+
+    /**
+     * Returns the position (atomic read of the 32-bit counter).
+     * Parameter:
+     * - qenc_num: Id of the encoder.
+    */
+    int32_t qenc_get_position(qenc_num_t qenc_num);
+
+
+    /**
+     * Sets the position.
+     * Parameters:
+     * - qenc_num: Id of the encoder.
+     * - position: New position.
+    */
+    sys_error_t qenc_set_position(qenc_num_t qenc_num, int32_t position);
+
+
+    /**
+     * Returns the number of illegal transitions, and clears it.
+     * Parameter:
+     * - qenc_num: Id of the encoder.
+    */
+    uint16_t qenc_get_errors(qenc_num_t qenc_num);
+
+
+    /**
+     * Change notification handler of the decoder.
+     * Parameter:
+     * - data: Port snapshots passed by the CN ISR.
+     * Note:
+     * - Called in ISR context.
+    */
+    void qenc_cn_handler(gpio_inputs_change_data_t *data);
+
+
+    /**
+     * Updates the velocity of the encoders.
+     * This function must be called by the main loop every 1 ms.
+    */
+    void qenc_exec(void);
+
+#endif // __QENC_H__
@@ -0,0 +1,190 @@
+/*
+************************************************************
+* RPC Header File                                          *
+* (Binary request/response protocol beside cmdex)          *
+************************************************************
+* File:    rpc.h                                           *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+/**
+ * Binary requests and text commands share one serial port. A byte 0xA5 (never part of an ASCII
+ * line) starts a binary frame, all other bytes build text lines that are passed to cmdex_exec_on().
+ *
+ * Request, all multi-byte fields are little-endian:
+ * | 0xA5 | 0xC3 | id (1) | opcode (1) | length (1) | arguments (length) | CRC-16/CCITT (2) |
+ *
+ * Response:
+ * | 0xA5 | 0xC4 | id (1) | opcode (1) | status (1) | length (1) | result (length) | CRC-16/CCITT (2) |
+ *
+ * The CRC covers all previous bytes of the frame (crc16_compute). The arguments and the result
+ * of an opcode have fixed sizes, the result is empty if the status is not RPC_STATUS_OK
+ * (except RPC_OP_BATCH).
+ * A request with a CRC error is dropped without a response, the host times it out.
+ *
+ * The requests are handled in order and the responses carry the id of their request, so the
+ * host can send several requests without waiting (pipelining). The number of requests in
+ * flight is limited by the RX queue of the port (serial_init), 16 requests of 8 bytes need
+ * a 128-byte RX queue.
+ *
+ * Built-in opcodes:
+ * | opcode | name              | arguments                         | result                   |
+ * | 0x01   | RPC_OP_PING       | -                                 | ticks (4, ms)            |
+ * | 0x10   | RPC_OP_PWM_DUTY   | pwm (1), duty Q15 (2)             | -                        |
+ * | 0x11   | RPC_OP_PWM_Q15    | pwm (1), shift Q15 (2), duty (2)  | -                        |
+ * | 0x20   | RPC_OP_ANALOG     | channel (1)                       | raw (2)                  |
+ * | 0x21   | RPC_OP_ANALOG_ALL | -                                 | raw (2 x ANALOG_NUM_COUNT) |
+ * | 0x30   | RPC_OP_GPIO_WRITE | gpio (1), level (1)               | -                        |
+ * | 0x31   | RPC_OP_GPIO_READ  | gpio (1)                          | level (1)                |
+ * | 0x40   | RPC_OP_BATCH      | commands (up to RPC_ARG_MAX)      | count (1), index (1)     |
+ *
+ * A batch is up to RPC_BATCH_MAX commands, each one an opcode followed by its arguments:
+ *
+ *   | 0x10 | 0x00 | 0x00 0x20 | 0x10 | 0x01 | 0x00 0x60 | 0x30 | 0x11 | 0x01 |
+ *
+ * Like a batch line of cmdex, all commands are checked first, none is applied if one is unknown,
+ * incomplete or fails its check pass (cmdex_batch_checking). They are then applied together: the
+ * PWM writes are committed at once by cmdex_batch_end() and the GPIO writes follow the commit,
+ * all with the system tick masked.
+ * The status is the status of the first command that failed, the result is always sent: the number
+ * of commands and the index of the failed command, or RPC_BATCH_NONE. RPC_STATUS_FAILED with the
+ * index `count` is an apply pass longer than one system tick, its PWM and GPIO writes are dropped.
+ * The results of the commands (e.g. RPC_OP_ANALOG) are not sent.
+ *
+ * The host client is tools/rpc_client.py.
+ */
+
+#ifndef __RPC_H__
+#define __RPC_H__
+
+    #include <cmdex.h>
+    #include <crc.h>
+
+    /**
+     * Sync bytes of the request and the response frames.
+    */
+    #define RPC_SYNC                0xA5
+    #define RPC_SYNC_REQUEST        0xC3
+    #define RPC_SYNC_RESPONSE       0xC4
+
+    /**
+     * Maximum size of the arguments and of the result.
+    */
+    #define RPC_ARG_MAX             32
+    #define RPC_RESULT_MAX          16
+
+    /**
+     * Maximum number of commands of a batch, and the index of a batch without failures.
+    */
+    #define RPC_BATCH_MAX           8
+    #define RPC_BATCH_NONE          0xFF
+
+    /**
+     * Maximum length of a text line, batch lines included.
+    */
+    #define RPC_LINE_MAX            96
+
+
+    typedef enum RPC_OPCODE_TYPE {
+        RPC_OP_PING         = 0x01,
+        RPC_OP_PWM_DUTY     = 0x10,
+        RPC_OP_PWM_Q15      = 0x11,
+        RPC_OP_ANALOG       = 0x20,
+        RPC_OP_ANALOG_ALL   = 0x21,
+        RPC_OP_GPIO_WRITE   = 0x30,
+        RPC_OP_GPIO_READ    = 0x31,
+        RPC_OP_BATCH        = 0x40
+    }rpc_opcode_t;
+
+
+    typedef enum RPC_STATUS_TYPE {
+        RPC_STATUS_OK,
+        RPC_STATUS_UNKNOWN_OPCODE,
+        RPC_STATUS_BAD_LENGTH,
+        RPC_STATUS_BAD_ARGUMENT,
+        RPC_STATUS_FAILED
+    }rpc_status_t;
+
+
+    /**
+     * Handler of an opcode.
+     * Parameters:
+     * - args: Arguments, `arg_size` bytes.
+     * - result: Result buffer, `result_size` bytes are sent if RPC_STATUS_OK is returned.
+    */
+    typedef rpc_status_t (*rpc_handler_t)(const uint8_t *args, uint8_t *result);
+
+
+    typedef struct RPC_COMMAND_STRUCT {
+        uint8_t         opcode;         /** Opcode, the table is sorted by opcode   */
+        uint8_t         arg_size;       /** Size of the arguments in bytes          */
+        uint8_t         result_size;    /** Size of the result in bytes             */
+        rpc_handler_t   handler;
+    }rpc_command_t;
+
+
+    typedef struct RPC_STRUCT {
+        serial_num_t    serial_num;     /** Port of the requests and the lines      */
+        uint32_t        requests;       /** Handled requests                        */
+        uint32_t        lines;          /** Text lines passed to cmdex_exec_on()    */
+        uint16_t        crc_errors;     /** Dropped requests                        */
+        uint16_t        overflows;      /** Text lines longer than RPC_LINE_MAX     */
+        uint16_t        tx_drops;       /** Responses that did not fit the TX queue */
+        uint8_t         state;          /** Internally used: receiver state         */
+        uint8_t         count;          /** Internally used: bytes of the state     */
+        uint8_t         frame[5 + RPC_ARG_MAX + 2];   /** Internally used: request  */
+        uint8_t         line_length;    /** Internally used: bytes of the line      */
+        char            line[RPC_LINE_MAX + 1];      /** Internally used: text line */
+    }rpc_t;
+
+
+    /**
+     * Returns the rpc object.
+    */
+    rpc_t * rpc_get_object(void);
+
+
+    /**
+     * Starts receiving the requests and the text lines of the serial port.
+     * Parameter:
+     * - serial_num: Id of the serial port, initialized by serial_init().
+     * Note:
+     * - Do not create a line receiver (cmdex_init) on the same port, rpc reads the RX queue.
+    */
+    sys_error_t rpc_init(serial_num_t serial_num);
+
+
+    /**
+     * Registers the user opcode table, it is searched before the built-in opcodes.
+     * Parameters:
+     * - commands: Table (const, in flash), sorted by opcode without duplicates, without RPC_OP_BATCH.
+     * - count: Number of opcodes.
+     * Note:
+     * - In a batch the handlers are called twice, like the handlers of cmdex: while
+     *   cmdex_batch_checking() is true they only check their arguments.
+    */
+    sys_error_t rpc_register(const rpc_command_t *commands, uint16_t count);
+
+
+    /**
+     * Handles a request frame (sync to CRC) and writes the response frame.
+     * Parameters:
+     * - request: Request frame, the CRC is not checked.
+     * - response: Response buffer, at least 8 + RPC_RESULT_MAX bytes.
+     * Return:
+     * - Length of the response frame.
+    */
+    uint16_t rpc_handle(const uint8_t *request, uint8_t *response);
+
+
+    /**
+     * Reads the received bytes, handles the requests and the text lines.
+     * This function must be called by the main loop.
+    */
+    void rpc_exec(void);
+
+#endif // __RPC_H__
@@ -0,0 +1,126 @@
+/*
+************************************************************
+* SCAN Header File                                         *
+* (Process-image scan cycle)                               *
+************************************************************
+* File:    scan.h                                          *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+/**
+ * PLC-style scan cycle. Once per scan, all inputs are copied into a contiguous input
+ * image, the scan callback computes the outputs from the images only, and the output
+ * image is committed at the end of the scan:
+ *
+ *   +--------------+     +-----------------+     +-----------------+
+ *   | read inputs  | --> | scan callback   | --> | commit outputs  |
+ *   | PORTA, PORTB |     | reads inputs,   |     | LATA, LATB      |
+ *   | switches     |     | writes outputs  |     | (masked writes) |
+ *   | analog       |     |                 |     | PWM duties      |
+ *   +--------------+     +-----------------+     +-----------------+
+ *
+ * The callback sees one consistent snapshot, and the hardware is touched a fixed number
+ * of times per scan: two PORT reads, two masked LAT writes, and one PWM update per changed
+ * duty ratio. The switch and analog values are the ones computed by switch_exec() and
+ * analog_exec_read(), no extra conversion is started.
+ *
+ * The Ternion loop runs in the library, the scan mode is enabled by calling scan_exec()
+ * from the loop callback:
+ *
+ *   scan_set_outputs(GPIO_GROUP_B, 0x00F0);     // LED<3:0>
+ *   scan_set_callback(plc_scan);
+ *   ternion_loop_set(10, scan_exec);            // 10 ms scan
+ */
+
+#ifndef __SCAN_H__
+#define __SCAN_H__
+
+    #include <fastio.h>
+    #include <pwm.h>
+    #include <analog.h>
+    #include <switch.h>
+
+
+    typedef struct SCAN_INPUTS_STRUCT {
+        uint32_t            tick;                           /** System tick of the scan                 */
+        uint32_t            scan_count;                     /** Number of the scans                     */
+        uint16_t            port_a;                         /** PORTA levels                            */
+        uint16_t            port_b;                         /** PORTB levels                            */
+        uint16_t            switches;                       /** Bit n is set if switch n is not OFF     */
+        switch_state_t      switch_states[SWITCH_NUM_COUNT];/** States of the switch detectors          */
+        int16_t             analog[ANALOG_NUM_COUNT];       /** Raw 10-bit analog values                */
+    }scan_inputs_t;
+
+
+    typedef struct SCAN_OUTPUTS_STRUCT {
+        uint16_t            lat_a;                          /** LATA levels of the owned pins           */
+        uint16_t            lat_b;                          /** LATB levels of the owned pins           */
+        float               duty_ratio[PWM_NUM_COUNT];      /** Duty ratios of the owned PWM channels   */
+    }scan_outputs_t;
+
+
+    typedef void (*scan_callback_t)(const scan_inputs_t *inputs, scan_outputs_t *outputs);
+
+
+    /**
+     * Returns the input image of the last scan.
+    */
+    const scan_inputs_t * scan_get_inputs(void);
+
+
+    /**
+     * Returns the output image. It can also be written outside the scan callback,
+     * it is committed at the end of the next scan.
+    */
+    scan_outputs_t * scan_get_outputs(void);
+
+
+    /**
+     * Sets the LAT pins owned by the output image. The image is loaded from the LAT register.
+     * Parameters:
+     * - gpio_group: GPIO_GROUP_A or GPIO_GROUP_B.
+     * - mask: Owned pins, they must be configured as digital outputs.
+    */
+    sys_error_t scan_set_outputs(gpio_group_t gpio_group, uint16_t mask);
+
+
+    /**
+     * Sets the PWM channels owned by the output image.
+     * Parameter:
+     * - pwm_mask: Bit n is PWM_NUM_n. The channels must be created using pwm_create().
+    */
+    sys_error_t scan_set_pwm_outputs(uint16_t pwm_mask);
+
+
+    /**
+     * Sets the scan callback function.
+     * Parameter:
+     * - scan_callback: Called with the input and output images on every scan.
+    */
+    sys_error_t scan_set_callback(scan_callback_t scan_callback);
+
+
+    /**
+     * Reads the inputs into the input image.
+    */
+    void scan_read_inputs(void);
+
+
+    /**
+     * Commits the output image to the hardware.
+    */
+    void scan_write_outputs(void);
+
+
+    /**
+     * Executes one scan: reads the inputs, calls the scan callback and commits the outputs.
+     * Parameter:
+     * - param: Not used, it allows scan_exec() to be the loop callback.
+    */
+    void scan_exec(void *param);
+
+#endif // __SCAN_H__
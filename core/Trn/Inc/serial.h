@@ -101,11 +101,14 @@ int16_t serial_write_bytes(serial_num_t serial_num, const uint8_t* bytes, uint16
 
 
 /**
- * Synchonous writes the given bytes data the target uart.
+ * Asynchronous writes the given bytes data the target uart (TX queue).
  * Parameters:
  * - serial_num: Id of the target uart (SERIAL_NUM_1 or SERIAL_NUM_2).
  * - bytes: Bytes data to be written to the target uart.
  * - length: Number of bytes of the byte data.
+ * Return:
+ * - QUEUE_OK if all bytes are in the TX queue.
+ * - -1 if the free space of the TX queue is less than length, nothing is written.
 */
 int16_t serial_write_bytes_async(serial_num_t serial_num, const uint8_t* bytes, uint16_t length);
 
@@ -0,0 +1,106 @@
+/*
+************************************************************
+* STREAM Header File                                       *
+* (Multi-channel ADC streaming to the host)                *
+************************************************************
+* File:    stream.h                                        *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+#ifndef __STREAM_H__
+#define __STREAM_H__
+
+    #include <analog.h>
+    #include <serial.h>
+    #include <crc.h>
+
+    /**
+     * Maximum number of records (one sample of every channel) in a frame.
+    */
+    #define STREAM_RECORDS_MAX      16
+
+
+    /**
+     * Sync bytes of the stream frame.
+    */
+    #define STREAM_FRAME_SYNC_0     0xA5
+    #define STREAM_FRAME_SYNC_1     0x5A
+
+
+    /**
+     * Frame header size and maximum frame size in bytes.
+     * The 10-bit samples are packed 4 samples in 5 bytes.
+    */
+    #define STREAM_HEADER_SIZE      12
+    #define STREAM_PAYLOAD_MAX      (((STREAM_RECORDS_MAX * ANALOG_NUM_COUNT + 3) / 4) * 5)
+    #define STREAM_FRAME_MAX        (STREAM_HEADER_SIZE + STREAM_PAYLOAD_MAX + 2)
+
+
+    typedef struct STREAM_STRUCT {
+        serial_num_t    serial_num;         /** Target uart                                 */
+        uint8_t         channel_mask;       /** Streamed channels, bit n is ANALOG_NUM_n    */
+        uint8_t         channel_count;      /** Number of streamed channels                 */
+        uint8_t         records;            /** Records per frame                           */
+        uint16_t        sampling_interval;  /** Ticks (ms) between records                  */
+        bool            running;            /** Streaming flag                              */
+        uint16_t        sequence;           /** Sequence number of the next frame           */
+        uint32_t        frames_sent;        /** Frames handed to the TX queue               */
+        uint32_t        frames_dropped;     /** Frames dropped, not enough TX queue space   */
+        uint16_t        ticks;              /** Internally used: sampling tick counter      */
+        uint8_t         record_count;       /** Internally used: records in the frame       */
+        uint8_t         pending;            /** Internally used: samples in the pack group  */
+        uint16_t        length;             /** Internally used: frame length in bytes      */
+        int16_t         group[4];           /** Internally used: samples to be packed       */
+    }stream_t;
+
+
+    /**
+     * Returns the stream object.
+    */
+    stream_t * stream_get_object(void);
+
+
+    /**
+     * Starts streaming the given analog channels.
+     * Parameters:
+     * - serial_num: Id of the target uart.
+     * - channel_mask: Channels to be streamed, bit n selects ANALOG_NUM_n.
+     * - sampling_interval: Time interval (in milliseconds) between the records (1-65535).
+     * - records: Records per frame (1-STREAM_RECORDS_MAX).
+     *
+     * Frame layout, all multi-byte fields are little-endian:
+     * | 0xA5 | 0x5A | sequence (2) | timestamp (4) | mask (1) | records (1) | interval (2) |
+     * | packed samples | CRC-16/CCITT of all previous bytes (2) |
+     *
+     * The samples are interleaved (record 0: channel a, b, ..., record 1: ...) and
+     * every 4 samples s0-s3 are packed in 5 bytes:
+     * | s0[7:0] | s1[7:0] | s2[7:0] | s3[7:0] | s3[9:8] s2[9:8] s1[9:8] s0[9:8] |
+     * The last group is padded with zeros. The timestamp is the system tick of the first record.
+     *
+     * Note:
+     * - The frames are written to the async TX queue, the TX buffer must be larger than
+     *   the frame (STREAM_FRAME_MAX bytes at most). A frame that does not fit the free space of the
+     *   TX queue is dropped whole and counted in frames_dropped, the host detects it as a gap in the
+     *   sequence numbers.
+     * - Six channels at 1 ms with 8 records per frame need 9.3 kB/s, 115200 bps carries 11.5 kB/s.
+    */
+    sys_error_t stream_start(serial_num_t serial_num, uint8_t channel_mask, uint16_t sampling_interval, uint8_t records);
+
+
+    /**
+     * Stops streaming. The partially filled frame is discarded.
+    */
+    sys_error_t stream_stop(void);
+
+
+    /**
+     * Executes the stream sampling and sends the completed frames.
+     * This function must be called by the main loop every 1 ms (system tick), after analog_exec_read().
+    */
+    void stream_exec(void);
+
+#endif // __STREAM_H__
@@ -19,16 +19,35 @@
 #include <ctype.h>
 #include <mcu.h>
 #include <gpio.h>
+#include <fastio.h>
+#include <icap.h>
 #include <uart.h>
 #include <serial.h>
 #include <adc.h>
 #include <pwm.h>
+#include <pwmfx.h>
 #include <systick.h>
 #include <timer.h>
 #include <analog.h>
 #include <switch.h>
 #include <pdsgen.h>
 #include <cmdex.h>
+#include <capture.h>
+#include <stream.h>
+#include <keypad.h>
+#include <cndisp.h>
+#include <debounce.h>
+#include <edge.h>
+#include <qenc.h>
+#include <scan.h>
+#include <ocgen.h>
+#include <pdsseq.h>
+#include <bam.h>
+#include <pwmprof.h>
+#include <pidctl.h>
+#include <motion.h>
+#include <rpc.h>
+#include <watch.h>
 
 typedef enum TRN_ERROR_TYPE
 {
@@ -74,6 +93,9 @@ trn_err_t ternion_start(callback_t loop_callback);
 
 
 
+    /**
+     * See fastio_read_led_data() and fastio_read_psw_data() for the single register access versions.
+    */
     uint8_t ternion_read_led_data(void);
 
     uint8_t ternion_read_psw_data(void);
@@ -0,0 +1,172 @@
+/*
+************************************************************
+* WATCH Header File                                        *
+* (Live variable watch and telemetry frames)               *
+************************************************************
+* File:    watch.h                                         *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+/**
+ * The watch list holds up to WATCH_ENTRY_MAX RAM variables (address and type). Every `interval`
+ * ticks all variables are copied with the interrupts disabled, so the values of a frame are from
+ * the same instant and a 32-bit value written by an ISR is never torn, and the frame is written
+ * to the async TX queue.
+ *
+ * The list is configured without reflashing by the `watch` command of cmdex:
+ *
+ *   watch clear
+ *   watch add 0x0852 i16        // address from the map file or the ELF symbols
+ *   watch add 0x0860 f32
+ *   watch start 10              // every 10 ticks (ms), to the port of the command
+ *   watch list
+ *   watch stop
+ *
+ * The host tool tools/watch.py resolves the symbols of ternion-app.elf, sends these commands
+ * and records or plots the frames.
+ */
+
+#ifndef __WATCH_H__
+#define __WATCH_H__
+
+    #include <serial.h>
+    #include <crc.h>
+
+    /**
+     * Maximum number of watched variables.
+    */
+    #define WATCH_ENTRY_MAX         8
+
+
+    /**
+     * Sync bytes of the watch frame.
+    */
+    #define WATCH_FRAME_SYNC_0      0xA5
+    #define WATCH_FRAME_SYNC_1      0x57
+
+
+    /**
+     * Watched addresses, the data RAM of the PIC24FJ48GA002 (the SFRs are not watched,
+     * reading some of them has side effects).
+    */
+    #define WATCH_RAM_START         0x0800
+    #define WATCH_RAM_END           0x2800
+
+
+    /**
+     * Frame header size and maximum frame size in bytes.
+    */
+    #define WATCH_HEADER_SIZE       9
+    #define WATCH_FRAME_MAX         (WATCH_HEADER_SIZE + WATCH_ENTRY_MAX * 5 + 2)
+
+
+    /**
+     * Variable types, bits 3:0 are the width in bytes.
+    */
+    typedef enum WATCH_TYPE_TYPE {
+        WATCH_TYPE_U8   = 0x01,
+        WATCH_TYPE_I8   = 0x11,
+        WATCH_TYPE_U16  = 0x02,
+        WATCH_TYPE_I16  = 0x12,
+        WATCH_TYPE_U32  = 0x04,
+        WATCH_TYPE_I32  = 0x14,
+        WATCH_TYPE_F32  = 0x24
+    }watch_type_t;
+
+    #define WATCH_TYPE_WIDTH(type)  ((uint8_t)(type) & 0x0F)
+
+
+    typedef struct WATCH_ENTRY_STRUCT {
+        uint16_t        address;            /** RAM address of the variable                 */
+        watch_type_t    type;               /** Type and width                              */
+    }watch_entry_t;
+
+
+    typedef struct WATCH_STRUCT {
+        serial_num_t    serial_num;         /** Target uart                                 */
+        uint16_t        interval;           /** Ticks (ms) between the frames               */
+        bool            running;            /** Streaming flag                              */
+        uint8_t         count;              /** Number of entries                           */
+        watch_entry_t   entries[WATCH_ENTRY_MAX];
+        uint16_t        sequence;           /** Sequence number of the next frame           */
+        uint32_t        frames_sent;        /** Frames handed to the TX queue               */
+        uint32_t        frames_dropped;     /** Frames dropped, not enough TX queue space   */
+        uint16_t        ticks;              /** Internally used: tick counter               */
+    }watch_t;
+
+
+    /**
+     * Returns the watch object.
+    */
+    watch_t * watch_get_object(void);
+
+
+    /**
+     * Returns the type of the name (u8, i8, u16, i16, u32, i32, f32).
+     * Return:
+     * - SYS_ERR if the name is unknown.
+    */
+    sys_error_t watch_parse_type(const char *name, watch_type_t *type);
+
+
+    /**
+     * Returns the name of the type, "?" if it is unknown.
+    */
+    const char * watch_type_name(watch_type_t type);
+
+
+    /**
+     * Appends a variable to the watch list, also while streaming.
+     * Parameters:
+     * - address: RAM address, WATCH_RAM_START to WATCH_RAM_END, even for 16-bit and 32-bit types
+     *   (an odd word address traps the PIC24).
+     * - type: Type of the variable.
+    */
+    sys_error_t watch_add(uint16_t address, watch_type_t type);
+
+
+    /**
+     * Removes all variables, the streaming is stopped.
+    */
+    sys_error_t watch_clear(void);
+
+
+    /**
+     * Starts sending the frames.
+     * Parameters:
+     * - serial_num: Id of the target uart.
+     * - interval: Time interval (in milliseconds) between the frames (1-65535).
+     *
+     * Frame layout, all multi-byte fields are little-endian:
+     * | 0xA5 | 0x57 | sequence (2) | timestamp (4) | count (1) | types (count) |
+     * | values (sum of the widths) | CRC-16/CCITT of all previous bytes (2) |
+     *
+     * The types are the watch_type_t values, the values follow in the order of the list.
+     * The timestamp is the system tick of the snapshot.
+     *
+     * Note:
+     * - The frames are written to the async TX queue, the TX buffer must be larger than
+     *   the frame (WATCH_FRAME_MAX bytes at most). A frame that does not fit the free space of the
+     *   TX queue is dropped whole and counted in frames_dropped, the host detects it as a gap in the
+     *   sequence numbers.
+    */
+    sys_error_t watch_start(serial_num_t serial_num, uint16_t interval);
+
+
+    /**
+     * Stops sending the frames.
+    */
+    sys_error_t watch_stop(void);
+
+
+    /**
+     * Takes the snapshots and sends the frames.
+     * This function must be called by the main loop every 1 ms (system tick).
+    */
+    void watch_exec(void);
+
+#endif // __WATCH_H__
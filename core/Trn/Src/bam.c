@@ -0,0 +1,226 @@
+/*
+************************************************************
+* BAM Source File                                          *
+* (Bit-angle-modulation software PWM)                      *
+************************************************************
+* File:    bam.c                                           *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+#include <bam.h>
+
+
+/**
+ * Number of lsb periods in a frame (2^BAM_PLANE_COUNT - 1).
+ */
+#define BAM_FRAME_LSBS			255
+
+
+/** LAT images of PORTA and PORTB of each plane, double-buffered */
+static uint16_t				_bam_planes[2][BAM_PLANE_COUNT][2];
+static volatile uint8_t		_bam_front;
+static volatile bool		_bam_swap;
+
+static uint16_t				_bam_mask[2];				/** BAM pins of PORTA, PORTB	*/
+static gpio_num_t			_bam_pins[BAM_PIN_MAX];
+static uint8_t				_bam_levels[BAM_PIN_MAX];
+static uint8_t				_bam_count;
+
+static int8_t				_bam_oc = -1;
+static uint8_t				_bam_plane;
+static uint16_t				_bam_lsb_ticks;
+static volatile uint16_t	_bam_slips;
+
+
+/**
+ * Called at the start of each plane (OCxR match).
+ */
+static void bam_oc_handler(int8_t oc, void *context)
+{
+	volatile uint16_t *regs = ocgen_oc_regs(oc);
+	uint16_t edge  = regs[1];
+	uint8_t  plane = _bam_plane;
+
+	if (plane == 0 && _bam_swap)
+	{
+		_bam_front ^= 1;
+		_bam_swap   = false;
+	}
+
+	const uint16_t *image = _bam_planes[_bam_front][plane];
+	if (_bam_mask[GPIO_GROUP_A])
+	{
+		fastio_port_write(GPIO_GROUP_A, _bam_mask[GPIO_GROUP_A], image[GPIO_GROUP_A]);
+	}
+	if (_bam_mask[GPIO_GROUP_B])
+	{
+		fastio_port_write(GPIO_GROUP_B, _bam_mask[GPIO_GROUP_B], image[GPIO_GROUP_B]);
+	}
+
+	uint16_t ticks = _bam_lsb_ticks << plane;
+	_bam_plane = (plane + 1) & (BAM_PLANE_COUNT - 1);
+
+	/** The next plane is timed from this match, not from the ISR entry */
+	int16_t elapsed = (int16_t)(ocgen_get_time() - edge);
+	if ((int32_t)elapsed + ocgen_get_lead_ticks() > (int32_t)ticks)
+	{
+		ticks = elapsed + ocgen_get_lead_ticks();
+		_bam_slips++;
+	}
+	regs[1] = edge + ticks;
+}
+
+
+sys_error_t bam_init(const gpio_num_t *pins, uint8_t count, uint16_t frame_hz)
+{
+	uint8_t i;
+
+	if (pins == NULL || count == 0 || count > BAM_PIN_MAX || frame_hz == 0)
+	{
+		return SYS_ERR;
+	}
+
+	bam_stop();
+
+	uint32_t lsb = ((uint32_t)ocgen_get_clock_khz() * 1000) / ((uint32_t)frame_hz * BAM_FRAME_LSBS);
+	if (lsb < 2 * ocgen_get_lead_ticks() || (lsb << (BAM_PLANE_COUNT - 1)) > 0x7FFF)
+	{
+		return SYS_ERR;
+	}
+
+	_bam_mask[GPIO_GROUP_A] = 0;
+	_bam_mask[GPIO_GROUP_B] = 0;
+	for (i = 0; i < count; i++)
+	{
+		_bam_pins[i]   = pins[i];
+		_bam_levels[i] = 0;
+		_bam_mask[(pins[i] & 0x10) ? GPIO_GROUP_B : GPIO_GROUP_A] |= FASTIO_MASK(pins[i]);
+
+		gpio_set_mode(pins[i], GPIO_MODE_DIGITAL);
+		gpio_set_level(pins[i], GPIO_LEVEL_LOW);
+		gpio_set_direction(pins[i], GPIO_DIRECTION_OUTPUT);
+	}
+	_bam_count     = count;
+	_bam_lsb_ticks = (uint16_t)lsb;
+	_bam_plane     = 0;
+	_bam_slips     = 0;
+	_bam_front     = 0;
+	_bam_swap      = false;
+	memset(_bam_planes, 0, sizeof(_bam_planes));
+
+	_bam_oc = ocgen_oc_claim(OCGEN_GPIO_NONE, bam_oc_handler, NULL);
+	if (_bam_oc < 0)
+	{
+		_bam_count = 0;
+		return SYS_ERR;
+	}
+
+	PERFORM_CRITICAL_SECTION({
+		ocgen_oc_regs(_bam_oc)[1] = ocgen_get_time() + 2 * ocgen_get_lead_ticks();
+		ocgen_oc_enable(_bam_oc, OCGEN_OCM_TOGGLE);
+	});
+	return SYS_OK;
+}
+
+
+void bam_stop(void)
+{
+	uint8_t i;
+
+	if (_bam_oc >= 0)
+	{
+		ocgen_oc_release(_bam_oc, OCGEN_GPIO_NONE);
+		_bam_oc = -1;
+	}
+	for (i = 0; i < _bam_count; i++)
+	{
+		gpio_set_level(_bam_pins[i], GPIO_LEVEL_LOW);
+	}
+	_bam_count = 0;
+}
+
+
+sys_error_t bam_set_level(uint8_t index, uint8_t level)
+{
+	if (index >= _bam_count)
+	{
+		return SYS_ERR;
+	}
+	_bam_levels[index] = level;
+	return SYS_OK;
+}
+
+
+uint8_t bam_get_level(uint8_t index)
+{
+	return (index < _bam_count) ? _bam_levels[index] : 0;
+}
+
+
+sys_error_t bam_commit(void)
+{
+	uint8_t i, plane, back = 0;
+
+	if (_bam_count == 0)
+	{
+		return SYS_ERR;
+	}
+
+	/** Cancel a commit that was not shown, then the ISR does not read the back buffer */
+	PERFORM_CRITICAL_SECTION({
+		_bam_swap = false;
+		back      = _bam_front ^ 1;
+	});
+
+	uint16_t (*planes)[2] = _bam_planes[back];
+	memset(planes, 0, sizeof(_bam_planes[0]));
+	for (i = 0; i < _bam_count; i++)
+	{
+		uint8_t  level = _bam_levels[i];
+		uint16_t port  = (_bam_pins[i] & 0x10) ? GPIO_GROUP_B : GPIO_GROUP_A;
+		uint16_t mask  = FASTIO_MASK(_bam_pins[i]);
+
+		for (plane = 0; level; plane++, level >>= 1)
+		{
+			if (level & 1)
+			{
+				planes[plane][port] |= mask;
+			}
+		}
+	}
+
+	_bam_swap = true;
+	return SYS_OK;
+}
+
+
+sys_error_t bam_write(const uint8_t *levels)
+{
+	uint8_t i;
+
+	if (levels == NULL || _bam_count == 0)
+	{
+		return SYS_ERR;
+	}
+	for (i = 0; i < _bam_count; i++)
+	{
+		_bam_levels[i] = levels[i];
+	}
+	return bam_commit();
+}
+
+
+bool bam_is_pending(void)
+{
+	return _bam_swap;
+}
+
+
+uint16_t bam_get_slips(void)
+{
+	return _bam_slips;
+}
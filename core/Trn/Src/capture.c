@@ -0,0 +1,370 @@
+/*
+************************************************************
+* CAPTURE Source File                                      *
+* (Triggered capture of the analog channels)               *
+************************************************************
+* File:    capture.c                                       *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+#include <capture.h>
+#include <systick.h>
+
+
+static capture_t _capture;
+static int16_t   _capture_buffer[CAPTURE_BUFFER_LENGTH];
+
+
+capture_t * capture_get_object(void)
+{
+	return &_capture;
+}
+
+
+sys_error_t capture_create(uint8_t channel_mask, uint16_t sampling_interval, uint16_t pre_trigger, uint16_t post_trigger)
+{
+	uint8_t count = 0;
+	int16_t i;
+
+	channel_mask &= (1 << ANALOG_NUM_COUNT) - 1;
+	for (i = 0; i < ANALOG_NUM_COUNT; i++)
+	{
+		if (channel_mask & (1 << i))
+		{
+			count++;
+		}
+	}
+
+	if (count == 0 || sampling_interval == 0 || post_trigger == 0)
+	{
+		return SYS_ERR;
+	}
+
+	if ((uint32_t)(pre_trigger + post_trigger) * count > CAPTURE_BUFFER_LENGTH)
+	{
+		return SYS_ERR;
+	}
+
+	capture_t *capture = &_capture;
+	capture->state             = CAPTURE_STATE_IDLE;
+	capture->channel_mask      = channel_mask;
+	capture->channel_count     = count;
+	capture->trigger           = CAPTURE_TRIGGER_NONE;
+	capture->sampling_interval = sampling_interval;
+	capture->pre_trigger       = pre_trigger;
+	capture->post_trigger      = post_trigger;
+	capture->records           = pre_trigger + post_trigger;
+	capture->put               = 0;
+	capture->count             = 0;
+	capture->remain            = 0;
+	capture->ticks             = 0;
+	capture->trigger_tick      = 0;
+
+	return SYS_OK;
+}
+
+
+sys_error_t capture_set_analog_trigger(capture_trigger_t trigger, analog_num_t analog_num, int16_t level)
+{
+	if (trigger < CAPTURE_TRIGGER_ANALOG_RISING || trigger > CAPTURE_TRIGGER_ANALOG_BELOW)
+	{
+		return SYS_ERR;
+	}
+	if (analog_num >= ANALOG_NUM_COUNT)
+	{
+		return SYS_ERR;
+	}
+	_capture.trigger        = trigger;
+	_capture.trigger_analog = analog_num;
+	_capture.trigger_level  = level;
+	return SYS_OK;
+}
+
+
+sys_error_t capture_set_gpio_trigger(capture_trigger_t trigger, gpio_num_t gpio_num)
+{
+	if (trigger < CAPTURE_TRIGGER_GPIO_RISING || trigger > CAPTURE_TRIGGER_GPIO_CHANGE)
+	{
+		return SYS_ERR;
+	}
+	_capture.trigger      = trigger;
+	_capture.trigger_gpio = gpio_num;
+	return SYS_OK;
+}
+
+
+sys_error_t capture_set_callback(capture_callback_t callback)
+{
+	_capture.callback = callback;
+	return SYS_OK;
+}
+
+
+/**
+ * Returns the current value of the trigger source.
+ */
+static int16_t capture_read_trigger_input(capture_t *capture)
+{
+	if (capture->trigger >= CAPTURE_TRIGGER_GPIO_RISING)
+	{
+		return gpio_get_level(capture->trigger_gpio) ? 1 : 0;
+	}
+	return analog_read_raw(capture->trigger_analog);
+}
+
+
+sys_error_t capture_arm(void)
+{
+	capture_t *capture = &_capture;
+	if (capture->records == 0)
+	{
+		return SYS_ERR;
+	}
+	capture->state    = CAPTURE_STATE_IDLE;
+	capture->put      = 0;
+	capture->count    = 0;
+	capture->ticks    = 0;
+	capture->previous = capture_read_trigger_input(capture);
+	capture->state    = CAPTURE_STATE_ARMED;
+	return SYS_OK;
+}
+
+
+/**
+ * Switches an armed capture to the post-trigger phase.
+ */
+static void capture_trigger(capture_t *capture)
+{
+	capture->trigger_tick = system_tick_get_ticks();
+	capture->remain       = capture->post_trigger;
+	capture->state        = CAPTURE_STATE_TRIGGERED;
+}
+
+
+sys_error_t capture_force_trigger(void)
+{
+	if (_capture.state != CAPTURE_STATE_ARMED)
+	{
+		return SYS_ERR;
+	}
+	capture_trigger(&_capture);
+	return SYS_OK;
+}
+
+
+sys_error_t capture_stop(void)
+{
+	_capture.state = CAPTURE_STATE_IDLE;
+	return SYS_OK;
+}
+
+
+/**
+ * Returns true if the trigger condition is detected.
+ */
+static bool capture_check_trigger(capture_t *capture)
+{
+	int16_t current  = capture_read_trigger_input(capture);
+	int16_t previous = capture->previous;
+	int16_t level    = capture->trigger_level;
+	capture->previous = current;
+
+	switch (capture->trigger)
+	{
+		case CAPTURE_TRIGGER_NONE:              return true;
+		case CAPTURE_TRIGGER_ANALOG_RISING:     return (previous <  level) && (current >= level);
+		case CAPTURE_TRIGGER_ANALOG_FALLING:    return (previous >  level) && (current <= level);
+		case CAPTURE_TRIGGER_ANALOG_ABOVE:      return current > level;
+		case CAPTURE_TRIGGER_ANALOG_BELOW:      return current < level;
+		case CAPTURE_TRIGGER_GPIO_RISING:       return !previous &&  current;
+		case CAPTURE_TRIGGER_GPIO_FALLING:      return  previous && !current;
+		case CAPTURE_TRIGGER_GPIO_CHANGE:       return  previous !=  current;
+		default:                                return false;
+	}
+}
+
+
+/**
+ * Stores one record (one sample of every selected channel) into the ring.
+ */
+static void capture_store_record(capture_t *capture)
+{
+	int16_t *p = &_capture_buffer[capture->put * capture->channel_count];
+	int16_t i;
+	for (i = 0; i < ANALOG_NUM_COUNT; i++)
+	{
+		if (capture->channel_mask & (1 << i))
+		{
+			*p++ = analog_read_raw((analog_num_t)i);
+		}
+	}
+	if (++capture->put >= capture->records)
+	{
+		capture->put = 0;
+	}
+	if (capture->count < capture->records)
+	{
+		capture->count++;
+	}
+}
+
+
+void capture_exec(void)
+{
+	capture_t *capture = &_capture;
+
+	if (capture->state != CAPTURE_STATE_ARMED && capture->state != CAPTURE_STATE_TRIGGERED)
+	{
+		return;
+	}
+
+	/** GPIO triggers are checked every tick to catch short pulses */
+	bool triggered = false;
+	if (capture->state == CAPTURE_STATE_ARMED && capture->trigger >= CAPTURE_TRIGGER_GPIO_RISING)
+	{
+		triggered = capture_check_trigger(capture);
+	}
+
+	if (++capture->ticks < capture->sampling_interval)
+	{
+		if (triggered && capture->count >= capture->pre_trigger)
+		{
+			capture_trigger(capture);
+		}
+		return;
+	}
+	capture->ticks = 0;
+
+	if (capture->state == CAPTURE_STATE_ARMED)
+	{
+		if (capture->trigger < CAPTURE_TRIGGER_GPIO_RISING)
+		{
+			triggered = capture_check_trigger(capture);
+		}
+		/** The trigger is ignored until the pre-trigger window is filled */
+		if (triggered && capture->count >= capture->pre_trigger)
+		{
+			capture_trigger(capture);
+		}
+	}
+
+	capture_store_record(capture);
+
+	if (capture->state == CAPTURE_STATE_TRIGGERED && --capture->remain == 0)
+	{
+		capture->state = CAPTURE_STATE_COMPLETED;
+		if (capture->callback)
+		{
+			capture->callback(capture);
+		}
+	}
+}
+
+
+/**
+ * Returns the ring index of the oldest record.
+ */
+static uint16_t capture_first_record(capture_t *capture)
+{
+	int16_t first = (int16_t)capture->put - (int16_t)capture->count;
+	if (first < 0)
+	{
+		first += capture->records;
+	}
+	return (uint16_t)first;
+}
+
+
+int16_t capture_read_channel(analog_num_t analog_num, int16_t *buffer, uint16_t length)
+{
+	capture_t *capture = &_capture;
+	int16_t offset = 0;
+	int16_t i;
+
+	if (analog_num >= ANALOG_NUM_COUNT || !(capture->channel_mask & (1 << analog_num)))
+	{
+		return -1;
+	}
+	for (i = 0; i < (int16_t)analog_num; i++)
+	{
+		if (capture->channel_mask & (1 << i))
+		{
+			offset++;
+		}
+	}
+
+	uint16_t index = capture_first_record(capture);
+	uint16_t n;
+	for (n = 0; n < capture->count && n < length; n++)
+	{
+		buffer[n] = _capture_buffer[index * capture->channel_count + offset];
+		if (++index >= capture->records)
+		{
+			index = 0;
+		}
+	}
+	return (int16_t)n;
+}
+
+
+/**
+ * Writes the bytes to the uart and updates the checksum.
+ */
+static void capture_write(serial_num_t serial_num, const uint8_t *bytes, uint16_t length, uint16_t *crc)
+{
+	*crc = crc16_compute(*crc, bytes, length);
+	serial_write_bytes(serial_num, bytes, length);
+}
+
+
+sys_error_t capture_send(serial_num_t serial_num)
+{
+	capture_t *capture = &_capture;
+	uint8_t header[14];
+	uint16_t crc = CRC16_INIT;
+
+	if (capture->state != CAPTURE_STATE_COMPLETED)
+	{
+		return SYS_ERR;
+	}
+
+	uint16_t pre = capture->count - capture->post_trigger;
+	header[0]  = CAPTURE_BLOCK_SYNC_0;
+	header[1]  = CAPTURE_BLOCK_SYNC_1;
+	header[2]  = capture->channel_mask;
+	header[3]  = capture->channel_count;
+	header[4]  = (uint8_t)(capture->sampling_interval);
+	header[5]  = (uint8_t)(capture->sampling_interval >> 8);
+	header[6]  = (uint8_t)(capture->count);
+	header[7]  = (uint8_t)(capture->count >> 8);
+	header[8]  = (uint8_t)(pre);
+	header[9]  = (uint8_t)(pre >> 8);
+	header[10] = (uint8_t)(capture->trigger_tick);
+	header[11] = (uint8_t)(capture->trigger_tick >> 8);
+	header[12] = (uint8_t)(capture->trigger_tick >> 16);
+	header[13] = (uint8_t)(capture->trigger_tick >> 24);
+	capture_write(serial_num, header, sizeof(header), &crc);
+
+	/** The PIC24 is little-endian, the records are sent directly from the ring */
+	uint16_t index = capture_first_record(capture);
+	uint16_t n;
+	for (n = 0; n < capture->count; n++)
+	{
+		capture_write(serial_num, (const uint8_t *)&_capture_buffer[index * capture->channel_count],
+					  capture->channel_count * sizeof(int16_t), &crc);
+		if (++index >= capture->records)
+		{
+			index = 0;
+		}
+	}
+
+	header[0] = (uint8_t)(crc);
+	header[1] = (uint8_t)(crc >> 8);
+	serial_write_bytes(serial_num, header, 2);
+
+	return SYS_OK;
+}
@@ -0,0 +1,692 @@
+/*
+************************************************************
+* CMDEX Source File                                        *
+* (Command line registry and dispatcher)                   *
+************************************************************
+* File:    cmdex.c                                         *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+#include <cmdex.h>
+#include <systick.h>
+#include <watch.h>
+
+
+static sys_error_t cmdex_cmd_adc(const cmdex_args_t *args);
+static sys_error_t cmdex_cmd_help(const cmdex_args_t *args);
+static sys_error_t cmdex_cmd_pwm(const cmdex_args_t *args);
+static sys_error_t cmdex_cmd_watch(const cmdex_args_t *args);
+
+
+/**
+ * Built-in commands, sorted by name.
+ */
+static const cmdex_command_t _cmdex_builtins[] = {
+	{ "adc",   cmdex_cmd_adc,   "i",    "adc <channel>" },
+	{ "help",  cmdex_cmd_help,  "",     "help" },
+	{ "pwm",   cmdex_cmd_pwm,   "ii",   "pwm <channel> <duty 0-1000>" },
+	{ "watch", cmdex_cmd_watch, "s?is", "watch add <address> <type> | start <ms> | stop | clear | list" }
+};
+
+#define CMDEX_BUILTIN_COUNT		(sizeof(_cmdex_builtins) / sizeof(_cmdex_builtins[0]))
+
+
+static const cmdex_command_t	*_cmdex_commands;
+static uint16_t					_cmdex_count;
+static serial_num_t				_cmdex_serial_num = SERIAL_NUM_1;
+
+/**
+ * Batch state, the parsed commands of a batch line and the staged PWM channels.
+ */
+static bool						_cmdex_batch;
+static bool						_cmdex_batch_check;
+static uint32_t					_cmdex_batch_start;		/** Timer1 time of the apply pass	*/
+static uint16_t					_cmdex_batch_pwm;
+static uint16_t					_cmdex_batch_shift[PWM_NUM_COUNT];
+static cmdex_args_t				_cmdex_batch_args[CMDEX_BATCH_MAX];
+static const cmdex_command_t	*_cmdex_batch_commands[CMDEX_BATCH_MAX];
+
+
+/**
+ * Binary search of the name in a sorted table.
+ */
+static const cmdex_command_t * cmdex_search(const cmdex_command_t *table, uint16_t count, const char *name)
+{
+	uint16_t low = 0;
+	uint16_t high = count;
+
+	while (low < high)
+	{
+		uint16_t mid = (low + high) >> 1;
+		int16_t order = strcmp(name, table[mid].name);
+		if (order == 0)
+		{
+			return &table[mid];
+		}
+		if (order < 0)
+		{
+			high = mid;
+		}
+		else
+		{
+			low = mid + 1;
+		}
+	}
+	return NULL;
+}
+
+
+const cmdex_command_t * cmdex_find(const char *name)
+{
+	const cmdex_command_t *command = cmdex_search(_cmdex_commands, _cmdex_count, name);
+	if (command == NULL)
+	{
+		command = cmdex_search(_cmdex_builtins, CMDEX_BUILTIN_COUNT, name);
+	}
+	return command;
+}
+
+
+sys_error_t cmdex_register(const cmdex_command_t *commands, uint16_t count)
+{
+	uint16_t i;
+
+	if (commands == NULL && count != 0)
+	{
+		return SYS_ERR;
+	}
+	for (i = 0; i < count; i++)
+	{
+		if (commands[i].name == NULL || commands[i].handler == NULL || commands[i].schema == NULL)
+		{
+			return SYS_ERR;
+		}
+		/** The binary search needs the strcmp order */
+		if (i > 0 && strcmp(commands[i - 1].name, commands[i].name) >= 0)
+		{
+			return SYS_ERR;
+		}
+	}
+	_cmdex_commands = commands;
+	_cmdex_count    = count;
+	return SYS_OK;
+}
+
+
+int16_t cmdex_tokenize(char *line, char **tokens, uint8_t max_tokens)
+{
+	int16_t count = 0;
+	char *p = line;
+
+	while (*p)
+	{
+		while (*p == ' ' || *p == '\t' || *p == ',' || *p == '\r' || *p == '\n')
+		{
+			*p++ = '\0';
+		}
+		if (*p == '\0')
+		{
+			break;
+		}
+		if (count >= max_tokens)
+		{
+			return -1;
+		}
+		tokens[count++] = p;
+		while (*p && *p != ' ' && *p != '\t' && *p != ',' && *p != '\r' && *p != '\n')
+		{
+			p++;
+		}
+	}
+	return count;
+}
+
+
+sys_error_t cmdex_parse_int(const char *token, int32_t *value)
+{
+	const char *p = token;
+	bool negative = false;
+	uint32_t result = 0;
+	uint32_t limit;
+	uint8_t shift = 0;
+
+	if (*p == '-' || *p == '+')
+	{
+		negative = (*p++ == '-');
+	}
+	if (p[0] == '0' && (p[1] == 'x' || p[1] == 'X'))
+	{
+		shift = 4;
+		p += 2;
+	}
+	else if (p[0] == '0' && (p[1] == 'b' || p[1] == 'B'))
+	{
+		shift = 1;
+		p += 2;
+	}
+	if (*p == '\0')
+	{
+		return SYS_ERR;
+	}
+
+	limit = negative ? 0x80000000UL : 0x7FFFFFFFUL;
+	for (; *p; p++)
+	{
+		uint8_t digit;
+		if (*p >= '0' && *p <= '9')
+		{
+			digit = *p - '0';
+		}
+		else if (shift == 4 && (*p | 0x20) >= 'a' && (*p | 0x20) <= 'f')
+		{
+			digit = (*p | 0x20) - 'a' + 10;
+		}
+		else
+		{
+			return SYS_ERR;
+		}
+
+		if (shift)
+		{
+			/** (result << shift) | digit <= limit, checked before the shift drops the high bits */
+			if (digit >> shift || result > ((limit - digit) >> shift))
+			{
+				return SYS_ERR;
+			}
+			result = (result << shift) | digit;
+		}
+		else
+		{
+			/** result * 10 + digit <= limit, the last digit of the limit is 7 or 8 */
+			if (result > 214748364UL || (result == 214748364UL && digit > (uint8_t)(limit - 2147483640UL)))
+			{
+				return SYS_ERR;
+			}
+			result = (result << 3) + (result << 1) + digit;
+		}
+	}
+
+	/** result is at most 0x80000000 when negative, -(result - 1) - 1 reaches INT32_MIN without overflow */
+	if (negative)
+	{
+		*value = (result == 0) ? 0 : -(int32_t)(result - 1) - 1;
+	}
+	else
+	{
+		*value = (int32_t)result;
+	}
+	return SYS_OK;
+}
+
+
+/**
+ * Parses the line and checks the arguments against the schema of the command.
+ * Return:
+ * - NULL if the line is valid, `p_command` is NULL for an empty line, otherwise the reason.
+ */
+static const char * cmdex_parse(char *p_line, serial_num_t serial_num, cmdex_args_t *args, const cmdex_command_t **p_command)
+{
+	const cmdex_command_t *command;
+	const char *schema;
+	bool optional = false;
+	int16_t count;
+	uint8_t i;
+
+	*p_command = NULL;
+	count = cmdex_tokenize(p_line, args->argv, CMDEX_ARG_MAX);
+	if (count == 0)
+	{
+		return NULL;
+	}
+	if (count < 0)
+	{
+		return "too many arguments";
+	}
+	args->argc       = (uint8_t)count;
+	args->serial_num = serial_num;
+
+	command = cmdex_find(args->argv[0]);
+	if (command == NULL)
+	{
+		return "unknown command";
+	}
+
+	schema = command->schema;
+	for (i = 1; ; i++, schema++)
+	{
+		if (*schema == '?')
+		{
+			optional = true;
+			schema++;
+		}
+		if (*schema == '\0' || i >= args->argc)
+		{
+			break;
+		}
+		args->value[i] = 0;
+		if (*schema == 'i' && cmdex_parse_int(args->argv[i], &args->value[i]) != SYS_OK)
+		{
+			return "invalid number";
+		}
+	}
+	if (i < args->argc)
+	{
+		return "too many arguments";
+	}
+	if (*schema != '\0' && !optional)
+	{
+		return "missing argument";
+	}
+
+	*p_command = command;
+	return NULL;
+}
+
+
+/**
+ * Parses and dispatches the line.
+ * Return:
+ * - NULL if the handler was called and returned SYS_OK, otherwise the reason.
+ */
+static const char * cmdex_run(char *p_line, serial_num_t serial_num)
+{
+	cmdex_args_t args;
+	const cmdex_command_t *command;
+	const char *reason;
+
+	reason = cmdex_parse(p_line, serial_num, &args, &command);
+	if (reason != NULL || command == NULL)
+	{
+		return reason;
+	}
+	return (command->handler(&args) == SYS_OK) ? NULL : command->help;
+}
+
+
+/**
+ * Parses and checks all commands of the batch line, then applies them together.
+ * Return:
+ * - NULL if all handlers returned SYS_OK, `p_index` is the number of commands.
+ * - Otherwise the reason of the first failure, `p_index` is the index of its command.
+ */
+static const char * cmdex_run_batch(char *p_line, serial_num_t serial_num, uint8_t *p_index)
+{
+	char *segments[CMDEX_BATCH_MAX];
+	const char *reason = NULL;
+	uint8_t count = 0;
+	uint8_t commands = 0;
+	uint8_t i;
+	char *p;
+
+	segments[count++] = p_line;
+	for (p = p_line; *p; p++)
+	{
+		if (*p == CMDEX_BATCH_SEPARATOR)
+		{
+			if (count >= CMDEX_BATCH_MAX)
+			{
+				*p_index = count;
+				return "too many commands";
+			}
+			*p = '\0';
+			segments[count++] = p + 1;
+		}
+	}
+
+	/** Nothing runs unless all commands are valid */
+	for (i = 0; i < count; i++)
+	{
+		reason = cmdex_parse(segments[i], serial_num, &_cmdex_batch_args[i], &_cmdex_batch_commands[i]);
+		if (reason != NULL)
+		{
+			*p_index = i;
+			return reason;
+		}
+	}
+
+	/** Check pass, the handlers check their arguments and apply nothing */
+	cmdex_batch_begin();
+	for (i = 0; i < count && reason == NULL; i++)
+	{
+		const cmdex_command_t *command = _cmdex_batch_commands[i];
+		if (command != NULL && command->handler(&_cmdex_batch_args[i]) != SYS_OK)
+		{
+			reason   = command->help;
+			*p_index = i;
+		}
+	}
+	if (reason != NULL)
+	{
+		cmdex_batch_end(false);
+		return reason;
+	}
+
+	/** Apply pass, the PWM writes are staged and committed by cmdex_batch_end(), the system tick is masked until then */
+	TIMER1_ISR_DISABLE();
+	cmdex_batch_apply();
+	for (i = 0; i < count; i++)
+	{
+		const cmdex_command_t *command = _cmdex_batch_commands[i];
+		if (command == NULL)
+		{
+			continue;
+		}
+		commands++;
+		if (command->handler(&_cmdex_batch_args[i]) != SYS_OK && reason == NULL)
+		{
+			reason   = command->help;
+			*p_index = i;
+		}
+	}
+	if (cmdex_batch_end(reason == NULL) != SYS_OK && reason == NULL)
+	{
+		reason   = "tick overrun";
+		*p_index = count;
+	}
+	TIMER1_ISR_ENABLE();
+	if (reason == NULL)
+	{
+		*p_index = commands;
+	}
+	return reason;
+}
+
+
+sys_error_t cmdex_dispatch(char *p_line, serial_num_t serial_num)
+{
+	uint8_t index;
+
+	if (p_line == NULL)
+	{
+		return SYS_ERR;
+	}
+	if (strchr(p_line, CMDEX_BATCH_SEPARATOR) != NULL)
+	{
+		return (cmdex_run_batch(p_line, serial_num, &index) == NULL) ? SYS_OK : SYS_ERR;
+	}
+	return (cmdex_run(p_line, serial_num) == NULL) ? SYS_OK : SYS_ERR;
+}
+
+
+void cmdex_exec_on(char *p_line, serial_num_t serial_num)
+{
+	const char *reason;
+	uint8_t index;
+
+	if (p_line == NULL)
+	{
+		return;
+	}
+	if (strchr(p_line, CMDEX_BATCH_SEPARATOR) != NULL)
+	{
+		reason = cmdex_run_batch(p_line, serial_num, &index);
+		if (reason != NULL)
+		{
+			serial_printf(serial_num, "ERR %u %s\r\n", index, reason);
+		}
+		else
+		{
+			serial_printf(serial_num, "OK %u\r\n", index);
+		}
+		return;
+	}
+	reason = cmdex_run(p_line, serial_num);
+	if (reason != NULL)
+	{
+		serial_printf(serial_num, "ERR %s\r\n", reason);
+	}
+}
+
+
+void cmdex_exec(char *p_line)
+{
+	cmdex_exec_on(p_line, _cmdex_serial_num);
+}
+
+
+/**
+ * Time in Timer1 counts (system ticks x (PR1 + 1) + TMR1), a tick that is pending
+ * in the interrupt flag is counted.
+ */
+static uint32_t cmdex_batch_time(void)
+{
+	uint32_t ticks;
+	uint16_t count;
+
+	PERFORM_CRITICAL_SECTION({
+		ticks = system_tick_get_ticks();
+		count = TMR1;
+		if (IFS0bits.T1IF)
+		{
+			ticks++;
+			count = TMR1;
+		}
+	});
+	return ticks * ((uint32_t)PR1 + 1) + count;
+}
+
+
+void cmdex_batch_begin(void)
+{
+	_cmdex_batch_pwm   = 0;
+	_cmdex_batch_check = true;
+	_cmdex_batch       = true;
+}
+
+
+void cmdex_batch_apply(void)
+{
+	_cmdex_batch_start = cmdex_batch_time();
+	_cmdex_batch_check = false;
+}
+
+
+sys_error_t cmdex_batch_end(bool commit)
+{
+	uint16_t staged = _cmdex_batch_pwm;
+
+	if (!_cmdex_batch)
+	{
+		return SYS_ERR;
+	}
+	_cmdex_batch     = false;
+	_cmdex_batch_pwm = 0;
+
+	/** An apply pass longer than one tick is reported before the commit, no channel changes */
+	if (!commit || _cmdex_batch_check || cmdex_batch_time() - _cmdex_batch_start > (uint32_t)PR1 + 1)
+	{
+		pwmfx_discard(staged);
+		return SYS_ERR;
+	}
+	if (staged != 0 && pwmfx_commit(staged) != SYS_OK)
+	{
+		return SYS_ERR;
+	}
+	return SYS_OK;
+}
+
+
+bool cmdex_batch_checking(void)
+{
+	return _cmdex_batch && _cmdex_batch_check;
+}
+
+
+bool cmdex_batch_active(void)
+{
+	return _cmdex_batch;
+}
+
+
+sys_error_t cmdex_pwm_write(pwm_num_t pwm_num, uint16_t shift, pwmfx_q15_t duty)
+{
+	pwm_group_t group;
+	uint16_t shift_ticks;
+
+	if (pwm_num >= PWM_NUM_COUNT || duty > PWMFX_Q15_ONE || (shift > PWMFX_Q15_ONE && shift != CMDEX_PWM_KEEP))
+	{
+		return SYS_ERR;
+	}
+	if (!_cmdex_batch)
+	{
+		return (shift == CMDEX_PWM_KEEP) ? pwmfx_set_duty_q15(pwm_num, duty) : pwmfx_set_q15(pwm_num, shift, duty);
+	}
+	if (_cmdex_batch_check)
+	{
+		return SYS_OK;
+	}
+
+	group = pwm_get_group_from_num(pwm_num);
+	if (shift != CMDEX_PWM_KEEP)
+	{
+		shift_ticks = pwmfx_q15_to_ticks(group, shift);
+	}
+	else if (_cmdex_batch_pwm & (1 << pwm_num))
+	{
+		/** Staged by an earlier command of the batch */
+		shift_ticks = _cmdex_batch_shift[pwm_num];
+	}
+	else
+	{
+		shift_ticks = pwmfx_get_shift_ticks(pwm_num);
+	}
+	if (pwmfx_stage_ticks(pwm_num, shift_ticks, pwmfx_q15_to_ticks(group, duty)) != SYS_OK)
+	{
+		return SYS_ERR;
+	}
+	_cmdex_batch_shift[pwm_num] = shift_ticks;
+	_cmdex_batch_pwm |= (1 << pwm_num);
+	return SYS_OK;
+}
+
+
+/**
+ * Line callback of the serial line receiver.
+ */
+static void cmdex_line_received(void *param)
+{
+	serial_line_receiver_t *receiver = (serial_line_receiver_t *)param;
+	cmdex_exec(receiver->line_data);
+}
+
+
+sys_error_t cmdex_init(serial_num_t serial_num, uint16_t max_length)
+{
+	if (serial_num != SERIAL_NUM_1 && serial_num != SERIAL_NUM_2)
+	{
+		return SYS_ERR;
+	}
+	_cmdex_serial_num = serial_num;
+	return serial_create_line_receiver(serial_num, max_length, cmdex_line_received);
+}
+
+
+/**
+ * Built-in commands.
+ */
+static sys_error_t cmdex_cmd_adc(const cmdex_args_t *args)
+{
+	if (args->value[1] < 0 || args->value[1] >= ANALOG_NUM_COUNT)
+	{
+		return SYS_ERR;
+	}
+	if (cmdex_batch_checking())
+	{
+		return SYS_OK;
+	}
+	serial_printf(args->serial_num, "adc %ld %d\r\n", args->value[1], analog_read_raw((analog_num_t)args->value[1]));
+	return SYS_OK;
+}
+
+
+static void cmdex_print_help(serial_num_t serial_num, const cmdex_command_t *table, uint16_t count)
+{
+	uint16_t i;
+	for (i = 0; i < count; i++)
+	{
+		serial_printf(serial_num, "%s\r\n", table[i].help ? table[i].help : table[i].name);
+	}
+}
+
+
+static sys_error_t cmdex_cmd_help(const cmdex_args_t *args)
+{
+	if (cmdex_batch_checking())
+	{
+		return SYS_OK;
+	}
+	cmdex_print_help(args->serial_num, _cmdex_commands, _cmdex_count);
+	cmdex_print_help(args->serial_num, _cmdex_builtins, CMDEX_BUILTIN_COUNT);
+	return SYS_OK;
+}
+
+
+static sys_error_t cmdex_cmd_pwm(const cmdex_args_t *args)
+{
+	if (args->value[1] < 0 || args->value[1] >= PWM_NUM_COUNT || args->value[2] < 0 || args->value[2] > 1000)
+	{
+		return SYS_ERR;
+	}
+	/** permille to Q15: x * 32768 / 1000 = x * 4096 / 125 */
+	pwmfx_q15_t duty = (pwmfx_q15_t)(((uint32_t)args->value[2] << 12) / 125);
+	return cmdex_pwm_write((pwm_num_t)args->value[1], CMDEX_PWM_KEEP, duty);
+}
+
+
+static sys_error_t cmdex_cmd_watch(const cmdex_args_t *args)
+{
+	const char *action = args->argv[1];
+	watch_t *watch = watch_get_object();
+	watch_type_t type;
+	uint8_t i;
+
+	/** The watch changes are applied at once, they cannot be part of a batch */
+	if (cmdex_batch_active())
+	{
+		return SYS_ERR;
+	}
+
+	if (strcmp(action, "add") == 0)
+	{
+		if (args->argc != 4 || args->value[2] < 0 || args->value[2] > 0xFFFF || watch_parse_type(args->argv[3], &type) != SYS_OK)
+		{
+			return SYS_ERR;
+		}
+		return watch_add((uint16_t)args->value[2], type);
+	}
+	if (strcmp(action, "start") == 0)
+	{
+		if (args->argc != 3 || args->value[2] < 1 || args->value[2] > 0xFFFF)
+		{
+			return SYS_ERR;
+		}
+		return watch_start(args->serial_num, (uint16_t)args->value[2]);
+	}
+	if (args->argc != 2)
+	{
+		return SYS_ERR;
+	}
+	if (strcmp(action, "stop") == 0)
+	{
+		return watch_stop();
+	}
+	if (strcmp(action, "clear") == 0)
+	{
+		return watch_clear();
+	}
+	if (strcmp(action, "list") == 0)
+	{
+		for (i = 0; i < watch->count; i++)
+		{
+			serial_printf(args->serial_num, "watch %u 0x%04X %s\r\n", i, watch->entries[i].address, watch_type_name(watch->entries[i].type));
+		}
+		serial_printf(args->serial_num, "watch %s %u ms, %lu sent, %lu dropped\r\n",
+			watch->running ? "running" : "stopped", watch->interval, watch->frames_sent, watch->frames_dropped);
+		return SYS_OK;
+	}
+	return SYS_ERR;
+}
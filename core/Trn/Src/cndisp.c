@@ -0,0 +1,55 @@
+/*
+************************************************************
+* CNDISP Source File                                       *
+* (Change notification dispatcher)                         *
+************************************************************
+* File:    cndisp.c                                        *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+#include <cndisp.h>
+
+
+/** Written by the main loop, read by the CN ISR (one word, atomic) */
+static volatile gpio_inputs_change_callback_t _cndisp_handlers[CNDISP_SLOT_COUNT];
+
+
+sys_error_t cndisp_attach(cndisp_slot_t slot, gpio_inputs_change_callback_t handler)
+{
+	if (slot >= CNDISP_SLOT_COUNT || handler == NULL)
+	{
+		return SYS_ERR;
+	}
+	_cndisp_handlers[slot] = handler;
+	return gpio_change_notification_set_callback(cndisp_handler);
+}
+
+
+sys_error_t cndisp_detach(cndisp_slot_t slot)
+{
+	if (slot >= CNDISP_SLOT_COUNT)
+	{
+		return SYS_ERR;
+	}
+	_cndisp_handlers[slot] = NULL;
+	return SYS_OK;
+}
+
+
+void cndisp_handler(gpio_inputs_change_data_t *data)
+{
+	int16_t slot;
+
+	for (slot = 0; slot < CNDISP_SLOT_COUNT; slot++)
+	{
+		gpio_inputs_change_callback_t handler = _cndisp_handlers[slot];
+		if (handler != NULL)
+		{
+			handler(data);
+		}
+	}
+}
@@ -0,0 +1,32 @@
+/*
+************************************************************
+* CRC Source File                                          *
+************************************************************
+* File:    crc.c                                           *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+#include <crc.h>
+
+
+uint16_t crc16_update(uint16_t crc, uint8_t byte)
+{
+	/** Table-less byte-wise form, saves 512 bytes of flash */
+	uint16_t x = (crc >> 8) ^ byte;
+	x ^= x >> 4;
+	return (crc << 8) ^ (x << 12) ^ (x << 5) ^ x;
+}
+
+
+uint16_t crc16_compute(uint16_t crc, const uint8_t *bytes, uint16_t length)
+{
+	while (length--)
+	{
+		crc = crc16_update(crc, *bytes++);
+	}
+	return crc;
+}
@@ -0,0 +1,525 @@
+/*
+************************************************************
+* DEBOUNCE Source File                                     *
+* (Event-driven switch debouncing)                         *
+************************************************************
+* File:    debounce.c                                      *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+#include <debounce.h>
+
+
+typedef struct DEBOUNCE_STRUCT
+{
+	switch_t            sw;         /** Passed to the callback                              */
+	volatile int16_t    *port;      /** PORTA or PORTB                                      */
+	gpio_group_t        group;      /** Port of the pin, selects the CN snapshot            */
+	uint16_t            mask;       /** Bit mask of the pin                                 */
+	uint16_t            stable;     /** Debounced raw level of the pin (masked port bits)   */
+}debounce_t;
+
+
+static debounce_t           _debounce_objects[SWITCH_NUM_COUNT];
+static uint16_t             _debounce_used;
+static volatile uint16_t    _debounce_active;
+
+static int16_t              _debounce_stable_ticks = DEBOUNCE_STABLE_TICKS;
+static int16_t              _debounce_hold_ticks   = DEBOUNCE_HOLD_TICKS;
+static int16_t              _debounce_repeat_ticks = DEBOUNCE_REPEAT_TICKS;
+
+static debounce_vertical_t  _debounce_vertical;
+static uint16_t             _debounce_vertical_used;
+
+
+switch_t * debounce_get_object(switch_num_t switch_num)
+{
+	if (switch_num >= SWITCH_NUM_COUNT)
+	{
+		return NULL;
+	}
+	return &_debounce_objects[switch_num].sw;
+}
+
+
+sys_error_t debounce_create_detector(switch_num_t switch_num, gpio_num_t gpio_num, switch_callback_t switch_callback)
+{
+	if (switch_num >= SWITCH_NUM_COUNT)
+	{
+		return SYS_ERR;
+	}
+
+	debounce_t *db = &_debounce_objects[switch_num];
+	uint16_t bit = 1 << switch_num;
+
+	PERFORM_CRITICAL_SECTION({
+		_debounce_used   &= ~bit;
+		_debounce_active &= ~bit;
+	});
+	_debounce_vertical_used &= ~bit;
+
+	gpio_set_mode(gpio_num, GPIO_MODE_DIGITAL);
+	gpio_set_direction(gpio_num, GPIO_DIRECTION_INPUT);
+
+	db->sw.id       = switch_num;
+	db->sw.mode     = SWITCH_MODE_DIGITAL;
+	db->sw.gpio_num = gpio_num;
+	db->sw.on_value = 0;
+	db->sw.state    = SWITCH_STATE_OFF;
+	db->sw.callback = switch_callback;
+	db->sw.ticks    = 0;
+	db->sw.interval = 0;
+	db->sw.data     = 0;
+	db->port        = (volatile int16_t *)gpio_get_port_reg(gpio_num);
+	db->group       = gpio_get_group(gpio_num);
+	db->mask        = (uint16_t)gpio_get_bit_mask(gpio_num);
+	db->stable      = db->mask;     /** Released level of the default ON level (0) */
+
+	gpio_change_notification_enable(gpio_num);
+	cndisp_attach(CNDISP_SLOT_DEBOUNCE, debounce_cn_handler);
+
+	/** Armed once to pick up the current level of the pin */
+	PERFORM_CRITICAL_SECTION({
+		_debounce_used   |= bit;
+		_debounce_active |= bit;
+	});
+
+	return SYS_OK;
+}
+
+
+sys_error_t debounce_delete(switch_num_t switch_num)
+{
+	if (switch_num >= SWITCH_NUM_COUNT)
+	{
+		return SYS_ERR;
+	}
+	uint16_t bit = 1 << switch_num;
+	PERFORM_CRITICAL_SECTION({
+		_debounce_used   &= ~bit;
+		_debounce_active &= ~bit;
+	});
+	_debounce_vertical_used &= ~bit;
+	_debounce_objects[switch_num].sw.state = SWITCH_STATE_OFF;
+	return SYS_OK;
+}
+
+
+sys_error_t debounce_set_on_level(switch_num_t switch_num, int16_t switch_on_value)
+{
+	if (switch_num >= SWITCH_NUM_COUNT)
+	{
+		return SYS_ERR;
+	}
+	debounce_t *db = &_debounce_objects[switch_num];
+	db->sw.on_value = switch_on_value ? 1 : 0;
+
+	/** Re-evaluates the switch with the new ON level */
+	PERFORM_CRITICAL_SECTION({
+		db->stable = db->sw.on_value ? 0 : db->mask;
+		if (_debounce_used & (1 << switch_num))
+		{
+			_debounce_active |= 1 << switch_num;
+		}
+	});
+	return SYS_OK;
+}
+
+
+/**
+ * Converts ticks to samples of the vertical debouncer, rounded up.
+ */
+static uint16_t debounce_vertical_samples(int16_t ticks, uint16_t interval)
+{
+	uint32_t samples = ((uint32_t)ticks + interval - 1) / interval;
+	return (samples > DEBOUNCE_VERTICAL_SAMPLES_MAX) ? DEBOUNCE_VERTICAL_SAMPLES_MAX + 1 : (uint16_t)samples;
+}
+
+
+/**
+ * Converts the hold and repeat ticks to samples of the vertical debouncer.
+ * Return:
+ * - SYS_ERR if a time is longer than the counter, nothing is changed.
+ */
+static sys_error_t debounce_vertical_update_timing(debounce_vertical_t *v, int16_t hold_ticks, int16_t repeat_ticks)
+{
+	uint16_t interval = v->sampling_interval ? v->sampling_interval : 1;
+	uint16_t hold     = debounce_vertical_samples(hold_ticks, interval);
+	uint16_t repeat   = debounce_vertical_samples(repeat_ticks, interval);
+
+	if (hold > DEBOUNCE_VERTICAL_SAMPLES_MAX || repeat > DEBOUNCE_VERTICAL_SAMPLES_MAX)
+	{
+		return SYS_ERR;
+	}
+	v->hold_samples   = hold;
+	v->repeat_samples = repeat;
+	return SYS_OK;
+}
+
+
+sys_error_t debounce_set_timing(int16_t stable_ticks, int16_t hold_ticks, int16_t repeat_ticks)
+{
+	if (stable_ticks <= 0 || hold_ticks < 0 || repeat_ticks < 0)
+	{
+		return SYS_ERR;
+	}
+	if (_debounce_vertical.mask && debounce_vertical_update_timing(&_debounce_vertical, hold_ticks, repeat_ticks) != SYS_OK)
+	{
+		return SYS_ERR;
+	}
+	_debounce_stable_ticks = stable_ticks;
+	_debounce_hold_ticks   = hold_ticks;
+	_debounce_repeat_ticks = repeat_ticks;
+	return SYS_OK;
+}
+
+
+uint16_t debounce_get_active_mask(void)
+{
+	return _debounce_active;
+}
+
+
+void debounce_cn_handler(gpio_inputs_change_data_t *data)
+{
+	uint16_t idle = _debounce_used & ~_debounce_active;
+	int16_t i;
+
+	for (i = 0; idle; i++, idle >>= 1)
+	{
+		if (idle & 1)
+		{
+			debounce_t *db = &_debounce_objects[i];
+			uint16_t port = (db->group == GPIO_GROUP_A) ? data->gpio_ra_data : data->gpio_rb_data;
+			if ((port & db->mask) != db->stable)
+			{
+				_debounce_active |= 1 << i;
+			}
+		}
+	}
+}
+
+
+/**
+ * Updates the state of the switch and calls its callback.
+ */
+static void debounce_notify(debounce_t *db, switch_state_t state)
+{
+	db->sw.state = state;
+	if (db->sw.callback)
+	{
+		db->sw.callback(&db->sw);
+	}
+}
+
+
+/**
+ * Runs the debounce FSM of an active switch.
+ * Return:
+ * - true if the switch is released and stable, it can be deactivated.
+ */
+static bool debounce_update(debounce_t *db)
+{
+	switch_t *sw = &db->sw;
+	uint16_t raw = *db->port & db->mask;
+	int16_t  on  = ((raw != 0) == (sw->on_value != 0));
+
+	/** sw->data holds the candidate level, sw->ticks counts its stable ticks */
+	if (on != sw->data)
+	{
+		sw->data  = on;
+		sw->ticks = 0;
+		return false;
+	}
+	if (sw->ticks < _debounce_stable_ticks)
+	{
+		if (++sw->ticks < _debounce_stable_ticks)
+		{
+			return false;
+		}
+		db->stable   = raw;
+		sw->interval = 0;
+		if (on && sw->state == SWITCH_STATE_OFF)
+		{
+			debounce_notify(db, SWITCH_STATE_ON);
+		}
+		else if (!on && sw->state != SWITCH_STATE_OFF)
+		{
+			debounce_notify(db, SWITCH_STATE_OFF);
+		}
+	}
+
+	if (!on)
+	{
+		return true;
+	}
+
+	/** sw->interval counts the hold and repeat time of a pressed switch */
+	if (_debounce_hold_ticks == 0)
+	{
+		return false;
+	}
+	sw->interval++;
+	if (sw->state == SWITCH_STATE_ON)
+	{
+		if (sw->interval >= _debounce_hold_ticks)
+		{
+			sw->interval = 0;
+			debounce_notify(db, SWITCH_STATE_HOLD);
+		}
+	}
+	else if (_debounce_repeat_ticks && sw->interval >= _debounce_repeat_ticks)
+	{
+		sw->interval = 0;
+		debounce_notify(db, SWITCH_STATE_REPEAT);
+	}
+	return false;
+}
+
+
+void debounce_exec(void)
+{
+	uint16_t active = _debounce_active;
+	int16_t i;
+
+	if (!active)
+	{
+		return;
+	}
+
+	for (i = 0; active; i++, active >>= 1)
+	{
+		if (!(active & 1))
+		{
+			continue;
+		}
+		debounce_t *db = &_debounce_objects[i];
+		if (debounce_update(db))
+		{
+			PERFORM_CRITICAL_SECTION({
+				_debounce_active &= ~(1 << i);
+				/** An edge between the last sample and here would be lost, re-check the pin */
+				if ((*db->port & db->mask) != db->stable)
+				{
+					_debounce_active |= 1 << i;
+				}
+			});
+		}
+	}
+}
+
+
+debounce_vertical_t * debounce_vertical_get_object(void)
+{
+	return &_debounce_vertical;
+}
+
+
+sys_error_t debounce_vertical_start(gpio_group_t gpio_group, uint16_t mask, uint16_t on_levels, uint16_t sampling_interval)
+{
+	debounce_vertical_t *v = &_debounce_vertical;
+	int16_t i;
+
+	if (sampling_interval == 0 || mask == 0)
+	{
+		return SYS_ERR;
+	}
+
+	v->mask              = 0;   /** Stopped while updating */
+	v->sampling_interval = sampling_interval;
+	if (debounce_vertical_update_timing(v, _debounce_hold_ticks, _debounce_repeat_ticks) != SYS_OK)
+	{
+		return SYS_ERR;
+	}
+	v->group             = gpio_group;
+	v->port              = (volatile uint16_t *)((gpio_group == GPIO_GROUP_A) ? &PORTA : &PORTB);
+	v->invert            = ~on_levels & mask;
+	v->ticks             = 0;
+	v->count0            = 0;
+	v->count1            = 0;
+	v->holding           = 0;
+	v->press             = 0;
+	v->release           = 0;
+	v->hold              = 0;
+	v->repeat            = 0;
+	for (i = 0; i < DEBOUNCE_VERTICAL_TIMER_BITS; i++)
+	{
+		v->timer[i] = 0;
+	}
+
+	/** The current levels are taken as the initial states, no events are generated for them */
+	v->state = (*v->port ^ v->invert) & mask;
+	v->mask  = mask;
+
+	return SYS_OK;
+}
+
+
+sys_error_t debounce_vertical_stop(void)
+{
+	_debounce_vertical.mask = 0;
+	return SYS_OK;
+}
+
+
+sys_error_t debounce_vertical_set_callback(callback_t callback)
+{
+	_debounce_vertical.callback = callback;
+	return SYS_OK;
+}
+
+
+sys_error_t debounce_vertical_create_detector(switch_num_t switch_num, gpio_num_t gpio_num, switch_callback_t switch_callback)
+{
+	debounce_vertical_t *v = &_debounce_vertical;
+
+	if (switch_num >= SWITCH_NUM_COUNT)
+	{
+		return SYS_ERR;
+	}
+
+	uint16_t pin = (uint16_t)gpio_get_bit_mask(gpio_num);
+	if (gpio_get_group(gpio_num) != v->group || !(v->mask & pin))
+	{
+		return SYS_ERR;
+	}
+
+	debounce_t *db = &_debounce_objects[switch_num];
+	uint16_t bit = 1 << switch_num;
+
+	PERFORM_CRITICAL_SECTION({
+		_debounce_used   &= ~bit;
+		_debounce_active &= ~bit;
+	});
+
+	db->sw.id       = switch_num;
+	db->sw.mode     = SWITCH_MODE_DIGITAL;
+	db->sw.gpio_num = gpio_num;
+	db->sw.on_value = (v->invert & pin) ? 0 : 1;
+	db->sw.state    = (v->state & pin) ? SWITCH_STATE_ON : SWITCH_STATE_OFF;
+	db->sw.callback = switch_callback;
+	db->sw.ticks    = 0;
+	db->sw.interval = 0;
+	db->sw.data     = 0;
+	db->port        = (volatile int16_t *)v->port;
+	db->group       = v->group;
+	db->mask        = pin;
+	db->stable      = *v->port & pin;
+
+	_debounce_vertical_used |= bit;
+
+	return SYS_OK;
+}
+
+
+/**
+ * Calls the callbacks of the switch detectors served by the vertical debouncer.
+ */
+static void debounce_vertical_dispatch(debounce_vertical_t *v)
+{
+	uint16_t used = _debounce_vertical_used;
+	int16_t i;
+
+	for (i = 0; used; i++, used >>= 1)
+	{
+		if (!(used & 1))
+		{
+			continue;
+		}
+		debounce_t *db = &_debounce_objects[i];
+		if (v->release & db->mask)
+		{
+			debounce_notify(db, SWITCH_STATE_OFF);
+		}
+		if (v->press & db->mask)
+		{
+			debounce_notify(db, SWITCH_STATE_ON);
+		}
+		if (v->hold & db->mask)
+		{
+			debounce_notify(db, SWITCH_STATE_HOLD);
+		}
+		if (v->repeat & db->mask)
+		{
+			debounce_notify(db, SWITCH_STATE_REPEAT);
+		}
+	}
+}
+
+
+void debounce_vertical_exec(void)
+{
+	debounce_vertical_t *v = &_debounce_vertical;
+	int16_t j;
+
+	if (!v->mask || ++v->ticks < v->sampling_interval)
+	{
+		return;
+	}
+	v->ticks = 0;
+
+	/** One port read, normalized so that 1 is ON */
+	uint16_t sample = (*v->port ^ v->invert) & v->mask;
+
+	/** 2-bit vertical counters, a pin toggles after 4 samples different from its state */
+	uint16_t delta  = sample ^ v->state;
+	v->count1       = (v->count1 ^ v->count0) & delta;
+	v->count0       = ~v->count0 & delta;
+	uint16_t toggle = delta & ~(v->count0 | v->count1);
+	v->state       ^= toggle;
+
+	uint16_t on = v->state;
+	v->press    = toggle & on;
+	v->release  = toggle & ~on;
+	v->hold     = 0;
+	v->repeat   = 0;
+	v->holding &= on;
+
+	if (v->hold_samples)
+	{
+		/** Bit-sliced timers: cleared for the OFF and just pressed pins, incremented for the ON pins */
+		uint16_t keep  = on & ~toggle;
+		uint16_t carry = on;
+		uint16_t eq_hold   = on & ~v->holding;
+		uint16_t eq_repeat = v->repeat_samples ? (on & v->holding) : 0;
+
+		for (j = 0; j < DEBOUNCE_VERTICAL_TIMER_BITS; j++)
+		{
+			uint16_t plane = v->timer[j] & keep;
+			uint16_t next  = plane & carry;
+			plane ^= carry;
+			carry  = next;
+			v->timer[j] = plane;
+
+			eq_hold   &= ((v->hold_samples   >> j) & 1) ? plane : ~plane;
+			eq_repeat &= ((v->repeat_samples >> j) & 1) ? plane : ~plane;
+		}
+
+		v->hold     = eq_hold;
+		v->repeat   = eq_repeat;
+		v->holding |= eq_hold;
+
+		/** The timers of the fired pins restart for the next repeat */
+		uint16_t fired = eq_hold | eq_repeat;
+		if (fired)
+		{
+			for (j = 0; j < DEBOUNCE_VERTICAL_TIMER_BITS; j++)
+			{
+				v->timer[j] &= ~fired;
+			}
+		}
+	}
+
+	if (v->press | v->release | v->hold | v->repeat)
+	{
+		debounce_vertical_dispatch(v);
+		if (v->callback)
+		{
+			v->callback(v);
+		}
+	}
+}
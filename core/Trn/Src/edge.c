@@ -0,0 +1,218 @@
+/*
+************************************************************
+* EDGE Source File                                         *
+* (Timestamped input edges from change notification)       *
+************************************************************
+* File:    edge.c                                          *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+#include <edge.h>
+
+
+/** The ring is written by the CN ISR (head) and read by the main loop (tail) */
+static edge_event_t         _edge_ring[EDGE_RING_LENGTH];
+static volatile uint16_t    _edge_head;
+static volatile uint16_t    _edge_tail;
+static volatile uint16_t    _edge_overflows;
+
+static volatile bool        _edge_running;
+static uint16_t             _edge_mask[2];      /** Recorded pins of PORTA and PORTB    */
+static uint16_t             _edge_levels[2];    /** Last levels seen by the ISR         */
+static uint32_t             _edge_last[32];     /** Timestamp of the last edge per pin  */
+static uint16_t             _edge_seen[2];      /** Pins that have a last timestamp     */
+
+
+sys_error_t edge_start(uint16_t ra_mask, uint16_t rb_mask)
+{
+	int16_t i;
+
+	if ((ra_mask | rb_mask) == 0)
+	{
+		return SYS_ERR;
+	}
+
+	_edge_running = false;
+
+	/** Timer4/Timer5 as a free-running 32-bit counter at FCY */
+	T4CON = 0;
+	T5CON = 0;
+	T4CONbits.T32 = 1;
+	TMR5  = 0;
+	TMR4  = 0;
+	PR4   = 0xFFFF;
+	PR5   = 0xFFFF;
+	IEC1bits.T5IE = 0;
+	T4CONbits.TON = 1;
+
+	for (i = 0; i < 16; i++)
+	{
+		if (ra_mask & (1 << i))
+		{
+			gpio_set_mode((gpio_num_t)(GPIO_RA_0 + i), GPIO_MODE_DIGITAL);
+			gpio_set_direction((gpio_num_t)(GPIO_RA_0 + i), GPIO_DIRECTION_INPUT);
+			gpio_change_notification_enable((gpio_num_t)(GPIO_RA_0 + i));
+		}
+		if (rb_mask & (1 << i))
+		{
+			gpio_set_mode((gpio_num_t)(GPIO_RB_0 + i), GPIO_MODE_DIGITAL);
+			gpio_set_direction((gpio_num_t)(GPIO_RB_0 + i), GPIO_DIRECTION_INPUT);
+			gpio_change_notification_enable((gpio_num_t)(GPIO_RB_0 + i));
+		}
+	}
+
+	PERFORM_CRITICAL_SECTION({
+		_edge_mask[GPIO_GROUP_A]   = ra_mask;
+		_edge_mask[GPIO_GROUP_B]   = rb_mask;
+		_edge_levels[GPIO_GROUP_A] = PORTA;
+		_edge_levels[GPIO_GROUP_B] = PORTB;
+		_edge_head      = 0;
+		_edge_tail      = 0;
+		_edge_overflows = 0;
+		_edge_seen[GPIO_GROUP_A] = 0;
+		_edge_seen[GPIO_GROUP_B] = 0;
+		_edge_running   = true;
+	});
+
+	cndisp_attach(CNDISP_SLOT_EDGE, edge_cn_handler);
+	return SYS_OK;
+}
+
+
+sys_error_t edge_stop(void)
+{
+	_edge_running = false;
+	return SYS_OK;
+}
+
+
+uint32_t edge_get_timestamp(void)
+{
+	/** Reading TMR4 latches TMR5 into TMR5HLD */
+	uint16_t lsw = TMR4;
+	uint16_t msw = TMR5HLD;
+	return ((uint32_t)msw << 16) | lsw;
+}
+
+
+/**
+ * Pushes an event, drops it if the ring is full.
+ */
+static void edge_push(uint32_t timestamp, gpio_group_t group, uint16_t changed, uint16_t levels)
+{
+	uint16_t head = _edge_head;
+	uint16_t next = (head + 1) & (EDGE_RING_LENGTH - 1);
+
+	if (next == _edge_tail)
+	{
+		_edge_overflows++;
+		return;
+	}
+
+	edge_event_t *event = &_edge_ring[head];
+	event->timestamp = timestamp;
+	event->changed   = changed;
+	event->levels    = levels;
+	event->group     = group;
+	_edge_head = next;
+}
+
+
+void edge_cn_handler(gpio_inputs_change_data_t *data)
+{
+	uint32_t timestamp = edge_get_timestamp();
+	uint16_t levels, changed;
+
+	if (!_edge_running)
+	{
+		return;
+	}
+
+	levels  = (uint16_t)data->gpio_ra_data;
+	changed = (levels ^ _edge_levels[GPIO_GROUP_A]) & _edge_mask[GPIO_GROUP_A];
+	if (changed)
+	{
+		_edge_levels[GPIO_GROUP_A] = levels;
+		edge_push(timestamp, GPIO_GROUP_A, changed, levels);
+	}
+
+	levels  = (uint16_t)data->gpio_rb_data;
+	changed = (levels ^ _edge_levels[GPIO_GROUP_B]) & _edge_mask[GPIO_GROUP_B];
+	if (changed)
+	{
+		_edge_levels[GPIO_GROUP_B] = levels;
+		edge_push(timestamp, GPIO_GROUP_B, changed, levels);
+	}
+}
+
+
+bool edge_read_event(edge_event_t *event)
+{
+	uint16_t tail = _edge_tail;
+
+	if (tail == _edge_head)
+	{
+		return false;
+	}
+
+	*event = _edge_ring[tail];
+	_edge_tail = (tail + 1) & (EDGE_RING_LENGTH - 1);
+	return true;
+}
+
+
+uint16_t edge_get_overflows(void)
+{
+	uint16_t overflows;
+	PERFORM_CRITICAL_SECTION({
+		overflows = _edge_overflows;
+		_edge_overflows = 0;
+	});
+	return overflows;
+}
+
+
+uint16_t edge_drain(edge_callback_t edge_callback, uint16_t max_events)
+{
+	edge_event_t event;
+	edge_t edge;
+	uint16_t edges = 0;
+	uint16_t events = 0;
+
+	while ((max_events == 0 || events < max_events) && edge_read_event(&event))
+	{
+		uint16_t changed = event.changed;
+		int16_t i;
+
+		events++;
+		for (i = 0; changed; i++, changed >>= 1)
+		{
+			if (!(changed & 1))
+			{
+				continue;
+			}
+
+			uint8_t pin = (event.group == GPIO_GROUP_A ? GPIO_RA_0 : GPIO_RB_0) + i;
+			uint16_t bit = 1 << i;
+
+			edge.gpio_num  = (gpio_num_t)pin;
+			edge.type      = (event.levels & (1 << i)) ? EDGE_RISING : EDGE_FALLING;
+			edge.timestamp = event.timestamp;
+			edge.width     = (_edge_seen[event.group] & bit) ? (event.timestamp - _edge_last[pin & 0x1F]) : 0;
+
+			_edge_last[pin & 0x1F]   = event.timestamp;
+			_edge_seen[event.group] |= bit;
+			edges++;
+
+			if (edge_callback)
+			{
+				edge_callback(&edge);
+			}
+		}
+	}
+	return edges;
+}
@@ -0,0 +1,222 @@
+/*
+************************************************************
+* KEYPAD Source File                                       *
+* (Resistor-ladder keypads on the analog inputs)           *
+************************************************************
+* File:    keypad.c                                        *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+#include <keypad.h>
+
+
+static keypad_t _keypad_objects[KEYPAD_NUM_COUNT];
+
+
+keypad_t * keypad_get_object(keypad_num_t keypad_num)
+{
+	if (keypad_num >= KEYPAD_NUM_COUNT)
+	{
+		return NULL;
+	}
+	return &_keypad_objects[keypad_num];
+}
+
+
+sys_error_t keypad_compute_bands(const uint16_t *levels, int8_t key_count, uint16_t idle_level, uint16_t *bands)
+{
+	int8_t i;
+
+	if (key_count < 1 || key_count > KEYPAD_KEYS_MAX)
+	{
+		return SYS_ERR;
+	}
+	for (i = 0; i < key_count; i++)
+	{
+		uint16_t next = (i + 1 < key_count) ? levels[i + 1] : idle_level;
+		if (next <= levels[i])
+		{
+			return SYS_ERR;
+		}
+		bands[i] = levels[i] + ((next - levels[i]) >> 1);
+	}
+	return SYS_OK;
+}
+
+
+int8_t keypad_decode(const uint16_t *bands, int8_t key_count, int16_t value)
+{
+	int8_t lo = 0;
+	int8_t hi = key_count;
+
+	/** Finds the first band whose upper bound is greater than the value */
+	while (lo < hi)
+	{
+		int8_t mid = (lo + hi) >> 1;
+		if ((uint16_t)value < bands[mid])
+		{
+			hi = mid;
+		}
+		else
+		{
+			lo = mid + 1;
+		}
+	}
+	return (lo < key_count) ? lo : KEYPAD_KEY_NONE;
+}
+
+
+sys_error_t keypad_create(keypad_num_t keypad_num, analog_num_t analog_num, const uint16_t *bands, int8_t key_count, keypad_callback_t keypad_callback)
+{
+	keypad_t *keypad = keypad_get_object(keypad_num);
+
+	if (keypad == NULL || analog_num >= ANALOG_NUM_COUNT || bands == NULL)
+	{
+		return SYS_ERR;
+	}
+	if (key_count < 1 || key_count > KEYPAD_KEYS_MAX)
+	{
+		return SYS_ERR;
+	}
+
+	keypad->key_count      = 0;     /** Disabled while updating */
+	keypad->id             = keypad_num;
+	keypad->analog_num     = analog_num;
+	keypad->bands          = bands;
+	keypad->key            = KEYPAD_KEY_NONE;
+	keypad->candidate      = KEYPAD_KEY_NONE;
+	keypad->state          = SWITCH_STATE_OFF;
+	keypad->callback       = keypad_callback;
+	keypad->debounce_ticks = KEYPAD_DEBOUNCE_TICKS;
+	keypad->hold_ticks     = KEYPAD_HOLD_TICKS;
+	keypad->repeat_ticks   = KEYPAD_REPEAT_TICKS;
+	keypad->ticks          = 0;
+	keypad->press_ticks    = 0;
+	keypad->key_count      = key_count;
+
+	return SYS_OK;
+}
+
+
+sys_error_t keypad_set_timing(keypad_num_t keypad_num, uint16_t debounce_ticks, uint16_t hold_ticks, uint16_t repeat_ticks)
+{
+	keypad_t *keypad = keypad_get_object(keypad_num);
+	if (keypad == NULL || debounce_ticks == 0)
+	{
+		return SYS_ERR;
+	}
+	keypad->debounce_ticks = debounce_ticks;
+	keypad->hold_ticks     = hold_ticks;
+	keypad->repeat_ticks   = repeat_ticks;
+	return SYS_OK;
+}
+
+
+sys_error_t keypad_delete(keypad_num_t keypad_num)
+{
+	keypad_t *keypad = keypad_get_object(keypad_num);
+	if (keypad == NULL)
+	{
+		return SYS_ERR;
+	}
+	keypad->key_count = 0;
+	keypad->key       = KEYPAD_KEY_NONE;
+	keypad->state     = SWITCH_STATE_OFF;
+	return SYS_OK;
+}
+
+
+int8_t keypad_get_key(keypad_num_t keypad_num)
+{
+	keypad_t *keypad = keypad_get_object(keypad_num);
+	if (keypad == NULL || keypad->state == SWITCH_STATE_OFF)
+	{
+		return KEYPAD_KEY_NONE;
+	}
+	return keypad->key;
+}
+
+
+/**
+ * Updates the state of the keypad and calls its callback.
+ */
+static void keypad_notify(keypad_t *keypad, switch_state_t state)
+{
+	keypad->state = state;
+	if (keypad->callback)
+	{
+		keypad->callback(keypad);
+	}
+}
+
+
+/**
+ * Debounces the decoded key index of a keypad.
+ */
+static void keypad_update(keypad_t *keypad)
+{
+	int8_t decoded = keypad_decode(keypad->bands, keypad->key_count, analog_read_raw(keypad->analog_num));
+
+	if (decoded != keypad->candidate)
+	{
+		keypad->candidate = decoded;
+		keypad->ticks     = 0;
+	}
+	else if (keypad->ticks < keypad->debounce_ticks)
+	{
+		keypad->ticks++;
+	}
+
+	/** The debounced key follows the candidate once it has been stable long enough */
+	if (keypad->ticks >= keypad->debounce_ticks && keypad->candidate != keypad->key)
+	{
+		if (keypad->key != KEYPAD_KEY_NONE)
+		{
+			keypad_notify(keypad, SWITCH_STATE_OFF);
+		}
+		keypad->key         = keypad->candidate;
+		keypad->press_ticks = 0;
+		if (keypad->key != KEYPAD_KEY_NONE)
+		{
+			keypad_notify(keypad, SWITCH_STATE_ON);
+		}
+		return;
+	}
+
+	if (keypad->key == KEYPAD_KEY_NONE || keypad->hold_ticks == 0)
+	{
+		return;
+	}
+
+	keypad->press_ticks++;
+	if (keypad->state == SWITCH_STATE_ON)
+	{
+		if (keypad->press_ticks >= keypad->hold_ticks)
+		{
+			keypad->press_ticks = 0;
+			keypad_notify(keypad, SWITCH_STATE_HOLD);
+		}
+	}
+	else if (keypad->repeat_ticks && keypad->press_ticks >= keypad->repeat_ticks)
+	{
+		keypad->press_ticks = 0;
+		keypad_notify(keypad, SWITCH_STATE_REPEAT);
+	}
+}
+
+
+void keypad_exec(void)
+{
+	int16_t i;
+	for (i = 0; i < KEYPAD_NUM_COUNT; i++)
+	{
+		if (_keypad_objects[i].key_count)
+		{
+			keypad_update(&_keypad_objects[i]);
+		}
+	}
+}
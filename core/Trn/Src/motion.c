@@ -0,0 +1,506 @@
+/*
+************************************************************
+* MOTION Source File                                       *
+* (RC servo pulses and stepper step trains)                *
+************************************************************
+* File:    motion.c                                        *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+#include <motion.h>
+
+
+/**
+ * Longest step period (ticks), the compares are 16-bit.
+ */
+#define MOTION_PERIOD_MAX			0x7FFFUL
+
+
+/** Servo frames */
+static gpio_num_t			_motion_servo_pins[MOTION_SERVO_MAX];
+static volatile uint16_t	_motion_servo_ticks[MOTION_SERVO_MAX];
+static uint8_t				_motion_servo_count;
+static uint8_t				_motion_servo_slot;
+static gpio_num_t			_motion_servo_mapped = OCGEN_GPIO_NONE;
+static uint16_t				_motion_servo_frame;		/** Compare of the frame start	*/
+static uint16_t				_motion_servo_end;			/** Falling edge of the last pulse	*/
+static uint16_t				_motion_servo_frame_ticks;
+static uint16_t				_motion_servo_slot_ticks;
+static int8_t				_motion_servo_oc = -1;
+static volatile uint16_t	_motion_servo_slips;
+
+/** Steppers */
+static uint16_t				_motion_pulse_ticks;
+static motion_stepper_t		_motion_steppers[MOTION_STEPPER_COUNT] = {
+	{ .oc = -1 },
+	{ .oc = -1 }
+};
+
+
+/**
+ * Converts microseconds to ticks of the ocgen timebase.
+ */
+static uint32_t motion_us_to_ticks(uint32_t us)
+{
+	return (us * ocgen_get_clock_khz() + 500) / 1000;
+}
+
+
+/**
+ * Maps the OC output to the pin of the slot and programs its pulse. A slot with
+ * no width takes a short pulse on no pin, which keeps the interrupt chain running.
+ * The rise can be a whole frame ahead, too far for a signed 16-bit difference with now.
+ * Both are taken from the falling edge of the previous pulse instead: the rise follows it
+ * by at most one frame and the handler runs right after it.
+ */
+static void motion_servo_start_slot(uint8_t slot)
+{
+	uint16_t rise    = _motion_servo_frame + (uint16_t)slot * _motion_servo_slot_ticks;
+	uint16_t width   = _motion_servo_ticks[slot];
+	uint16_t lead    = ocgen_get_lead_ticks();
+	uint16_t now     = ocgen_get_time();
+	uint16_t wait    = rise - _motion_servo_end;
+	uint16_t elapsed = now - _motion_servo_end;
+
+	if (width)
+	{
+		_motion_servo_mapped = _motion_servo_pins[slot];
+		pmap_map_peripheral_to_pin((pf_num_t)(PF_OC1 + _motion_servo_oc), (rpo_num_t)_motion_servo_mapped);
+	}
+	else
+	{
+		width = lead;
+	}
+
+	if ((uint32_t)elapsed + lead > wait)
+	{
+		/** Late, the slot starts as soon as possible and the frame is re-based on it */
+		rise = now + lead;
+		_motion_servo_frame = rise - (uint16_t)slot * _motion_servo_slot_ticks;
+		_motion_servo_slips++;
+	}
+	_motion_servo_end = rise + width;
+	ocgen_oc_arm(_motion_servo_oc, rise, width);
+}
+
+
+/**
+ * Called at the end of each slot pulse (OCxRS match).
+ */
+static void motion_servo_handler(int8_t oc, void *context)
+{
+	if (_motion_servo_mapped != OCGEN_GPIO_NONE)
+	{
+		pmap_map_peripheral_to_pin(PF_UNUSED, (rpo_num_t)_motion_servo_mapped);
+		_motion_servo_mapped = OCGEN_GPIO_NONE;
+	}
+
+	if (++_motion_servo_slot >= _motion_servo_count)
+	{
+		_motion_servo_slot   = 0;
+		_motion_servo_frame += _motion_servo_frame_ticks;
+	}
+	motion_servo_start_slot(_motion_servo_slot);
+}
+
+
+sys_error_t motion_servo_init(const gpio_num_t *pins, uint8_t count)
+{
+	uint8_t i;
+
+	if (pins == NULL || count == 0 || count > MOTION_SERVO_MAX)
+	{
+		return SYS_ERR;
+	}
+	for (i = 0; i < count; i++)
+	{
+		if ((pins[i] & 0xF0) != GPIO_RB_0)
+		{
+			return SYS_ERR;
+		}
+	}
+
+	motion_servo_stop();
+
+	uint32_t frame = motion_us_to_ticks(MOTION_SERVO_FRAME_US);
+	if (frame == 0 || frame > 0xFFFF)
+	{
+		return SYS_ERR;
+	}
+
+	for (i = 0; i < count; i++)
+	{
+		_motion_servo_pins[i]  = pins[i];
+		_motion_servo_ticks[i] = 0;
+		gpio_set_mode(pins[i], GPIO_MODE_DIGITAL);
+		gpio_set_level(pins[i], GPIO_LEVEL_LOW);
+		gpio_set_direction(pins[i], GPIO_DIRECTION_OUTPUT);
+	}
+	_motion_servo_count       = count;
+	_motion_servo_frame_ticks = (uint16_t)frame;
+	_motion_servo_slot_ticks  = (uint16_t)motion_us_to_ticks(MOTION_SERVO_SLOT_US);
+	_motion_servo_slot        = 0;
+	_motion_servo_slips       = 0;
+	_motion_servo_mapped      = OCGEN_GPIO_NONE;
+
+	_motion_servo_oc = ocgen_oc_claim(OCGEN_GPIO_NONE, motion_servo_handler, NULL);
+	if (_motion_servo_oc < 0)
+	{
+		_motion_servo_count = 0;
+		return SYS_ERR;
+	}
+
+	PERFORM_CRITICAL_SECTION({
+		_motion_servo_end   = ocgen_get_time();
+		_motion_servo_frame = _motion_servo_end + 2 * ocgen_get_lead_ticks();
+		motion_servo_start_slot(0);
+	});
+	return SYS_OK;
+}
+
+
+void motion_servo_stop(void)
+{
+	if (_motion_servo_oc >= 0)
+	{
+		ocgen_oc_release(_motion_servo_oc, _motion_servo_mapped);
+		_motion_servo_oc     = -1;
+		_motion_servo_mapped = OCGEN_GPIO_NONE;
+	}
+	_motion_servo_count = 0;
+}
+
+
+sys_error_t motion_servo_set_us(uint8_t index, uint16_t us)
+{
+	if (index >= _motion_servo_count || (us != 0 && (us < MOTION_SERVO_MIN_US || us > MOTION_SERVO_MAX_US)))
+	{
+		return SYS_ERR;
+	}
+	_motion_servo_ticks[index] = (uint16_t)motion_us_to_ticks(us);
+	return SYS_OK;
+}
+
+
+uint16_t motion_servo_get_us(uint8_t index)
+{
+	if (index >= _motion_servo_count)
+	{
+		return 0;
+	}
+	return (uint16_t)(((uint32_t)_motion_servo_ticks[index] * 1000 + ocgen_get_clock_khz() / 2) / ocgen_get_clock_khz());
+}
+
+
+uint16_t motion_servo_get_slips(void)
+{
+	return _motion_servo_slips;
+}
+
+
+motion_stepper_t * motion_stepper_get_object(motion_stepper_num_t stepper_num)
+{
+	if (stepper_num >= MOTION_STEPPER_COUNT)
+	{
+		return NULL;
+	}
+	return &_motion_steppers[stepper_num];
+}
+
+
+/**
+ * Returns the change of the period of one step, p * m * p^2 in Q16.16.
+ */
+static uint32_t motion_stepper_delta(const motion_stepper_t *stepper)
+{
+	uint32_t p  = stepper->period >> 16;
+	uint64_t q  = ((uint64_t)stepper->m * (p * p)) >> 16;		/** m * p^2 in Q0.32 */
+
+	if (q > 0x80000000ULL)
+	{
+		/** The series is not valid above 0.5, only at the lowest speeds of high accelerations */
+		q = 0x80000000ULL;
+	}
+	return (uint32_t)(((uint64_t)stepper->period * q) >> 32);
+}
+
+
+/**
+ * Computes the period of the next step from the phase of the move.
+ */
+static void motion_stepper_next_period(motion_stepper_t *stepper)
+{
+	switch (stepper->state)
+	{
+		case MOTION_STATE_ACCEL:
+			if (stepper->remaining <= stepper->accel_steps)
+			{
+				stepper->state = MOTION_STATE_DECEL;
+				break;
+			}
+			stepper->period -= motion_stepper_delta(stepper);
+			stepper->accel_steps++;
+			if (stepper->period <= stepper->period_min)
+			{
+				stepper->period = stepper->period_min;
+				stepper->state  = MOTION_STATE_CRUISE;
+			}
+			return;
+
+		case MOTION_STATE_CRUISE:
+			if (stepper->remaining <= stepper->accel_steps)
+			{
+				stepper->state = MOTION_STATE_DECEL;
+				break;
+			}
+			return;
+
+		default:
+			break;
+	}
+
+	stepper->period += motion_stepper_delta(stepper);
+	if (stepper->period > stepper->period_start)
+	{
+		stepper->period = stepper->period_start;
+	}
+}
+
+
+/**
+ * Adds the interval of a step to the window of the measured rate.
+ */
+static void motion_stepper_measure(motion_stepper_t *stepper, uint16_t interval)
+{
+	stepper->window_ticks += interval;
+	if (++stepper->window_steps >= MOTION_STEPPER_RATE_WINDOW)
+	{
+		if (stepper->window_ticks < stepper->window_min)
+		{
+			stepper->window_min = stepper->window_ticks;
+		}
+		stepper->window_ticks = 0;
+		stepper->window_steps = 0;
+	}
+}
+
+
+/**
+ * Called at the end of each step pulse (OCxRS match).
+ */
+static void motion_stepper_handler(int8_t oc, void *context)
+{
+	motion_stepper_t *stepper = (motion_stepper_t *)context;
+
+	stepper->position += stepper->direction;
+	if (stepper->state == MOTION_STATE_IDLE)
+	{
+		/** Aborted after this pulse */
+		ocgen_oc_regs(oc)[2] = 0;
+		return;
+	}
+	if (--stepper->remaining == 0)
+	{
+		ocgen_oc_regs(oc)[2] = 0;
+		stepper->state = MOTION_STATE_IDLE;
+		stepper->done  = true;
+		return;
+	}
+
+	motion_stepper_next_period(stepper);
+
+	/** The step is timed from the previous step, the fraction is carried */
+	uint16_t last  = stepper->rise;
+	uint16_t ticks = (uint16_t)(stepper->period >> 16);
+	uint16_t frac  = stepper->frac + (uint16_t)stepper->period;
+	if (frac < stepper->frac)
+	{
+		ticks++;
+	}
+	stepper->frac  = frac;
+	stepper->rise += ticks;
+
+	if ((int16_t)(stepper->rise - ocgen_get_time()) < (int16_t)ocgen_get_lead_ticks())
+	{
+		stepper->rise = ocgen_get_time() + ocgen_get_lead_ticks();
+		stepper->slips++;
+	}
+	ocgen_oc_arm(oc, stepper->rise, _motion_pulse_ticks);
+	motion_stepper_measure(stepper, stepper->rise - last);
+}
+
+
+sys_error_t motion_stepper_create(motion_stepper_num_t stepper_num, gpio_num_t step_pin, gpio_num_t dir_pin)
+{
+	if (stepper_num >= MOTION_STEPPER_COUNT || (step_pin & 0xF0) != GPIO_RB_0)
+	{
+		return SYS_ERR;
+	}
+
+	motion_stepper_t *stepper = &_motion_steppers[stepper_num];
+	if (stepper->oc >= 0)
+	{
+		motion_stepper_abort(stepper_num);
+		ocgen_oc_release(stepper->oc, stepper->step_pin);
+		stepper->oc = -1;
+	}
+
+	stepper->id         = stepper_num;
+	stepper->step_pin   = step_pin;
+	stepper->dir_pin    = dir_pin;
+	stepper->state      = MOTION_STATE_IDLE;
+	stepper->position   = 0;
+	stepper->remaining  = 0;
+	stepper->window_min = 0xFFFFFFFFUL;
+	stepper->slips      = 0;
+	stepper->done       = false;
+
+	gpio_set_mode(dir_pin, GPIO_MODE_DIGITAL);
+	gpio_set_level(dir_pin, GPIO_LEVEL_LOW);
+	gpio_set_direction(dir_pin, GPIO_DIRECTION_OUTPUT);
+
+	stepper->oc = ocgen_oc_claim(step_pin, motion_stepper_handler, stepper);
+	return (stepper->oc < 0) ? SYS_ERR : SYS_OK;
+}
+
+
+sys_error_t motion_stepper_move(motion_stepper_num_t stepper_num, int32_t steps, uint16_t max_rate, uint32_t accel, callback_t callback)
+{
+	if (stepper_num >= MOTION_STEPPER_COUNT || steps == 0 || max_rate == 0 || accel == 0)
+	{
+		return SYS_ERR;
+	}
+
+	motion_stepper_t *stepper = &_motion_steppers[stepper_num];
+	if (stepper->oc < 0 || stepper->state != MOTION_STATE_IDLE)
+	{
+		return SYS_ERR;
+	}
+
+	/** The divisions and the square root are taken once per move */
+	uint32_t clock  = (uint32_t)ocgen_get_clock_khz() * 1000;
+	uint32_t pulse  = motion_us_to_ticks(MOTION_STEP_PULSE_US);
+	uint32_t min    = clock / max_rate;
+	double   start  = (double)clock * sqrt(2.0 / (double)accel);
+	double   m      = (double)accel * 281474976710656.0 / ((double)clock * (double)clock);
+
+	if (min < pulse + 2 * ocgen_get_lead_ticks() || min > MOTION_PERIOD_MAX || m > 4294967295.0)
+	{
+		return SYS_ERR;
+	}
+	if (start > MOTION_PERIOD_MAX)
+	{
+		start = MOTION_PERIOD_MAX;
+	}
+	if (start < min)
+	{
+		start = min;
+	}
+
+	stepper->callback     = callback;
+	stepper->direction    = (steps > 0) ? 1 : -1;
+	stepper->remaining    = (steps > 0) ? (uint32_t)steps : (uint32_t)(-steps);
+	stepper->accel_steps  = 0;
+	stepper->period_min   = min << 16;
+	stepper->period_start = (uint32_t)start << 16;
+	stepper->period       = stepper->period_start;
+	stepper->m            = (uint32_t)(m + 0.5);
+	stepper->frac         = 0;
+	stepper->window_min   = 0xFFFFFFFFUL;
+	stepper->window_ticks = 0;
+	stepper->window_steps = 0;
+	stepper->done         = false;
+	stepper->state        = (stepper->period_start > stepper->period_min) ? MOTION_STATE_ACCEL : MOTION_STATE_CRUISE;
+
+	_motion_pulse_ticks   = (uint16_t)pulse;
+
+	gpio_set_level(stepper->dir_pin, (steps > 0) ? GPIO_LEVEL_HIGH : GPIO_LEVEL_LOW);
+
+	/** The first step leaves the direction setup time of the driver */
+	PERFORM_CRITICAL_SECTION({
+		stepper->rise = ocgen_get_time() + 2 * ocgen_get_lead_ticks();
+		ocgen_oc_arm(stepper->oc, stepper->rise, _motion_pulse_ticks);
+	});
+	return SYS_OK;
+}
+
+
+sys_error_t motion_stepper_stop(motion_stepper_num_t stepper_num)
+{
+	if (stepper_num >= MOTION_STEPPER_COUNT)
+	{
+		return SYS_ERR;
+	}
+
+	motion_stepper_t *stepper = &_motion_steppers[stepper_num];
+	PERFORM_CRITICAL_SECTION({
+		if (stepper->state != MOTION_STATE_IDLE && stepper->remaining > stepper->accel_steps + 1)
+		{
+			stepper->remaining = stepper->accel_steps + 1;
+		}
+	});
+	return SYS_OK;
+}
+
+
+sys_error_t motion_stepper_abort(motion_stepper_num_t stepper_num)
+{
+	if (stepper_num >= MOTION_STEPPER_COUNT)
+	{
+		return SYS_ERR;
+	}
+
+	motion_stepper_t *stepper = &_motion_steppers[stepper_num];
+	PERFORM_CRITICAL_SECTION({
+		if (stepper->oc >= 0)
+		{
+			ocgen_oc_regs(stepper->oc)[2] = 0;
+		}
+		stepper->state     = MOTION_STATE_IDLE;
+		stepper->remaining = 0;
+		stepper->done      = false;
+	});
+	return SYS_OK;
+}
+
+
+uint32_t motion_stepper_get_peak_rate(motion_stepper_num_t stepper_num)
+{
+	uint32_t window;
+
+	if (stepper_num >= MOTION_STEPPER_COUNT)
+	{
+		return 0;
+	}
+	PERFORM_CRITICAL_SECTION({
+		window = _motion_steppers[stepper_num].window_min;
+	});
+	if (window == 0xFFFFFFFFUL)
+	{
+		return 0;
+	}
+	return (uint32_t)ocgen_get_clock_khz() * 1000 * MOTION_STEPPER_RATE_WINDOW / window;
+}
+
+
+void motion_exec(void)
+{
+	int16_t i;
+
+	for (i = 0; i < MOTION_STEPPER_COUNT; i++)
+	{
+		motion_stepper_t *stepper = &_motion_steppers[i];
+		if (stepper->done)
+		{
+			stepper->done = false;
+			if (stepper->callback)
+			{
+				stepper->callback(stepper);
+			}
+		}
+	}
+}
@@ -0,0 +1,452 @@
+/*
+************************************************************
+* OCGEN Source File                                        *
+* (Output-compare backend of the pdsgen)                   *
+************************************************************
+* File:    ocgen.c                                         *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+#include <ocgen.h>
+
+
+/**
+ * OCxCON bits.
+ */
+#define OCGEN_CON_OCTSEL		0x0008	/** 1: Timer3, 0: Timer2	*/
+#define OCGEN_CON_OCM			0x0007
+
+/**
+ * TxCON bits.
+ */
+#define OCGEN_TCON_TON			0x8000
+#define OCGEN_TCON_TCKPS		0x0030
+#define OCGEN_TCON_TCKPS_8		0x0010
+
+/**
+ * Minimum time from programming the compare registers to the rising edge.
+ */
+#define OCGEN_LEAD_US			4
+
+
+static ocgen_t				_ocgen_objects[PDSGEN_NUM_COUNT];
+static ocgen_handler_t		_ocgen_handlers[OCGEN_OC_COUNT];
+static void					*_ocgen_contexts[OCGEN_OC_COUNT];
+
+static bool					_ocgen_ready;
+static uint16_t				_ocgen_oc_mask;
+static uint16_t				_ocgen_octsel;
+static volatile uint16_t	*_ocgen_tmr;
+static uint16_t				_ocgen_khz;				/** Timer clock in kHz		*/
+static uint16_t				_ocgen_lead_ticks;
+static uint16_t				_ocgen_time_max_us;
+
+/** Interrupt flag/enable registers and masks of OC1-OC5 */
+static volatile uint16_t *const _ocgen_ifs[OCGEN_OC_COUNT] = { &IFS0, &IFS0, &IFS1, &IFS1, &IFS2 };
+static volatile uint16_t *const _ocgen_iec[OCGEN_OC_COUNT] = { &IEC0, &IEC0, &IEC1, &IEC1, &IEC2 };
+static const uint16_t _ocgen_int_mask[OCGEN_OC_COUNT] = { 1 << 2, 1 << 6, 1 << 9, 1 << 10, 1 << 9 };
+
+
+volatile uint16_t *ocgen_oc_regs(int8_t oc)
+{
+	return &OC1RS + 3 * oc;
+}
+
+
+sys_error_t ocgen_init(ocgen_timer_t ocgen_timer, uint16_t oc_mask)
+{
+	static const uint16_t prescalers[4] = { 1, 8, 64, 256 };
+	volatile uint16_t *tcon = (ocgen_timer == OCGEN_TIMER_2) ? &T2CON : &T3CON;
+	volatile uint16_t *pr   = (ocgen_timer == OCGEN_TIMER_2) ? &PR2   : &PR3;
+	volatile uint16_t *tmr  = (ocgen_timer == OCGEN_TIMER_2) ? &TMR2  : &TMR3;
+
+	if ((oc_mask & ((1 << OCGEN_OC_COUNT) - 1)) == 0)
+	{
+		return SYS_ERR;
+	}
+
+	if (*tcon & OCGEN_TCON_TON)
+	{
+		/** Shared timer, it must be free-running */
+		if (*pr != 0xFFFF)
+		{
+			return SYS_ERR;
+		}
+	}
+	else
+	{
+		*tcon = 0;
+		*tmr  = 0;
+		*pr   = 0xFFFF;
+		*tcon = OCGEN_TCON_TON | OCGEN_TCON_TCKPS_8;
+	}
+
+	_ocgen_oc_mask    = oc_mask & ((1 << OCGEN_OC_COUNT) - 1);
+	_ocgen_octsel     = (ocgen_timer == OCGEN_TIMER_3) ? OCGEN_CON_OCTSEL : 0;
+	_ocgen_tmr        = tmr;
+	_ocgen_khz        = (uint16_t)(FCY / 1000UL / prescalers[(*tcon & OCGEN_TCON_TCKPS) >> 4]);
+	_ocgen_lead_ticks = (uint16_t)(((uint32_t)OCGEN_LEAD_US * _ocgen_khz + 999) / 1000);
+	if (_ocgen_lead_ticks < 2)
+	{
+		_ocgen_lead_ticks = 2;
+	}
+	_ocgen_time_max_us = (uint16_t)((uint32_t)OCGEN_TIME_MAX_TICKS * 1000 / _ocgen_khz);
+	_ocgen_ready = true;
+	return SYS_OK;
+}
+
+
+ocgen_t * ocgen_get_object(pdsgen_num_t pdsgen_num)
+{
+	if (pdsgen_num >= PDSGEN_NUM_COUNT)
+	{
+		return NULL;
+	}
+	return &_ocgen_objects[pdsgen_num];
+}
+
+
+/**
+ * Converts microseconds to timer ticks.
+ * Return:
+ * - Ticks, or 0xFFFF if the time does not fit the OC backend.
+ */
+static uint16_t ocgen_us_to_ticks(uint32_t us)
+{
+	if (us > _ocgen_time_max_us)
+	{
+		return 0xFFFF;
+	}
+	uint32_t ticks = (us * _ocgen_khz + 500) / 1000;
+	return (ticks > OCGEN_TIME_MAX_TICKS) ? 0xFFFF : (uint16_t)ticks;
+}
+
+
+/**
+ * Converts microseconds to the ticks (ms) of the pdsgen tick engine.
+ */
+static uint16_t ocgen_us_to_ms(uint32_t us)
+{
+	uint32_t ms = (us + 500) / 1000;
+	return (ms > 0xFFFF) ? 0xFFFF : (uint16_t)ms;
+}
+
+
+/**
+ * Stops the OC module, its output is low.
+ */
+static void ocgen_oc_stop(int8_t oc)
+{
+	*_ocgen_iec[oc] &= ~_ocgen_int_mask[oc];
+	ocgen_oc_regs(oc)[2] = 0;
+	*_ocgen_ifs[oc] &= ~_ocgen_int_mask[oc];
+}
+
+
+int8_t ocgen_oc_claim(gpio_num_t gpio_num, ocgen_handler_t handler, void *context)
+{
+	int8_t oc;
+
+	if (!_ocgen_ready || handler == NULL || (gpio_num != OCGEN_GPIO_NONE && (gpio_num & 0xF0) != GPIO_RB_0))
+	{
+		return -1;
+	}
+
+	for (oc = 0; oc < OCGEN_OC_COUNT; oc++)
+	{
+		if ((_ocgen_oc_mask & (1 << oc)) && _ocgen_handlers[oc] == NULL && (ocgen_oc_regs(oc)[2] & OCGEN_CON_OCM) == 0)
+		{
+			_ocgen_handlers[oc] = handler;
+			_ocgen_contexts[oc] = context;
+			if (gpio_num == OCGEN_GPIO_NONE)
+			{
+				return oc;
+			}
+
+			gpio_set_mode(gpio_num, GPIO_MODE_DIGITAL);
+			gpio_set_level(gpio_num, GPIO_LEVEL_LOW);
+			gpio_set_direction(gpio_num, GPIO_DIRECTION_OUTPUT);
+			/** Masked, a remap from an OC interrupt (motion servos) re-locks the pin mapping */
+			PERFORM_CRITICAL_SECTION({
+				pmap_map_peripheral_to_pin((pf_num_t)(PF_OC1 + oc), (rpo_num_t)gpio_num);
+			});
+			return oc;
+		}
+	}
+	return -1;
+}
+
+
+void ocgen_oc_release(int8_t oc, gpio_num_t gpio_num)
+{
+	if (oc < 0 || oc >= OCGEN_OC_COUNT)
+	{
+		return;
+	}
+	ocgen_oc_stop(oc);
+	if (gpio_num != OCGEN_GPIO_NONE)
+	{
+		PERFORM_CRITICAL_SECTION({
+			pmap_map_peripheral_to_pin(PF_UNUSED, (rpo_num_t)gpio_num);
+		});
+	}
+	_ocgen_handlers[oc] = NULL;
+	_ocgen_contexts[oc] = NULL;
+}
+
+
+void ocgen_oc_enable(int8_t oc, uint16_t ocm)
+{
+	ocgen_oc_regs(oc)[2] = _ocgen_octsel | (ocm & OCGEN_CON_OCM);
+	*_ocgen_ifs[oc] &= ~_ocgen_int_mask[oc];
+	*_ocgen_iec[oc] |= _ocgen_int_mask[oc];
+}
+
+
+void ocgen_oc_arm(int8_t oc, uint16_t rise, uint16_t width)
+{
+	volatile uint16_t *regs = ocgen_oc_regs(oc);
+	regs[2] = 0;
+	regs[1] = rise;
+	regs[0] = rise + width;
+	ocgen_oc_enable(oc, OCGEN_OCM_SINGLE_PULSE);
+}
+
+
+uint16_t ocgen_get_time(void)
+{
+	return *_ocgen_tmr;
+}
+
+
+uint16_t ocgen_get_clock_khz(void)
+{
+	return _ocgen_khz;
+}
+
+
+uint16_t ocgen_get_lead_ticks(void)
+{
+	return _ocgen_lead_ticks;
+}
+
+
+uint16_t ocgen_get_time_max_us(void)
+{
+	return _ocgen_time_max_us;
+}
+
+
+static void ocgen_pulse_handler(int8_t oc, void *context);
+
+
+/**
+ * Starts the waveform on an OC module, or on the tick engine if the OC backend cannot be used.
+ */
+static sys_error_t ocgen_create(pdsgen_num_t pdsgen_num, gpio_num_t gpio_num, pdsgen_mode_t mode, uint32_t head_us, uint32_t active_us, uint32_t total_us, uint16_t cycles)
+{
+	if (pdsgen_num >= PDSGEN_NUM_COUNT || active_us == 0)
+	{
+		return SYS_ERR;
+	}
+	if (mode != PDSGEN_MODE_ONESHOT && (total_us < head_us + active_us || (mode == PDSGEN_MODE_REPEAT && cycles == 0)))
+	{
+		return SYS_ERR;
+	}
+
+	ocgen_terminate(pdsgen_num);
+
+	ocgen_t *ocgen = &_ocgen_objects[pdsgen_num];
+	ocgen->id           = pdsgen_num;
+	ocgen->mode         = mode;
+	ocgen->gpio_num     = gpio_num;
+	ocgen->cycles       = cycles;
+	ocgen->slips        = 0;
+	ocgen->oc           = -1;
+	ocgen->head_ticks   = 0;
+	ocgen->active_ticks = 0;
+	ocgen->total_ticks  = 0;
+
+	uint16_t head   = ocgen_us_to_ticks(head_us);
+	uint16_t active = ocgen_us_to_ticks(active_us);
+	uint16_t total  = (mode == PDSGEN_MODE_ONESHOT) ? 0 : ocgen_us_to_ticks(total_us);
+	int8_t   oc     = -1;
+
+	if (head != 0xFFFF && active != 0xFFFF && active != 0 && total != 0xFFFF &&
+		(mode == PDSGEN_MODE_ONESHOT || total - active > _ocgen_lead_ticks))
+	{
+		oc = ocgen_oc_claim(gpio_num, ocgen_pulse_handler, ocgen);
+	}
+
+	if (oc < 0)
+	{
+		/** Falls back to the tick engine */
+		sys_error_t result;
+		switch (mode)
+		{
+			case PDSGEN_MODE_ONESHOT:
+				result = pdsgen_create_oneshot(pdsgen_num, gpio_num, ocgen_us_to_ms(head_us), ocgen_us_to_ms(active_us));
+				break;
+			case PDSGEN_MODE_REPEAT:
+				result = pdsgen_create_repeat(pdsgen_num, gpio_num, ocgen_us_to_ms(head_us), ocgen_us_to_ms(active_us), ocgen_us_to_ms(total_us), cycles);
+				break;
+			default:
+				result = pdsgen_create_continuous(pdsgen_num, gpio_num, ocgen_us_to_ms(head_us), ocgen_us_to_ms(active_us), ocgen_us_to_ms(total_us));
+				break;
+		}
+		if (result == SYS_OK)
+		{
+			/** Active-high like the OC output, the pdsgen objects are created inverted (LEDs), the head level is re-applied */
+			pdsgen_invert_enable(pdsgen_num, false);
+			pdsgen_gpio_level_update(pdsgen_get_object(pdsgen_num));
+			ocgen->state = PDSGEN_STATE_RUNNING;
+		}
+		return result;
+	}
+
+	/** The tick engine must not drive the same object */
+	pdsgen_level_terminate(pdsgen_num);
+
+	ocgen->oc           = oc;
+	ocgen->head_ticks   = head;
+	ocgen->active_ticks = active;
+	ocgen->total_ticks  = total;
+	ocgen->repeat       = cycles;
+	ocgen->state        = PDSGEN_STATE_RUNNING;
+
+	PERFORM_CRITICAL_SECTION({
+		ocgen->rise = *_ocgen_tmr + ((head > _ocgen_lead_ticks) ? head : _ocgen_lead_ticks);
+		ocgen_oc_arm(oc, ocgen->rise, ocgen->active_ticks);
+	});
+	return SYS_OK;
+}
+
+
+sys_error_t ocgen_create_oneshot(pdsgen_num_t pdsgen_num, gpio_num_t gpio_num, uint32_t head_us, uint32_t active_us)
+{
+	return ocgen_create(pdsgen_num, gpio_num, PDSGEN_MODE_ONESHOT, head_us, active_us, 0, 1);
+}
+
+
+sys_error_t ocgen_create_repeat(pdsgen_num_t pdsgen_num, gpio_num_t gpio_num, uint32_t head_us, uint32_t active_us, uint32_t total_us, uint16_t cycles)
+{
+	return ocgen_create(pdsgen_num, gpio_num, PDSGEN_MODE_REPEAT, head_us, active_us, total_us, cycles);
+}
+
+
+sys_error_t ocgen_create_continuous(pdsgen_num_t pdsgen_num, gpio_num_t gpio_num, uint32_t head_us, uint32_t active_us, uint32_t total_us)
+{
+	return ocgen_create(pdsgen_num, gpio_num, PDSGEN_MODE_CONTINUOUS, head_us, active_us, total_us, 0);
+}
+
+
+sys_error_t ocgen_terminate(pdsgen_num_t pdsgen_num)
+{
+	if (pdsgen_num >= PDSGEN_NUM_COUNT)
+	{
+		return SYS_ERR;
+	}
+
+	ocgen_t *ocgen = &_ocgen_objects[pdsgen_num];
+	if (ocgen->oc >= 0 && _ocgen_contexts[ocgen->oc] == ocgen)
+	{
+		ocgen_oc_release(ocgen->oc, ocgen->gpio_num);
+		ocgen->oc = -1;
+	}
+	else if (ocgen->state == PDSGEN_STATE_RUNNING)
+	{
+		pdsgen_level_terminate(pdsgen_num);
+	}
+	ocgen->state = PDSGEN_STATE_DELETED;
+	return SYS_OK;
+}
+
+
+pdsgen_state_t ocgen_get_state(pdsgen_num_t pdsgen_num)
+{
+	if (pdsgen_num >= PDSGEN_NUM_COUNT)
+	{
+		return PDSGEN_STATE_DELETED;
+	}
+	if (_ocgen_objects[pdsgen_num].oc < 0 && _ocgen_objects[pdsgen_num].state != PDSGEN_STATE_DELETED)
+	{
+		return pdsgen_get_object(pdsgen_num)->state;
+	}
+	return _ocgen_objects[pdsgen_num].state;
+}
+
+
+/**
+ * Called at the falling edge (OCxRS match) of each pulse.
+ */
+static void ocgen_pulse_handler(int8_t oc, void *context)
+{
+	ocgen_t *ocgen = (ocgen_t *)context;
+
+	if (ocgen->mode == PDSGEN_MODE_ONESHOT || (ocgen->mode == PDSGEN_MODE_REPEAT && --ocgen->repeat == 0))
+	{
+		ocgen_oc_stop(oc);
+		ocgen->state = PDSGEN_STATE_COMPLETED;
+		return;
+	}
+
+	ocgen->rise += ocgen->total_ticks;
+	if ((int16_t)(ocgen->rise - *_ocgen_tmr) < (int16_t)_ocgen_lead_ticks)
+	{
+		/** Late, the cycle starts as soon as possible */
+		ocgen->rise = *_ocgen_tmr + _ocgen_lead_ticks;
+		ocgen->slips++;
+	}
+	ocgen_oc_arm(oc, ocgen->rise, ocgen->active_ticks);
+}
+
+
+/**
+ * Dispatches the interrupt of the OC module to its handler.
+ */
+static void ocgen_isr(int8_t oc)
+{
+	*_ocgen_ifs[oc] &= ~_ocgen_int_mask[oc];
+	if (_ocgen_handlers[oc])
+	{
+		_ocgen_handlers[oc](oc, _ocgen_contexts[oc]);
+	}
+	else
+	{
+		ocgen_oc_stop(oc);
+	}
+}
+
+
+void __attribute__((__interrupt__, no_auto_psv)) _OC1Interrupt(void)
+{
+	ocgen_isr(0);
+}
+
+
+void __attribute__((__interrupt__, no_auto_psv)) _OC2Interrupt(void)
+{
+	ocgen_isr(1);
+}
+
+
+void __attribute__((__interrupt__, no_auto_psv)) _OC3Interrupt(void)
+{
+	ocgen_isr(2);
+}
+
+
+void __attribute__((__interrupt__, no_auto_psv)) _OC4Interrupt(void)
+{
+	ocgen_isr(3);
+}
+
+
+void __attribute__((__interrupt__, no_auto_psv)) _OC5Interrupt(void)
+{
+	ocgen_isr(4);
+}
@@ -0,0 +1,486 @@
+/*
+************************************************************
+* PDSGEN Source File                                       *
+* (Programmable Digital Signal Generator)                  *
+************************************************************
+* File:    pdsgen.c                                        *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+#include <pdsgen.h>
+#include <fastio.h>
+
+
+/**
+ * Phases of the FSM.
+ */
+#define PDSGEN_FSM_HEAD		0
+#define PDSGEN_FSM_ACTIVE	1
+#define PDSGEN_FSM_TAIL		2
+
+
+static pdsgen_t _pdsgen_objects[PDSGEN_NUM_COUNT];
+
+/** LAT bits to be set and cleared at the end of the tick, per port */
+static uint16_t _pdsgen_set_mask[2];
+static uint16_t _pdsgen_clear_mask[2];
+
+/** Number of pdsgen_exec() calls, the time base of the deadlines */
+static uint32_t _pdsgen_now;
+
+/** Tick at which the current phase of each object started, valid while it is in the schedule */
+static uint32_t _pdsgen_start[PDSGEN_NUM_COUNT];
+
+/** Tick of the end of the current phase of each object, valid while it is in the schedule */
+static uint32_t _pdsgen_deadline[PDSGEN_NUM_COUNT];
+
+/** Ids of the scheduled objects, ordered by the deadline (earliest first) */
+static uint8_t _pdsgen_schedule[PDSGEN_NUM_COUNT];
+static uint8_t _pdsgen_schedule_count;
+
+
+/**
+ * Returns the position of the object in the schedule, or _pdsgen_schedule_count.
+ */
+static uint8_t pdsgen_schedule_index(uint8_t id)
+{
+	uint8_t i;
+	for (i = 0; i < _pdsgen_schedule_count; i++)
+	{
+		if (_pdsgen_schedule[i] == id)
+		{
+			break;
+		}
+	}
+	return i;
+}
+
+
+/**
+ * Removes the object from the schedule, if it is scheduled.
+ */
+static void pdsgen_unschedule(uint8_t id)
+{
+	uint8_t i = pdsgen_schedule_index(id);
+	if (i < _pdsgen_schedule_count)
+	{
+		for (i++; i < _pdsgen_schedule_count; i++)
+		{
+			_pdsgen_schedule[i - 1] = _pdsgen_schedule[i];
+		}
+		_pdsgen_schedule_count--;
+	}
+}
+
+
+/**
+ * Inserts the object into the schedule, after the objects with the same deadline.
+ */
+static void pdsgen_schedule(uint8_t id, uint32_t deadline)
+{
+	uint8_t i;
+	pdsgen_unschedule(id);
+	_pdsgen_deadline[id] = deadline;
+
+	i = _pdsgen_schedule_count;
+	while (i > 0 && (int32_t)(deadline - _pdsgen_deadline[_pdsgen_schedule[i - 1]]) < 0)
+	{
+		_pdsgen_schedule[i] = _pdsgen_schedule[i - 1];
+		i--;
+	}
+	_pdsgen_schedule[i] = id;
+	_pdsgen_schedule_count++;
+}
+
+
+/**
+ * Returns the ticks the object has spent in its current phase.
+ */
+static uint16_t pdsgen_get_ticks(uint8_t id)
+{
+	if (pdsgen_schedule_index(id) < _pdsgen_schedule_count)
+	{
+		return (uint16_t)(_pdsgen_now - _pdsgen_start[id]);
+	}
+	return _pdsgen_objects[id].ticks;
+}
+
+
+/**
+ * Returns the length of the current phase of the object.
+ */
+static uint16_t pdsgen_phase_length(pdsgen_t * pdsgen)
+{
+	switch (pdsgen->fsm)
+	{
+		case PDSGEN_FSM_HEAD:
+			return pdsgen->head_time;
+		case PDSGEN_FSM_ACTIVE:
+			return pdsgen->active_time;
+		default:
+			return pdsgen->tail_time;
+	}
+}
+
+
+/**
+ * Schedules the end of the current phase, `ticks` are already spent in it.
+ * A phase ends at the first pdsgen_exec() at which its ticks reach the length,
+ * so a phase of length 0 takes one tick. Only running waveforms are scheduled.
+ */
+static void pdsgen_schedule_phase(pdsgen_t * pdsgen)
+{
+	uint8_t id = (uint8_t)(pdsgen - _pdsgen_objects);
+
+	if (pdsgen->state != PDSGEN_STATE_RUNNING || pdsgen->mode < PDSGEN_MODE_ONESHOT)
+	{
+		pdsgen_unschedule(id);
+		return;
+	}
+	uint16_t length = pdsgen_phase_length(pdsgen);
+	_pdsgen_start[id] = _pdsgen_now - pdsgen->ticks;
+	pdsgen_schedule(id, _pdsgen_now + ((length > pdsgen->ticks) ? length - pdsgen->ticks : 1));
+}
+
+
+pdsgen_t * pdsgen_get_object(pdsgen_num_t pdsgen_num)
+{
+	return &_pdsgen_objects[pdsgen_num];
+}
+
+
+sys_error_t pdsgen_reset_object(pdsgen_t * pdsgen)
+{
+	/** Defaults of the board: LED0 (RB4), inverted (the LEDs are active-low) */
+	pdsgen->mode		= PDSGEN_MODE_LOW;
+	pdsgen->state		= PDSGEN_STATE_DELETED;
+	pdsgen->gpio_num	= GPIO_NUM_20;
+	pdsgen->level		= PDSGEN_LEVEL_LOW;
+	pdsgen->invert		= true;
+	pdsgen->head_time	= 0;
+	pdsgen->active_time	= 0;
+	pdsgen->total_time	= 0;
+	pdsgen->tail_time	= 0;
+	pdsgen->cycles		= 0;
+	pdsgen->ticks		= 0;
+	pdsgen->fsm			= PDSGEN_FSM_HEAD;
+	pdsgen->repeat		= 0;
+	pdsgen_unschedule((uint8_t)(pdsgen - _pdsgen_objects));
+	return SYS_OK;
+}
+
+
+sys_error_t pdsgen_gpio_level_update(pdsgen_t * pdsgen)
+{
+	gpio_set_mode(pdsgen->gpio_num, GPIO_MODE_DIGITAL);
+	gpio_set_direction(pdsgen->gpio_num, GPIO_DIRECTION_OUTPUT);
+	gpio_set_level(pdsgen->gpio_num, (pdsgen->level ^ pdsgen->invert) ? GPIO_LEVEL_HIGH : GPIO_LEVEL_LOW);
+	return SYS_OK;
+}
+
+
+/**
+ * Stages the GPIO level of the pdsgen object, it is written by pdsgen_commit().
+ */
+static inline void pdsgen_stage_level(pdsgen_t * pdsgen)
+{
+	gpio_num_t gpio_num	= pdsgen->gpio_num;
+	uint16_t port		= (gpio_num & 0x10) ? GPIO_GROUP_B : GPIO_GROUP_A;
+	uint16_t mask		= FASTIO_MASK(gpio_num);
+
+	if (pdsgen->level ^ pdsgen->invert)
+	{
+		_pdsgen_set_mask[port]   |= mask;
+		_pdsgen_clear_mask[port] &= ~mask;
+	}
+	else
+	{
+		_pdsgen_clear_mask[port] |= mask;
+		_pdsgen_set_mask[port]   &= ~mask;
+	}
+}
+
+
+/**
+ * Writes the staged levels, one LAT write per port.
+ */
+static void pdsgen_commit(void)
+{
+	int16_t port;
+	for (port = GPIO_GROUP_A; port <= GPIO_GROUP_B; port++)
+	{
+		uint16_t mask = _pdsgen_set_mask[port] | _pdsgen_clear_mask[port];
+		if (mask)
+		{
+			PERFORM_CRITICAL_SECTION({
+				fastio_port_write((gpio_group_t)port, mask, _pdsgen_set_mask[port]);
+			});
+			_pdsgen_set_mask[port]   = 0;
+			_pdsgen_clear_mask[port] = 0;
+		}
+	}
+}
+
+
+sys_error_t pdsgen_invert_enable(pdsgen_num_t pdsgen_num, bool invert)
+{
+	if (pdsgen_num >= PDSGEN_NUM_COUNT)
+	{
+		return SYS_ERR;
+	}
+	_pdsgen_objects[pdsgen_num].invert = invert;
+	return SYS_OK;
+}
+
+
+sys_error_t pdsgen_level_terminate(pdsgen_num_t pdsgen_num)
+{
+	if (pdsgen_num >= PDSGEN_NUM_COUNT)
+	{
+		return SYS_ERR;
+	}
+	_pdsgen_objects[pdsgen_num].state = PDSGEN_STATE_DELETED;
+	return pdsgen_reset_object(&_pdsgen_objects[pdsgen_num]);
+}
+
+
+sys_error_t pdsgen_level_set(pdsgen_num_t pdsgen_num, pdsgen_level_t pdsgen_level)
+{
+	if (pdsgen_num >= PDSGEN_NUM_COUNT)
+	{
+		return SYS_ERR;
+	}
+	pdsgen_t *pdsgen	= &_pdsgen_objects[pdsgen_num];
+	gpio_num_t gpio_num	= pdsgen->gpio_num;
+	bool invert			= pdsgen->invert;
+
+	/** The waveform is stopped, the GPIO and the inversion of the object are kept */
+	pdsgen_reset_object(pdsgen);
+	pdsgen->gpio_num	= gpio_num;
+	pdsgen->invert		= invert;
+	pdsgen->state		= PDSGEN_STATE_RUNNING;
+	pdsgen->mode		= (pdsgen_level == PDSGEN_LEVEL_HIGH) ? PDSGEN_MODE_HIGH : PDSGEN_MODE_LOW;
+	pdsgen->level		= pdsgen_level;
+	return pdsgen_gpio_level_update(pdsgen);
+}
+
+
+sys_error_t pdsgen_level_toggle(pdsgen_num_t pdsgen_num)
+{
+	if (pdsgen_num >= PDSGEN_NUM_COUNT)
+	{
+		return SYS_ERR;
+	}
+	pdsgen_t *pdsgen = &_pdsgen_objects[pdsgen_num];
+	pdsgen_level_t level = (gpio_get_level(pdsgen->gpio_num) ^ pdsgen->invert) ? PDSGEN_LEVEL_HIGH : PDSGEN_LEVEL_LOW;
+	return pdsgen_level_set(pdsgen_num, (level == PDSGEN_LEVEL_HIGH) ? PDSGEN_LEVEL_LOW : PDSGEN_LEVEL_HIGH);
+}
+
+
+/**
+ * Creates a pdsgen object of the given mode, the head phase starts at the next tick.
+ * The total time and the cycles are not used by the oneshot mode, the cycles only by the repeat mode.
+ */
+static sys_error_t pdsgen_create(pdsgen_num_t pdsgen_num, gpio_num_t gpio_num, pdsgen_mode_t mode, uint16_t head_time, uint16_t active_time, uint16_t total_time, uint16_t cycles)
+{
+	if (pdsgen_num >= PDSGEN_NUM_COUNT)
+	{
+		return SYS_ERR;
+	}
+
+	pdsgen_t *pdsgen = &_pdsgen_objects[pdsgen_num];
+	pdsgen_reset_object(pdsgen);
+	pdsgen->id			= pdsgen_num;
+	pdsgen->gpio_num	= gpio_num;
+	pdsgen->mode		= mode;
+	pdsgen->state		= PDSGEN_STATE_RUNNING;
+	pdsgen->head_time	= head_time;
+	pdsgen->active_time	= active_time;
+	if (mode != PDSGEN_MODE_ONESHOT)
+	{
+		pdsgen->total_time	= total_time;
+		pdsgen->tail_time	= total_time - head_time - active_time;
+	}
+	if (mode == PDSGEN_MODE_REPEAT)
+	{
+		pdsgen->cycles		= cycles;
+	}
+	pdsgen_gpio_level_update(pdsgen);
+	pdsgen_schedule_phase(pdsgen);
+	return SYS_OK;
+}
+
+
+sys_error_t pdsgen_create_oneshot(pdsgen_num_t pdsgen_num, gpio_num_t gpio_num, uint16_t head_time, uint16_t active_time)
+{
+	return pdsgen_create(pdsgen_num, gpio_num, PDSGEN_MODE_ONESHOT, head_time, active_time, 0, 0);
+}
+
+
+sys_error_t pdsgen_create_repeat(pdsgen_num_t pdsgen_num, gpio_num_t gpio_num, uint16_t head_time, uint16_t active_time, uint16_t total_time, uint16_t cycles)
+{
+	return pdsgen_create(pdsgen_num, gpio_num, PDSGEN_MODE_REPEAT, head_time, active_time, total_time, cycles);
+}
+
+
+sys_error_t pdsgen_create_continuous(pdsgen_num_t pdsgen_num, gpio_num_t gpio_num, uint16_t head_time, uint16_t active_time, uint16_t total_time)
+{
+	return pdsgen_create(pdsgen_num, gpio_num, PDSGEN_MODE_CONTINUOUS, head_time, active_time, total_time, 0);
+}
+
+
+sys_error_t pdsgen_restart(pdsgen_num_t pdsgen_num)
+{
+	if (pdsgen_num >= PDSGEN_NUM_COUNT)
+	{
+		return SYS_ERR;
+	}
+	pdsgen_t *pdsgen = &_pdsgen_objects[pdsgen_num];
+	pdsgen->ticks = 0;
+	pdsgen->fsm   = PDSGEN_FSM_HEAD;
+	pdsgen_schedule_phase(pdsgen);
+	return SYS_OK;
+}
+
+
+sys_error_t pdsgen_synchronize(pdsgen_num_t pdsgen_num_dst, pdsgen_num_t pdsgen_num_src)
+{
+	if (pdsgen_num_dst >= PDSGEN_NUM_COUNT || pdsgen_num_src >= PDSGEN_NUM_COUNT)
+	{
+		return SYS_ERR;
+	}
+	pdsgen_t *pdsgen = &_pdsgen_objects[pdsgen_num_dst];
+	pdsgen->ticks = pdsgen_get_ticks(pdsgen_num_src);
+	pdsgen->fsm   = _pdsgen_objects[pdsgen_num_src].fsm;
+	pdsgen_schedule_phase(pdsgen);
+	return SYS_OK;
+}
+
+
+sys_error_t pdsgen_synchronize_all(void)
+{
+	int16_t i;
+	for (i = 0; i < PDSGEN_NUM_COUNT; i++)
+	{
+		pdsgen_restart((pdsgen_num_t)i);
+	}
+	return SYS_OK;
+}
+
+
+/**
+ * Converts the frequency, duty and shift ratios to the tick counts.
+ */
+static sys_error_t pdsgen_pwm_ticks(float frequency, float duty_ratio, float shift_ratio, uint16_t *head_time, uint16_t *active_time, uint16_t *total_time)
+{
+	if (duty_ratio <= 0.0f || frequency <= 0.0f || frequency >= 101.0f)
+	{
+		return SYS_ERR;
+	}
+
+	float total = 1000.0f / frequency;
+	if (total > 65535.0f)
+	{
+		return SYS_ERR;
+	}
+
+	*total_time  = (uint16_t)total;
+	*head_time   = (uint16_t)(shift_ratio * total);
+	*active_time = (uint16_t)(duty_ratio * total);
+	return SYS_OK;
+}
+
+
+sys_error_t pdsgen_pwm_create_continuous(pdsgen_num_t pdsgen_num, gpio_num_t gpio_num, float frequency, float duty_ratio, float shift_ratio)
+{
+	uint16_t head_time, active_time, total_time;
+	if (pdsgen_pwm_ticks(frequency, duty_ratio, shift_ratio, &head_time, &active_time, &total_time) != SYS_OK)
+	{
+		return SYS_ERR;
+	}
+	return pdsgen_create_continuous(pdsgen_num, gpio_num, head_time, active_time, total_time);
+}
+
+
+sys_error_t pdsgen_pwm_create_repeat(
+			pdsgen_num_t pdsgen_num, gpio_num_t gpio_num,
+			float frequency, float duty_ratio, float shift_ratio, int16_t cycles)
+{
+	uint16_t head_time, active_time, total_time;
+	if (cycles <= 0 || pdsgen_pwm_ticks(frequency, duty_ratio, shift_ratio, &head_time, &active_time, &total_time) != SYS_OK)
+	{
+		return SYS_ERR;
+	}
+	return pdsgen_create_repeat(pdsgen_num, gpio_num, head_time, active_time, total_time, cycles);
+}
+
+
+/**
+ * Ends the current phase: enters the next one and stages its GPIO level.
+ * The tail of the last cycle completes the oneshot and repeat waveforms.
+ */
+static void pdsgen_phase_end(pdsgen_t * pdsgen)
+{
+	switch (pdsgen->fsm)
+	{
+		case PDSGEN_FSM_HEAD:
+			pdsgen->fsm   = PDSGEN_FSM_ACTIVE;
+			pdsgen->level = PDSGEN_LEVEL_HIGH;
+			break;
+		case PDSGEN_FSM_ACTIVE:
+			pdsgen->fsm   = PDSGEN_FSM_TAIL;
+			pdsgen->level = PDSGEN_LEVEL_LOW;
+			break;
+		default:
+			pdsgen->fsm   = PDSGEN_FSM_HEAD;
+			pdsgen->level = PDSGEN_LEVEL_LOW;
+			if (pdsgen->mode == PDSGEN_MODE_ONESHOT)
+			{
+				pdsgen->state = PDSGEN_STATE_COMPLETED;
+			}
+			else if (pdsgen->mode == PDSGEN_MODE_REPEAT && ++pdsgen->repeat == pdsgen->cycles)
+			{
+				pdsgen->repeat = 0;
+				pdsgen->state  = PDSGEN_STATE_COMPLETED;
+			}
+			break;
+	}
+	pdsgen->ticks = 0;
+	pdsgen_stage_level(pdsgen);
+	pdsgen_schedule_phase(pdsgen);
+}
+
+
+void pdsgen_exec(void)
+{
+	_pdsgen_now++;
+
+	/** Only the objects with a due transition are touched */
+	while (_pdsgen_schedule_count > 0)
+	{
+		uint8_t id = _pdsgen_schedule[0];
+		if ((int32_t)(_pdsgen_deadline[id] - _pdsgen_now) > 0)
+		{
+			break;
+		}
+		pdsgen_unschedule(id);
+		pdsgen_phase_end(&_pdsgen_objects[id]);
+	}
+
+	/** All generators change their GPIOs at the same time */
+	pdsgen_commit();
+}
+
+
+uint32_t pdsgen_get_next_deadline(void)
+{
+	if (_pdsgen_schedule_count == 0)
+	{
+		return PDSGEN_DEADLINE_NONE;
+	}
+	return _pdsgen_deadline[_pdsgen_schedule[0]] - _pdsgen_now;
+}
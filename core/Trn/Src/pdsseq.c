@@ -0,0 +1,333 @@
+/*
+************************************************************
+* PDSSEQ Source File                                       *
+* (Table-driven waveform sequencer of the pdsgen)          *
+************************************************************
+* File:    pdsseq.c                                        *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+#include <pdsseq.h>
+
+
+/**
+ * Maximum number of sequence wraps without a segment (empty sequences).
+ */
+#define PDSSEQ_FETCH_GUARD		16
+
+
+static pdsseq_t _pdsseq_objects[PDSGEN_NUM_COUNT];
+
+
+pdsseq_t * pdsseq_get_object(pdsgen_num_t pdsgen_num)
+{
+	if (pdsgen_num >= PDSGEN_NUM_COUNT)
+	{
+		return NULL;
+	}
+	return &_pdsseq_objects[pdsgen_num];
+}
+
+
+/**
+ * Fetches the next segment, following the loops and the chain.
+ * Return:
+ * - false if the sequence is finished.
+ */
+static bool pdsseq_fetch(pdsseq_t *seq, pdsseq_segment_t *segment)
+{
+	uint16_t guard = 0;
+
+	if (seq->has_pending)
+	{
+		seq->has_pending = false;
+		*segment = seq->pending;
+		return true;
+	}
+
+	while (seq->sequence)
+	{
+		const pdsseq_sequence_t *sequence = seq->sequence;
+
+		if (seq->index < sequence->count)
+		{
+			*segment = sequence->segments[seq->index++];
+			return true;
+		}
+
+		if (++guard > PDSSEQ_FETCH_GUARD)
+		{
+			break;
+		}
+
+		seq->index = 0;
+		if (sequence->loops == 0 || ++seq->loop < sequence->loops)
+		{
+			continue;
+		}
+		seq->loop     = 0;
+		seq->sequence = sequence->next;
+	}
+
+	seq->sequence = NULL;
+	return false;
+}
+
+
+/**
+ * Tick engine: starts the next non-empty segment.
+ * Return:
+ * - false if the sequence is finished.
+ */
+static bool pdsseq_tick_next(pdsseq_t *seq)
+{
+	pdsseq_segment_t segment;
+
+	while (pdsseq_fetch(seq, &segment))
+	{
+		if (PDSSEQ_SEGMENT_DURATION(segment))
+		{
+			seq->level  = PDSSEQ_SEGMENT_LEVEL(segment);
+			seq->remain = PDSSEQ_SEGMENT_DURATION(segment);
+			gpio_set_level(seq->gpio_num, seq->level ? GPIO_LEVEL_HIGH : GPIO_LEVEL_LOW);
+			return true;
+		}
+	}
+	return false;
+}
+
+
+/**
+ * OC engine: merges the segments of the given level.
+ * Return:
+ * - Duration of the run in timer ticks.
+ */
+static uint16_t pdsseq_run(pdsseq_t *seq, uint8_t level, bool *end)
+{
+	const uint32_t limit = 0xFFFF - 2 * ocgen_get_lead_ticks();
+	pdsseq_segment_t segment;
+	uint32_t us = 0, ticks = 0;
+
+	*end = false;
+	while (pdsseq_fetch(seq, &segment))
+	{
+		if (PDSSEQ_SEGMENT_LEVEL(segment) != level && PDSSEQ_SEGMENT_DURATION(segment))
+		{
+			seq->pending     = segment;
+			seq->has_pending = true;
+			return (uint16_t)ticks;
+		}
+
+		us   += PDSSEQ_SEGMENT_DURATION(segment);
+		ticks = (us * ocgen_get_clock_khz() + 500) / 1000;
+		if (ticks > limit)
+		{
+			/** The run does not fit the 16-bit compare, it is clamped */
+			seq->overruns++;
+			return (uint16_t)limit;
+		}
+	}
+
+	*end = true;
+	return (uint16_t)ticks;
+}
+
+
+/**
+ * OC engine: programs the next edge after the edge at the given time.
+ */
+static void pdsseq_schedule(pdsseq_t *seq, uint16_t edge)
+{
+	volatile uint16_t *regs = ocgen_oc_regs(seq->oc);
+	bool end;
+	uint16_t ticks = pdsseq_run(seq, seq->level, &end);
+
+	if (end && !seq->level)
+	{
+		/** Trailing low run, the output stays low and pdsseq_exec() times the end */
+		regs[2] = 0;
+		seq->edge         = edge;
+		seq->tail_ticks   = ticks;
+		seq->tail_elapsed = 0;
+		seq->tail         = true;
+		return;
+	}
+	seq->ending = end;
+
+	/** The edge time is at most a few ticks in the past (ISR latency), or in the future at the start */
+	int16_t elapsed = (int16_t)(ocgen_get_time() - edge);
+	if ((int32_t)elapsed + ocgen_get_lead_ticks() > (int32_t)ticks)
+	{
+		/** Late, the edge is moved as early as possible */
+		ticks = elapsed + ocgen_get_lead_ticks();
+		seq->slips++;
+	}
+	regs[1] = edge + ticks;
+}
+
+
+/**
+ * OC engine: called at each edge (OCxR match in the toggle mode).
+ */
+static void pdsseq_oc_handler(int8_t oc, void *context)
+{
+	pdsseq_t *seq = (pdsseq_t *)context;
+	uint16_t edge = ocgen_oc_regs(oc)[1];
+
+	seq->level ^= 1;
+	if (seq->ending)
+	{
+		ocgen_oc_regs(oc)[2] = 0;
+		seq->ending = false;
+		seq->done   = true;
+		return;
+	}
+	pdsseq_schedule(seq, edge);
+}
+
+
+sys_error_t pdsseq_play(pdsgen_num_t pdsgen_num, gpio_num_t gpio_num, const pdsseq_sequence_t *sequence, pdsseq_unit_t unit, pdsseq_callback_t callback)
+{
+	if (pdsgen_num >= PDSGEN_NUM_COUNT || sequence == NULL || sequence->count == 0)
+	{
+		return SYS_ERR;
+	}
+
+	pdsseq_stop(pdsgen_num);
+	ocgen_terminate(pdsgen_num);
+	pdsgen_level_terminate(pdsgen_num);
+
+	pdsseq_t *seq = &_pdsseq_objects[pdsgen_num];
+	seq->id           = pdsgen_num;
+	seq->gpio_num     = gpio_num;
+	seq->unit         = unit;
+	seq->callback     = callback;
+	seq->slips        = 0;
+	seq->overruns     = 0;
+	seq->sequence     = sequence;
+	seq->index        = 0;
+	seq->loop         = 0;
+	seq->has_pending  = false;
+	seq->level        = 0;
+	seq->remain       = 0;
+	seq->oc           = -1;
+	seq->done         = false;
+	seq->ending       = false;
+	seq->tail         = false;
+
+	if (unit == PDSSEQ_UNIT_MS)
+	{
+		gpio_set_mode(gpio_num, GPIO_MODE_DIGITAL);
+		gpio_set_direction(gpio_num, GPIO_DIRECTION_OUTPUT);
+		seq->state = PDSGEN_STATE_RUNNING;
+		if (!pdsseq_tick_next(seq))
+		{
+			seq->done = true;
+		}
+		return SYS_OK;
+	}
+
+	seq->oc = ocgen_oc_claim(gpio_num, pdsseq_oc_handler, seq);
+	if (seq->oc < 0)
+	{
+		return SYS_ERR;
+	}
+
+	seq->state = PDSGEN_STATE_RUNNING;
+	PERFORM_CRITICAL_SECTION({
+		/** The sequence starts two lead times from now, the first edge ends the initial
+		 *  low run (empty if the first segment is high) */
+		pdsseq_schedule(seq, ocgen_get_time() + 2 * ocgen_get_lead_ticks());
+		if (!seq->tail)
+		{
+			ocgen_oc_enable(seq->oc, OCGEN_OCM_TOGGLE);
+		}
+	});
+	return SYS_OK;
+}
+
+
+sys_error_t pdsseq_stop(pdsgen_num_t pdsgen_num)
+{
+	if (pdsgen_num >= PDSGEN_NUM_COUNT)
+	{
+		return SYS_ERR;
+	}
+
+	pdsseq_t *seq = &_pdsseq_objects[pdsgen_num];
+	if (seq->state != PDSGEN_STATE_RUNNING)
+	{
+		return SYS_OK;
+	}
+
+	if (seq->oc >= 0)
+	{
+		ocgen_oc_release(seq->oc, seq->gpio_num);
+		seq->oc = -1;
+	}
+	gpio_set_level(seq->gpio_num, GPIO_LEVEL_LOW);
+	seq->tail  = false;
+	seq->done  = false;
+	seq->state = PDSGEN_STATE_DELETED;
+	return SYS_OK;
+}
+
+
+void pdsseq_exec(void)
+{
+	int16_t i;
+
+	for (i = 0; i < PDSGEN_NUM_COUNT; i++)
+	{
+		pdsseq_t *seq = &_pdsseq_objects[i];
+
+		if (seq->state != PDSGEN_STATE_RUNNING)
+		{
+			continue;
+		}
+
+		if (seq->unit == PDSSEQ_UNIT_MS)
+		{
+			if (!seq->done && --seq->remain == 0 && !pdsseq_tick_next(seq))
+			{
+				seq->done = true;
+			}
+		}
+		else if (seq->tail)
+		{
+			uint16_t now = ocgen_get_time();
+			int16_t delta = (int16_t)(now - seq->edge);
+			if (delta > 0)
+			{
+				uint32_t elapsed = (uint32_t)seq->tail_elapsed + delta;
+				seq->edge = now;
+				seq->tail_elapsed = (elapsed > 0xFFFF) ? 0xFFFF : (uint16_t)elapsed;
+			}
+			if (seq->tail_elapsed >= seq->tail_ticks)
+			{
+				seq->tail = false;
+				seq->done = true;
+			}
+		}
+
+		if (seq->done)
+		{
+			seq->done = false;
+			if (seq->oc >= 0)
+			{
+				ocgen_oc_release(seq->oc, seq->gpio_num);
+				seq->oc = -1;
+			}
+			gpio_set_level(seq->gpio_num, GPIO_LEVEL_LOW);
+			seq->state = PDSGEN_STATE_COMPLETED;
+			if (seq->callback)
+			{
+				seq->callback(seq);
+			}
+		}
+	}
+}
@@ -0,0 +1,313 @@
+/*
+************************************************************
+* PIDCTL Source File                                       *
+* (Fixed-rate fixed-point PID control loops)               *
+************************************************************
+* File:    pidctl.c                                        *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+#include <pidctl.h>
+
+
+/**
+ * Fraction bits of the gains (Q8.8), the products of a Q15 signal and a gain are Q15.8.
+ */
+#define PIDCTL_GAIN_FRAC	8
+
+
+static pidctl_t				_pidctl_objects[PIDCTL_NUM_COUNT];
+static pidctl_stats_t		_pidctl_stats;
+static pwm_group_t			_pidctl_group;
+static uint16_t				_pidctl_divider;
+static uint16_t				_pidctl_count;
+static bool					_pidctl_running;
+
+
+pidctl_t * pidctl_get_object(pidctl_num_t pidctl_num)
+{
+	if (pidctl_num >= PIDCTL_NUM_COUNT)
+	{
+		return NULL;
+	}
+	return &_pidctl_objects[pidctl_num];
+}
+
+
+/**
+ * Returns a + b, saturated to the int32_t range.
+ */
+static inline int32_t pidctl_add_sat(int32_t a, int32_t b)
+{
+	if (b > 0 && a > INT32_MAX - b)
+	{
+		return INT32_MAX;
+	}
+	if (b < 0 && a < INT32_MIN - b)
+	{
+		return INT32_MIN;
+	}
+	return a + b;
+}
+
+
+/**
+ * Computes one sample of the loop and writes the duty.
+ */
+static void pidctl_update(pidctl_t *pid)
+{
+	int16_t y = PIDCTL_ADC_TO_Q15(analog_read_raw(pid->input));
+	int32_t error = (int32_t)pid->setpoint - y;
+	int16_t e = (error > INT16_MAX) ? INT16_MAX : (error < INT16_MIN) ? INT16_MIN : (int16_t)error;
+	int32_t min = (int32_t)pid->out_min << PIDCTL_GAIN_FRAC;
+	int32_t max = (int32_t)pid->out_max << PIDCTL_GAIN_FRAC;
+	int32_t integral = pid->integral + (int32_t)pid->ki * e;
+	int32_t pd;
+	int32_t u;
+
+	if (integral > max)
+	{
+		integral = max;
+	}
+	else if (integral < min)
+	{
+		integral = min;
+	}
+
+	/** Each product is within +-2^30, their difference and the sum with the integral are not */
+	pd = pidctl_add_sat((int32_t)pid->kp * e, -((int32_t)pid->kd * (int16_t)(y - pid->last_measurement)));
+	u  = pidctl_add_sat(pd, integral);
+
+	pid->saturated = true;
+	if (u > max)
+	{
+		/** Anti-windup: the integral is not moved further into the saturation */
+		if (integral > pid->integral)
+		{
+			integral = pid->integral;
+		}
+		u = max;
+	}
+	else if (u < min)
+	{
+		if (integral < pid->integral)
+		{
+			integral = pid->integral;
+		}
+		u = min;
+	}
+	else
+	{
+		pid->saturated = false;
+	}
+
+	pid->integral         = integral;
+	pid->last_measurement = y;
+	pid->measurement      = y;
+	pid->duty             = (pwmfx_q15_t)(u >> PIDCTL_GAIN_FRAC);
+	pwmfx_set_duty_q15(pid->output, pid->duty);
+}
+
+
+/**
+ * Runs the enabled loops every `divider` periods, called at the start of each period.
+ */
+static void pidctl_period(pwm_group_t pwm_group)
+{
+	volatile uint16_t *tmr = (pwm_group == PWM_GROUP_A) ? &TMR2 : &TMR3;
+	uint16_t start;
+	uint16_t end;
+	int16_t i;
+
+	if (++_pidctl_count < _pidctl_divider)
+	{
+		return;
+	}
+	_pidctl_count = 0;
+
+	start = *tmr;
+	for (i = 0; i < PIDCTL_NUM_COUNT; i++)
+	{
+		if (_pidctl_objects[i].enabled)
+		{
+			pidctl_update(&_pidctl_objects[i]);
+		}
+	}
+	end = *tmr;
+
+	/** The timer restarted from zero: the loops took longer than the rest of the period */
+	if (end < start)
+	{
+		_pidctl_stats.overruns++;
+		end += pwmfx_get_period_ticks(pwm_group);
+	}
+	_pidctl_stats.runs++;
+	_pidctl_stats.exec_last = end - start;
+	if (_pidctl_stats.exec_last > _pidctl_stats.exec_max)
+	{
+		_pidctl_stats.exec_max = _pidctl_stats.exec_last;
+	}
+	if (start > _pidctl_stats.latency_max)
+	{
+		_pidctl_stats.latency_max = start;
+	}
+}
+
+
+sys_error_t pidctl_create(pidctl_num_t pidctl_num, analog_num_t input, pwm_num_t output, int16_t kp, int16_t ki, int16_t kd)
+{
+	if (pidctl_num >= PIDCTL_NUM_COUNT || input >= ANALOG_NUM_COUNT || output >= PWM_NUM_COUNT)
+	{
+		return SYS_ERR;
+	}
+
+	pidctl_enable(pidctl_num, false);
+
+	pidctl_t *pid = &_pidctl_objects[pidctl_num];
+	pid->id               = pidctl_num;
+	pid->input            = input;
+	pid->output           = output;
+	pid->setpoint         = 0;
+	pid->kp               = kp;
+	pid->ki               = ki;
+	pid->kd               = kd;
+	pid->out_min          = 0;
+	pid->out_max          = PWMFX_Q15_ONE;
+	pid->measurement      = 0;
+	pid->duty             = 0;
+	pid->saturated        = false;
+	pid->integral         = 0;
+	pid->last_measurement = 0;
+	return SYS_OK;
+}
+
+
+sys_error_t pidctl_init(pwm_group_t pwm_group, uint16_t divider)
+{
+	if (pwm_group > PWM_GROUP_B || divider == 0)
+	{
+		return SYS_ERR;
+	}
+
+	pidctl_stop();
+	_pidctl_group   = pwm_group;
+	_pidctl_divider = divider;
+	_pidctl_count   = 0;
+	pidctl_reset_stats();
+	_pidctl_running = true;
+	return pwmfx_period_attach(pwm_group, PWMFX_PERIOD_SLOT_CONTROL, pidctl_period);
+}
+
+
+sys_error_t pidctl_stop(void)
+{
+	if (!_pidctl_running)
+	{
+		return SYS_OK;
+	}
+	_pidctl_running = false;
+	return pwmfx_period_attach(_pidctl_group, PWMFX_PERIOD_SLOT_CONTROL, NULL);
+}
+
+
+sys_error_t pidctl_enable(pidctl_num_t pidctl_num, bool enable)
+{
+	if (pidctl_num >= PIDCTL_NUM_COUNT)
+	{
+		return SYS_ERR;
+	}
+
+	pidctl_t *pid = &_pidctl_objects[pidctl_num];
+	if (!enable)
+	{
+		pid->enabled = false;
+		return SYS_OK;
+	}
+	if (pid->enabled)
+	{
+		return SYS_OK;
+	}
+
+	/** Bumpless start: the integral holds the current duty and there is no derivative step */
+	pwm_group_t group  = pwm_get_object(pid->output)->group;
+	uint16_t period    = pwmfx_get_period_ticks(group);
+	uint16_t ticks     = pwmfx_get_duty_ticks(pid->output);
+	uint32_t duty      = (period == 0 || ticks >= period) ? PWMFX_Q15_ONE : ((uint32_t)ticks << 15) / period;
+	int16_t y          = PIDCTL_ADC_TO_Q15(analog_read_raw(pid->input));
+
+	PERFORM_CRITICAL_SECTION({
+		pid->integral         = (int32_t)duty << PIDCTL_GAIN_FRAC;
+		pid->last_measurement = y;
+		pid->measurement      = y;
+		pid->duty             = (pwmfx_q15_t)duty;
+		pid->enabled          = true;
+	});
+	return SYS_OK;
+}
+
+
+sys_error_t pidctl_set_setpoint(pidctl_num_t pidctl_num, int16_t setpoint)
+{
+	if (pidctl_num >= PIDCTL_NUM_COUNT)
+	{
+		return SYS_ERR;
+	}
+	_pidctl_objects[pidctl_num].setpoint = setpoint;
+	return SYS_OK;
+}
+
+
+sys_error_t pidctl_set_gains(pidctl_num_t pidctl_num, int16_t kp, int16_t ki, int16_t kd)
+{
+	if (pidctl_num >= PIDCTL_NUM_COUNT)
+	{
+		return SYS_ERR;
+	}
+	pidctl_t *pid = &_pidctl_objects[pidctl_num];
+	PERFORM_CRITICAL_SECTION({
+		pid->kp = kp;
+		pid->ki = ki;
+		pid->kd = kd;
+	});
+	return SYS_OK;
+}
+
+
+sys_error_t pidctl_set_limits(pidctl_num_t pidctl_num, pwmfx_q15_t out_min, pwmfx_q15_t out_max)
+{
+	if (pidctl_num >= PIDCTL_NUM_COUNT || out_min > out_max || out_max > PWMFX_Q15_ONE)
+	{
+		return SYS_ERR;
+	}
+	pidctl_t *pid = &_pidctl_objects[pidctl_num];
+	PERFORM_CRITICAL_SECTION({
+		pid->out_min = out_min;
+		pid->out_max = out_max;
+	});
+	return SYS_OK;
+}
+
+
+sys_error_t pidctl_get_stats(pidctl_stats_t *stats)
+{
+	if (stats == NULL)
+	{
+		return SYS_ERR;
+	}
+	PERFORM_CRITICAL_SECTION({
+		*stats = _pidctl_stats;
+	});
+	return SYS_OK;
+}
+
+
+void pidctl_reset_stats(void)
+{
+	PERFORM_CRITICAL_SECTION({
+		memset(&_pidctl_stats, 0, sizeof(_pidctl_stats));
+	});
+}
@@ -0,0 +1,343 @@
+/*
+************************************************************
+* PWMPROF Source File                                      *
+* (PWM duty ramps, envelopes and frequency chirps)         *
+************************************************************
+* File:    pwmprof.c                                       *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+#include <pwmprof.h>
+
+
+/**
+ * Fraction bits of the duty accumulator (Q15.15) and of the chirp period (Q16.8).
+ */
+#define PWMPROF_DUTY_FRAC		15
+#define PWMPROF_CHIRP_FRAC		8
+
+
+/**
+ * Period sweep of a group.
+ * Members:
+ * - pr: PRx in Q16.8.
+ * - step: Change of pr per period.
+ * - remain: Periods to the end of the sweep.
+ * - shift, duty: Ratios of the channels, kept while the period changes.
+ * - mask: Channels of the group that were running at the start.
+ */
+typedef struct PWMPROF_CHIRP_STRUCT
+{
+	volatile bool	running;
+	volatile bool	done;
+	callback_t		callback;
+	uint32_t		pr;
+	int32_t			step;
+	uint16_t		end_pr;
+	uint16_t		remain;
+	pwmfx_q15_t		shift[PWM_NUM_COUNT];
+	pwmfx_q15_t		duty[PWM_NUM_COUNT];
+	uint16_t		mask;
+}pwmprof_chirp_t;
+
+
+static pwmprof_t		_pwmprof_objects[PWM_NUM_COUNT];
+static pwm_group_t		_pwmprof_groups[PWM_NUM_COUNT];
+static pwmprof_chirp_t	_pwmprof_chirps[2];
+
+
+pwmprof_t * pwmprof_get_object(pwm_num_t pwm_num)
+{
+	if (pwm_num >= PWM_NUM_COUNT)
+	{
+		return NULL;
+	}
+	return &_pwmprof_objects[pwm_num];
+}
+
+
+/**
+ * Converts timer ticks of the group period to Q15.
+ */
+static pwmfx_q15_t pwmprof_ticks_to_q15(pwm_group_t pwm_group, uint16_t ticks)
+{
+	uint32_t period = pwmfx_get_period_ticks(pwm_group);
+	if (period == 0 || ticks >= period)
+	{
+		return PWMFX_Q15_ONE;
+	}
+	return (pwmfx_q15_t)(((uint32_t)ticks << 15) / period);
+}
+
+
+/**
+ * Computes the step of a segment: the duty change per period (linear), or the change of
+ * the step per period (S-curve). The S-curve step of the period k of N is a * min(k, N + 1 - k),
+ * the sum of the N steps is a * h * (h + 1) (N = 2h) or a * (h + 1)^2 (N = 2h + 1).
+ */
+static int32_t pwmprof_compute_step(pwmfx_q15_t from, const pwmprof_segment_t *segment)
+{
+	int32_t change = ((int32_t)segment->target - (int32_t)from) << PWMPROF_DUTY_FRAC;
+	uint32_t half = segment->periods >> 1;
+
+	if (segment->shape == PWMPROF_SHAPE_LINEAR)
+	{
+		return change / (int32_t)segment->periods;
+	}
+	if (segment->periods & 1)
+	{
+		return change / (int32_t)((half + 1) * (half + 1));
+	}
+	return change / (int32_t)(half * (half + 1));
+}
+
+
+/**
+ * Advances the profile by one period and writes the duty.
+ */
+static void pwmprof_step(pwmprof_t *prof)
+{
+	const pwmprof_envelope_t *envelope = prof->envelope;
+	const pwmprof_segment_t *segment = &envelope->segments[prof->index];
+	int32_t step = (prof->index == 0 && prof->loop > 0) ? prof->restart_step : prof->steps[prof->index];
+	uint16_t k = ++prof->elapsed;
+
+	if (k >= segment->periods)
+	{
+		/** End of the segment, the rounding errors of the steps are dropped */
+		prof->duty    = (uint32_t)segment->target << PWMPROF_DUTY_FRAC;
+		prof->elapsed = 0;
+		if (++prof->index >= envelope->count)
+		{
+			prof->index = 0;
+			if (envelope->loops == 0)
+			{
+				prof->loop = 1;
+			}
+			else if (++prof->loop >= envelope->loops)
+			{
+				prof->done = true;
+			}
+		}
+	}
+	else if (segment->shape == PWMPROF_SHAPE_SCURVE)
+	{
+		uint16_t r = segment->periods - k + 1;
+		prof->duty += step * (int32_t)((k < r) ? k : r);
+	}
+	else
+	{
+		prof->duty += step;
+	}
+
+	pwmfx_set_q15(prof->id, prof->shift, (pwmfx_q15_t)(prof->duty >> PWMPROF_DUTY_FRAC));
+}
+
+
+/**
+ * Runs the chirp and the profiles of the group, called at the start of each period.
+ */
+static void pwmprof_period(pwm_group_t pwm_group)
+{
+	pwmprof_chirp_t *chirp = &_pwmprof_chirps[pwm_group];
+	bool active = false;
+	bool rescale = false;
+	int16_t i;
+
+	if (chirp->running && pwmfx_period_locked(pwm_group))
+	{
+		/** An icap started on the timer and cached the current period, the sweep is aborted */
+		chirp->running = false;
+	}
+	if (chirp->running)
+	{
+		if (--chirp->remain == 0)
+		{
+			chirp->pr      = (uint32_t)chirp->end_pr << PWMPROF_CHIRP_FRAC;
+			chirp->running = false;
+			chirp->done    = true;
+		}
+		else
+		{
+			chirp->pr += chirp->step;
+			active = true;
+		}
+		*((pwm_group == PWM_GROUP_A) ? &PR2 : &PR3) = (uint16_t)(chirp->pr >> PWMPROF_CHIRP_FRAC);
+		rescale = true;
+	}
+
+	for (i = 0; i < PWM_NUM_COUNT; i++)
+	{
+		pwmprof_t *prof = &_pwmprof_objects[i];
+		if (_pwmprof_groups[i] != pwm_group)
+		{
+			continue;
+		}
+		if (prof->state == PWMPROF_STATE_RUNNING && !prof->done)
+		{
+			pwmprof_step(prof);
+			active = active || !prof->done;
+		}
+		else if (rescale && (chirp->mask & (1 << i)))
+		{
+			pwmfx_set_q15((pwm_num_t)i, chirp->shift[i], chirp->duty[i]);
+		}
+	}
+
+	if (!active)
+	{
+		pwmfx_period_attach(pwm_group, PWMFX_PERIOD_SLOT_PROFILE, NULL);
+	}
+}
+
+
+sys_error_t pwmprof_play(pwm_num_t pwm_num, const pwmprof_envelope_t *envelope, callback_t callback)
+{
+	uint16_t i;
+
+	if (pwm_num >= PWM_NUM_COUNT || envelope == NULL || envelope->count == 0 || envelope->count > PWMPROF_SEGMENT_MAX)
+	{
+		return SYS_ERR;
+	}
+	for (i = 0; i < envelope->count; i++)
+	{
+		if (envelope->segments[i].periods == 0 || envelope->segments[i].target > PWMFX_Q15_ONE)
+		{
+			return SYS_ERR;
+		}
+	}
+
+	pwmprof_stop(pwm_num);
+
+	pwm_group_t group = pwm_get_object(pwm_num)->group;
+	pwmfx_q15_t duty  = pwmprof_ticks_to_q15(group, pwmfx_get_duty_ticks(pwm_num));
+
+	pwmprof_t *prof = &_pwmprof_objects[pwm_num];
+	prof->id       = pwm_num;
+	prof->callback = callback;
+	prof->envelope = envelope;
+	prof->shift    = pwmprof_ticks_to_q15(group, pwmfx_get_shift_ticks(pwm_num));
+	prof->duty     = (uint32_t)duty << PWMPROF_DUTY_FRAC;
+	prof->index    = 0;
+	prof->elapsed  = 0;
+	prof->loop     = 0;
+	prof->done     = false;
+
+	/** All steps are computed here, the ISR only adds them */
+	for (i = 0; i < envelope->count; i++)
+	{
+		prof->steps[i] = pwmprof_compute_step(i ? envelope->segments[i - 1].target : duty, &envelope->segments[i]);
+	}
+	prof->restart_step = pwmprof_compute_step(envelope->segments[envelope->count - 1].target, &envelope->segments[0]);
+
+	_pwmprof_groups[pwm_num] = group;
+	prof->state = PWMPROF_STATE_RUNNING;
+	return pwmfx_period_attach(group, PWMFX_PERIOD_SLOT_PROFILE, pwmprof_period);
+}
+
+
+sys_error_t pwmprof_stop(pwm_num_t pwm_num)
+{
+	if (pwm_num >= PWM_NUM_COUNT)
+	{
+		return SYS_ERR;
+	}
+	PERFORM_CRITICAL_SECTION({
+		_pwmprof_objects[pwm_num].state = PWMPROF_STATE_IDLE;
+		_pwmprof_objects[pwm_num].done  = false;
+	});
+	return SYS_OK;
+}
+
+
+sys_error_t pwmprof_chirp(pwm_group_t pwm_group, const pwmfx_period_t *start, const pwmfx_period_t *end, uint16_t periods, callback_t callback)
+{
+	int16_t i;
+
+	if (pwm_group > PWM_GROUP_B || start == NULL || end == NULL || start->tckps != end->tckps || periods == 0)
+	{
+		return SYS_ERR;
+	}
+	if (pwmfx_period_locked(pwm_group))
+	{
+		return SYS_ERR;
+	}
+
+	pwmprof_chirp_stop(pwm_group);
+	if (pwmfx_set_period(pwm_group, start) != SYS_OK)
+	{
+		return SYS_ERR;
+	}
+
+	pwmprof_chirp_t *chirp = &_pwmprof_chirps[pwm_group];
+	chirp->callback = callback;
+	chirp->mask     = 0;
+	for (i = 0; i < PWM_NUM_COUNT; i++)
+	{
+		if (pwm_get_object((pwm_num_t)i)->group == pwm_group)
+		{
+			chirp->shift[i]   = pwmprof_ticks_to_q15(pwm_group, pwmfx_get_shift_ticks((pwm_num_t)i));
+			chirp->duty[i]    = pwmprof_ticks_to_q15(pwm_group, pwmfx_get_duty_ticks((pwm_num_t)i));
+			_pwmprof_groups[i] = pwm_group;
+			chirp->mask      |= 1 << i;
+		}
+	}
+	chirp->pr      = (uint32_t)start->pr << PWMPROF_CHIRP_FRAC;
+	chirp->step    = (((int32_t)end->pr - (int32_t)start->pr) << PWMPROF_CHIRP_FRAC) / (int32_t)periods;
+	chirp->end_pr  = end->pr;
+	chirp->remain  = periods;
+	chirp->done    = false;
+	chirp->running = true;
+	return pwmfx_period_attach(pwm_group, PWMFX_PERIOD_SLOT_PROFILE, pwmprof_period);
+}
+
+
+sys_error_t pwmprof_chirp_stop(pwm_group_t pwm_group)
+{
+	if (pwm_group > PWM_GROUP_B)
+	{
+		return SYS_ERR;
+	}
+	PERFORM_CRITICAL_SECTION({
+		_pwmprof_chirps[pwm_group].running = false;
+		_pwmprof_chirps[pwm_group].done    = false;
+	});
+	return SYS_OK;
+}
+
+
+void pwmprof_exec(void)
+{
+	int16_t i;
+
+	for (i = 0; i < PWM_NUM_COUNT; i++)
+	{
+		pwmprof_t *prof = &_pwmprof_objects[i];
+		if (prof->state == PWMPROF_STATE_RUNNING && prof->done)
+		{
+			prof->done  = false;
+			prof->state = PWMPROF_STATE_COMPLETED;
+			if (prof->callback)
+			{
+				prof->callback(prof);
+			}
+		}
+	}
+
+	for (i = PWM_GROUP_A; i <= PWM_GROUP_B; i++)
+	{
+		pwmprof_chirp_t *chirp = &_pwmprof_chirps[i];
+		if (chirp->done)
+		{
+			chirp->done = false;
+			if (chirp->callback)
+			{
+				chirp->callback(NULL);
+			}
+		}
+	}
+}
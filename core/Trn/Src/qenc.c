@@ -0,0 +1,235 @@
+/*
+************************************************************
+* QENC Source File                                         *
+* (Quadrature encoder decoding)                            *
+************************************************************
+* File:    qenc.c                                          *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+#include <qenc.h>
+
+
+/** Marks an illegal transition in the table */
+#define QENC_ILLEGAL    2
+
+
+/**
+ * Transition table indexed by (previous AB << 2) | new AB, A is bit 1 and B is bit 0.
+ */
+static const int8_t _qenc_table[16] = {
+	/* 00 -> */  0, -1, +1, QENC_ILLEGAL,
+	/* 01 -> */ +1,  0, QENC_ILLEGAL, -1,
+	/* 10 -> */ -1, QENC_ILLEGAL,  0, +1,
+	/* 11 -> */ QENC_ILLEGAL, +1, -1,  0
+};
+
+
+typedef struct QENC_PINS_STRUCT
+{
+	bool        b_port_a;   /** Channel A is in PORTB   */
+	bool        b_port_b;   /** Channel B is in PORTB   */
+	uint8_t     shift_a;    /** Bit of channel A        */
+	uint8_t     shift_b;    /** Bit of channel B        */
+}qenc_pins_t;
+
+
+static qenc_t               _qenc_objects[QENC_NUM_COUNT];
+static qenc_pins_t          _qenc_pins[QENC_NUM_COUNT];
+static volatile uint16_t    _qenc_used;
+
+
+qenc_t * qenc_get_object(qenc_num_t qenc_num)
+{
+	if (qenc_num >= QENC_NUM_COUNT)
+	{
+		return NULL;
+	}
+	return &_qenc_objects[qenc_num];
+}
+
+
+/**
+ * Returns the AB state of the encoder from the port snapshots.
+ */
+static inline uint8_t qenc_read_state(const qenc_pins_t *pins, uint16_t ra, uint16_t rb)
+{
+	uint16_t a = pins->b_port_a ? rb : ra;
+	uint16_t b = pins->b_port_b ? rb : ra;
+	return (((a >> pins->shift_a) & 1) << 1) | ((b >> pins->shift_b) & 1);
+}
+
+
+sys_error_t qenc_create(qenc_num_t qenc_num, gpio_num_t gpio_a, gpio_num_t gpio_b, uint16_t sampling_interval)
+{
+	if (qenc_num >= QENC_NUM_COUNT || gpio_a == gpio_b || sampling_interval == 0)
+	{
+		return SYS_ERR;
+	}
+
+	qenc_t *qenc = &_qenc_objects[qenc_num];
+	qenc_pins_t *pins = &_qenc_pins[qenc_num];
+	uint16_t bit = 1 << qenc_num;
+
+	PERFORM_CRITICAL_SECTION({
+		_qenc_used &= ~bit;
+	});
+
+	gpio_set_mode(gpio_a, GPIO_MODE_DIGITAL);
+	gpio_set_direction(gpio_a, GPIO_DIRECTION_INPUT);
+	gpio_set_mode(gpio_b, GPIO_MODE_DIGITAL);
+	gpio_set_direction(gpio_b, GPIO_DIRECTION_INPUT);
+
+	pins->b_port_a = gpio_get_group(gpio_a) == GPIO_GROUP_B;
+	pins->b_port_b = gpio_get_group(gpio_b) == GPIO_GROUP_B;
+	pins->shift_a  = gpio_a & 0x0F;
+	pins->shift_b  = gpio_b & 0x0F;
+
+	qenc->id                = qenc_num;
+	qenc->gpio_a            = gpio_a;
+	qenc->gpio_b            = gpio_b;
+	qenc->direction         = 1;
+	qenc->sampling_interval = sampling_interval;
+	qenc->position          = 0;
+	qenc->errors            = 0;
+	qenc->delta             = 0;
+	qenc->velocity          = 0;
+	qenc->state             = qenc_read_state(pins, PORTA, PORTB);
+	qenc->last_position     = 0;
+	qenc->ticks             = 0;
+
+	gpio_change_notification_enable(gpio_a);
+	gpio_change_notification_enable(gpio_b);
+	cndisp_attach(CNDISP_SLOT_QENC, qenc_cn_handler);
+
+	PERFORM_CRITICAL_SECTION({
+		_qenc_used |= bit;
+	});
+	return SYS_OK;
+}
+
+
+sys_error_t qenc_delete(qenc_num_t qenc_num)
+{
+	if (qenc_num >= QENC_NUM_COUNT)
+	{
+		return SYS_ERR;
+	}
+	PERFORM_CRITICAL_SECTION({
+		_qenc_used &= ~(1 << qenc_num);
+	});
+	return SYS_OK;
+}
+
+
+sys_error_t qenc_set_reverse(qenc_num_t qenc_num, bool reverse)
+{
+	if (qenc_num >= QENC_NUM_COUNT)
+	{
+		return SYS_ERR;
+	}
+	_qenc_objects[qenc_num].direction = reverse ? -1 : 1;
+	return SYS_OK;
+}
+
+
+int32_t qenc_get_position(qenc_num_t qenc_num)
+{
+	int32_t position = 0;
+	if (qenc_num < QENC_NUM_COUNT)
+	{
+		PERFORM_CRITICAL_SECTION({
+			position = _qenc_objects[qenc_num].position;
+		});
+	}
+	return position;
+}
+
+
+sys_error_t qenc_set_position(qenc_num_t qenc_num, int32_t position)
+{
+	if (qenc_num >= QENC_NUM_COUNT)
+	{
+		return SYS_ERR;
+	}
+	qenc_t *qenc = &_qenc_objects[qenc_num];
+	PERFORM_CRITICAL_SECTION({
+		qenc->position = position;
+	});
+	qenc->last_position = position;
+	return SYS_OK;
+}
+
+
+uint16_t qenc_get_errors(qenc_num_t qenc_num)
+{
+	uint16_t errors = 0;
+	if (qenc_num < QENC_NUM_COUNT)
+	{
+		PERFORM_CRITICAL_SECTION({
+			errors = _qenc_objects[qenc_num].errors;
+			_qenc_objects[qenc_num].errors = 0;
+		});
+	}
+	return errors;
+}
+
+
+void qenc_cn_handler(gpio_inputs_change_data_t *data)
+{
+	uint16_t ra = (uint16_t)data->gpio_ra_data;
+	uint16_t rb = (uint16_t)data->gpio_rb_data;
+	int16_t i;
+
+	for (i = 0; i < QENC_NUM_COUNT; i++)
+	{
+		if (!(_qenc_used & (1 << i)))
+		{
+			continue;
+		}
+
+		qenc_t *qenc  = &_qenc_objects[i];
+		uint8_t state = qenc_read_state(&_qenc_pins[i], ra, rb);
+		int8_t  step  = _qenc_table[(qenc->state << 2) | state];
+
+		qenc->state = state;
+		if (step == QENC_ILLEGAL)
+		{
+			qenc->errors++;
+		}
+		else if (step)
+		{
+			qenc->position += (qenc->direction > 0) ? step : -step;
+		}
+	}
+}
+
+
+void qenc_exec(void)
+{
+	int16_t i;
+
+	for (i = 0; i < QENC_NUM_COUNT; i++)
+	{
+		if (!(_qenc_used & (1 << i)))
+		{
+			continue;
+		}
+
+		qenc_t *qenc = &_qenc_objects[i];
+		if (++qenc->ticks < qenc->sampling_interval)
+		{
+			continue;
+		}
+		qenc->ticks = 0;
+
+		int32_t position    = qenc_get_position((qenc_num_t)i);
+		qenc->delta         = position - qenc->last_position;
+		qenc->last_position = position;
+		qenc->velocity      = (float)qenc->delta * 1000.0f / qenc->sampling_interval;
+	}
+}
@@ -0,0 +1,535 @@
+/*
+************************************************************
+* RPC Source File                                          *
+* (Binary request/response protocol beside cmdex)          *
+************************************************************
+* File:    rpc.c                                           *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+#include <rpc.h>
+#include <systick.h>
+
+
+/**
+ * Receiver states.
+ */
+#define RPC_STATE_IDLE			0	/** Text bytes, waiting for RPC_SYNC     */
+#define RPC_STATE_SYNC			1	/** Waiting for RPC_SYNC_REQUEST         */
+#define RPC_STATE_HEADER		2	/** id, opcode, length                   */
+#define RPC_STATE_BODY			3	/** Arguments and CRC                    */
+
+/**
+ * Request header size (sync to length) and maximum response size.
+ */
+#define RPC_REQUEST_HEADER		5
+#define RPC_RESPONSE_HEADER		6
+#define RPC_RESPONSE_MAX		(RPC_RESPONSE_HEADER + RPC_RESULT_MAX + 2)
+
+/**
+ * Bytes read from the RX queue per rpc_exec() call, bounds the main loop time.
+ */
+#define RPC_EXEC_BYTES			64
+
+
+static rpc_status_t rpc_op_ping(const uint8_t *args, uint8_t *result);
+static rpc_status_t rpc_op_pwm_duty(const uint8_t *args, uint8_t *result);
+static rpc_status_t rpc_op_pwm_q15(const uint8_t *args, uint8_t *result);
+static rpc_status_t rpc_op_analog(const uint8_t *args, uint8_t *result);
+static rpc_status_t rpc_op_analog_all(const uint8_t *args, uint8_t *result);
+static rpc_status_t rpc_op_gpio_write(const uint8_t *args, uint8_t *result);
+static rpc_status_t rpc_op_gpio_read(const uint8_t *args, uint8_t *result);
+
+
+/**
+ * Built-in opcodes, sorted by opcode.
+ */
+static const rpc_command_t _rpc_builtins[] = {
+	{ RPC_OP_PING,       0, 4,                    rpc_op_ping       },
+	{ RPC_OP_PWM_DUTY,   3, 0,                    rpc_op_pwm_duty   },
+	{ RPC_OP_PWM_Q15,    5, 0,                    rpc_op_pwm_q15    },
+	{ RPC_OP_ANALOG,     1, 2,                    rpc_op_analog     },
+	{ RPC_OP_ANALOG_ALL, 0, 2 * ANALOG_NUM_COUNT, rpc_op_analog_all },
+	{ RPC_OP_GPIO_WRITE, 2, 0,                    rpc_op_gpio_write },
+	{ RPC_OP_GPIO_READ,  1, 1,                    rpc_op_gpio_read  }
+};
+
+#define RPC_BUILTIN_COUNT		(sizeof(_rpc_builtins) / sizeof(_rpc_builtins[0]))
+
+
+static rpc_t				_rpc;
+static const rpc_command_t	*_rpc_commands;
+static uint16_t				_rpc_count;
+static bool					_rpc_ready;
+
+/**
+ * GPIO writes of the apply pass of a batch, written after the PWM commit.
+ */
+static uint8_t				_rpc_batch_gpio[RPC_BATCH_MAX][2];
+static uint8_t				_rpc_batch_gpio_count;
+
+
+rpc_t * rpc_get_object(void)
+{
+	return &_rpc;
+}
+
+
+static inline uint16_t rpc_get_u16(const uint8_t *p)
+{
+	return (uint16_t)p[0] | ((uint16_t)p[1] << 8);
+}
+
+
+static inline void rpc_put_u16(uint8_t *p, uint16_t value)
+{
+	p[0] = (uint8_t)(value);
+	p[1] = (uint8_t)(value >> 8);
+}
+
+
+/**
+ * Binary search of the opcode in a sorted table.
+ */
+static const rpc_command_t * rpc_search(const rpc_command_t *table, uint16_t count, uint8_t opcode)
+{
+	uint16_t low = 0;
+	uint16_t high = count;
+
+	while (low < high)
+	{
+		uint16_t mid = (low + high) >> 1;
+		if (table[mid].opcode == opcode)
+		{
+			return &table[mid];
+		}
+		if (opcode < table[mid].opcode)
+		{
+			high = mid;
+		}
+		else
+		{
+			low = mid + 1;
+		}
+	}
+	return NULL;
+}
+
+
+/**
+ * Returns the command of the opcode, the user table is searched first.
+ */
+static const rpc_command_t * rpc_find(uint8_t opcode)
+{
+	const rpc_command_t *command = rpc_search(_rpc_commands, _rpc_count, opcode);
+	if (command == NULL)
+	{
+		command = rpc_search(_rpc_builtins, RPC_BUILTIN_COUNT, opcode);
+	}
+	return command;
+}
+
+
+sys_error_t rpc_register(const rpc_command_t *commands, uint16_t count)
+{
+	uint16_t i;
+
+	if (commands == NULL && count != 0)
+	{
+		return SYS_ERR;
+	}
+	for (i = 0; i < count; i++)
+	{
+		if (commands[i].handler == NULL || commands[i].opcode == RPC_OP_BATCH ||
+			commands[i].arg_size > RPC_ARG_MAX || commands[i].result_size > RPC_RESULT_MAX)
+		{
+			return SYS_ERR;
+		}
+		if (i > 0 && commands[i - 1].opcode >= commands[i].opcode)
+		{
+			return SYS_ERR;
+		}
+	}
+	_rpc_commands = commands;
+	_rpc_count    = count;
+	return SYS_OK;
+}
+
+
+/**
+ * Checks all commands of the batch, then applies them together.
+ * The result is the number of commands and the index of the first failure (RPC_BATCH_NONE).
+ */
+static rpc_status_t rpc_batch(const uint8_t *args, uint8_t size, uint8_t *result)
+{
+	static uint8_t scratch[RPC_RESULT_MAX];
+	const rpc_command_t *commands[RPC_BATCH_MAX];
+	uint8_t offsets[RPC_BATCH_MAX];
+	rpc_status_t status = RPC_STATUS_OK;
+	uint8_t count = 0;
+	uint8_t offset = 0;
+	uint8_t i;
+
+	/** Nothing runs unless all commands are known and complete */
+	while (offset < size)
+	{
+		const rpc_command_t *command = rpc_find(args[offset]);
+		if (command == NULL)
+		{
+			status = RPC_STATUS_UNKNOWN_OPCODE;
+		}
+		else if (count >= RPC_BATCH_MAX || offset + 1 + command->arg_size > size)
+		{
+			status = RPC_STATUS_BAD_LENGTH;
+		}
+		if (status != RPC_STATUS_OK)
+		{
+			result[0] = count;
+			result[1] = count;
+			return status;
+		}
+		commands[count] = command;
+		offsets[count]  = offset + 1;
+		offset += 1 + command->arg_size;
+		count++;
+	}
+
+	result[0] = count;
+	result[1] = RPC_BATCH_NONE;
+
+	/** Check pass, nothing is applied unless all commands pass */
+	cmdex_batch_begin();
+	for (i = 0; i < count && status == RPC_STATUS_OK; i++)
+	{
+		status = commands[i]->handler(&args[offsets[i]], scratch);
+		if (status != RPC_STATUS_OK)
+		{
+			result[1] = i;
+		}
+	}
+	if (status != RPC_STATUS_OK)
+	{
+		cmdex_batch_end(false);
+		return status;
+	}
+
+	/** Apply pass, the PWM and GPIO writes are staged, the system tick is masked until they are written */
+	_rpc_batch_gpio_count = 0;
+	TIMER1_ISR_DISABLE();
+	cmdex_batch_apply();
+	for (i = 0; i < count; i++)
+	{
+		rpc_status_t s = commands[i]->handler(&args[offsets[i]], scratch);
+		if (s != RPC_STATUS_OK && status == RPC_STATUS_OK)
+		{
+			status    = s;
+			result[1] = i;
+		}
+	}
+	if (cmdex_batch_end(status == RPC_STATUS_OK) != SYS_OK)
+	{
+		if (status == RPC_STATUS_OK)
+		{
+			status    = RPC_STATUS_FAILED;
+			result[1] = count;
+		}
+		TIMER1_ISR_ENABLE();
+		return status;
+	}
+	for (i = 0; i < _rpc_batch_gpio_count; i++)
+	{
+		gpio_set_level((gpio_num_t)_rpc_batch_gpio[i][0], _rpc_batch_gpio[i][1] ? GPIO_LEVEL_HIGH : GPIO_LEVEL_LOW);
+	}
+	TIMER1_ISR_ENABLE();
+	return status;
+}
+
+
+uint16_t rpc_handle(const uint8_t *request, uint8_t *response)
+{
+	const rpc_command_t *command;
+	rpc_status_t status;
+	uint8_t opcode = request[3];
+	uint8_t length = 0;
+
+	command = (opcode == RPC_OP_BATCH) ? NULL : rpc_find(opcode);
+
+	if (opcode == RPC_OP_BATCH)
+	{
+		status = rpc_batch(&request[RPC_REQUEST_HEADER], request[4], &response[RPC_RESPONSE_HEADER]);
+		length = 2;
+	}
+	else if (command == NULL)
+	{
+		status = RPC_STATUS_UNKNOWN_OPCODE;
+	}
+	else if (request[4] != command->arg_size)
+	{
+		status = RPC_STATUS_BAD_LENGTH;
+	}
+	else
+	{
+		status = command->handler(&request[RPC_REQUEST_HEADER], &response[RPC_RESPONSE_HEADER]);
+		if (status == RPC_STATUS_OK)
+		{
+			length = command->result_size;
+		}
+	}
+
+	response[0] = RPC_SYNC;
+	response[1] = RPC_SYNC_RESPONSE;
+	response[2] = request[2];
+	response[3] = opcode;
+	response[4] = (uint8_t)status;
+	response[5] = length;
+
+	uint16_t size = RPC_RESPONSE_HEADER + length;
+	rpc_put_u16(&response[size], crc16_compute(CRC16_INIT, response, size));
+	return size + 2;
+}
+
+
+/**
+ * Checks the CRC of the received request, handles it and queues the response.
+ */
+static void rpc_request_received(rpc_t *rpc)
+{
+	static uint8_t response[RPC_RESPONSE_MAX];
+	uint16_t size = RPC_REQUEST_HEADER + rpc->frame[4];
+
+	if (crc16_compute(CRC16_INIT, rpc->frame, size) != rpc_get_u16(&rpc->frame[size]))
+	{
+		rpc->crc_errors++;
+		return;
+	}
+
+	size = rpc_handle(rpc->frame, response);
+	rpc->requests++;
+
+	/** The whole frame or nothing, serial_write_bytes_async() checks the free space first */
+	if (serial_write_bytes_async(rpc->serial_num, response, size) != QUEUE_OK)
+	{
+		rpc->tx_drops++;
+	}
+}
+
+
+/**
+ * Adds a text byte to the line, a complete line is passed to cmdex_exec_on() with the port of rpc.
+ */
+static void rpc_text_received(rpc_t *rpc, char byte)
+{
+	if (byte == '\r' || byte == '\n')
+	{
+		if (rpc->line_length > 0 && rpc->line_length <= RPC_LINE_MAX)
+		{
+			rpc->line[rpc->line_length] = '\0';
+			rpc->lines++;
+			cmdex_exec_on(rpc->line, rpc->serial_num);
+		}
+		rpc->line_length = 0;
+		return;
+	}
+	if (rpc->line_length < RPC_LINE_MAX)
+	{
+		rpc->line[rpc->line_length] = byte;
+	}
+	else if (rpc->line_length == RPC_LINE_MAX)
+	{
+		/** The rest of the line is dropped */
+		rpc->overflows++;
+	}
+	else
+	{
+		return;
+	}
+	rpc->line_length++;
+}
+
+
+/**
+ * Receiver state machine, one byte.
+ */
+static void rpc_byte_received(rpc_t *rpc, uint8_t byte)
+{
+	switch (rpc->state)
+	{
+		case RPC_STATE_SYNC:
+			if (byte == RPC_SYNC_REQUEST)
+			{
+				rpc->frame[1] = byte;
+				rpc->count    = 2;
+				rpc->state    = RPC_STATE_HEADER;
+				return;
+			}
+			rpc->state = RPC_STATE_IDLE;
+			break;
+
+		case RPC_STATE_HEADER:
+			rpc->frame[rpc->count++] = byte;
+			if (rpc->count == RPC_REQUEST_HEADER)
+			{
+				/** An oversized length cannot be a request, the receiver resynchronizes */
+				rpc->state = (rpc->frame[4] <= RPC_ARG_MAX) ? RPC_STATE_BODY : RPC_STATE_IDLE;
+			}
+			return;
+
+		case RPC_STATE_BODY:
+			rpc->frame[rpc->count++] = byte;
+			if (rpc->count == RPC_REQUEST_HEADER + rpc->frame[4] + 2)
+			{
+				rpc->state = RPC_STATE_IDLE;
+				rpc_request_received(rpc);
+			}
+			return;
+
+		default:
+			break;
+	}
+
+	if (byte == RPC_SYNC)
+	{
+		rpc->frame[0] = byte;
+		rpc->state    = RPC_STATE_SYNC;
+		return;
+	}
+	rpc_text_received(rpc, (char)byte);
+}
+
+
+sys_error_t rpc_init(serial_num_t serial_num)
+{
+	if (serial_num != SERIAL_NUM_1 && serial_num != SERIAL_NUM_2)
+	{
+		return SYS_ERR;
+	}
+	memset(&_rpc, 0, sizeof(_rpc));
+	_rpc.serial_num = serial_num;
+	_rpc.state      = RPC_STATE_IDLE;
+	_rpc_ready      = true;
+	return SYS_OK;
+}
+
+
+void rpc_exec(void)
+{
+	rpc_t *rpc = &_rpc;
+	char byte;
+	int16_t i;
+
+	if (!_rpc_ready)
+	{
+		return;
+	}
+	for (i = 0; i < RPC_EXEC_BYTES; i++)
+	{
+		if (serial_read_byte(rpc->serial_num, &byte) != QUEUE_OK)
+		{
+			break;
+		}
+		rpc_byte_received(rpc, (uint8_t)byte);
+	}
+}
+
+
+/**
+ * Built-in opcodes.
+ */
+static rpc_status_t rpc_op_ping(const uint8_t *args, uint8_t *result)
+{
+	uint32_t ticks = system_tick_get_ticks();
+	rpc_put_u16(&result[0], (uint16_t)ticks);
+	rpc_put_u16(&result[2], (uint16_t)(ticks >> 16));
+	return RPC_STATUS_OK;
+}
+
+
+static rpc_status_t rpc_op_pwm_duty(const uint8_t *args, uint8_t *result)
+{
+	uint16_t duty = rpc_get_u16(&args[1]);
+	if (args[0] >= PWM_NUM_COUNT || duty > PWMFX_Q15_ONE)
+	{
+		return RPC_STATUS_BAD_ARGUMENT;
+	}
+	return (cmdex_pwm_write((pwm_num_t)args[0], CMDEX_PWM_KEEP, duty) == SYS_OK) ? RPC_STATUS_OK : RPC_STATUS_FAILED;
+}
+
+
+static rpc_status_t rpc_op_pwm_q15(const uint8_t *args, uint8_t *result)
+{
+	uint16_t shift = rpc_get_u16(&args[1]);
+	uint16_t duty  = rpc_get_u16(&args[3]);
+	if (args[0] >= PWM_NUM_COUNT || shift > PWMFX_Q15_ONE || duty > PWMFX_Q15_ONE)
+	{
+		return RPC_STATUS_BAD_ARGUMENT;
+	}
+	return (cmdex_pwm_write((pwm_num_t)args[0], shift, duty) == SYS_OK) ? RPC_STATUS_OK : RPC_STATUS_FAILED;
+}
+
+
+static rpc_status_t rpc_op_analog(const uint8_t *args, uint8_t *result)
+{
+	if (args[0] >= ANALOG_NUM_COUNT)
+	{
+		return RPC_STATUS_BAD_ARGUMENT;
+	}
+	rpc_put_u16(result, (uint16_t)analog_read_raw((analog_num_t)args[0]));
+	return RPC_STATUS_OK;
+}
+
+
+static rpc_status_t rpc_op_analog_all(const uint8_t *args, uint8_t *result)
+{
+	int16_t i;
+	for (i = 0; i < ANALOG_NUM_COUNT; i++)
+	{
+		rpc_put_u16(&result[2 * i], (uint16_t)analog_read_raw((analog_num_t)i));
+	}
+	return RPC_STATUS_OK;
+}
+
+
+/**
+ * Returns true for the GPIOs of gpio_num_t (RA<4:0>, RB<15:0>).
+ */
+static bool rpc_gpio_valid(uint8_t gpio)
+{
+	return gpio <= GPIO_NUM_4 || (gpio >= GPIO_NUM_16 && gpio <= GPIO_NUM_31);
+}
+
+
+static rpc_status_t rpc_op_gpio_write(const uint8_t *args, uint8_t *result)
+{
+	if (!rpc_gpio_valid(args[0]) || args[1] > 1)
+	{
+		return RPC_STATUS_BAD_ARGUMENT;
+	}
+	if (cmdex_batch_checking())
+	{
+		return RPC_STATUS_OK;
+	}
+	if (cmdex_batch_active() && _rpc_batch_gpio_count < RPC_BATCH_MAX)
+	{
+		_rpc_batch_gpio[_rpc_batch_gpio_count][0] = args[0];
+		_rpc_batch_gpio[_rpc_batch_gpio_count][1] = args[1];
+		_rpc_batch_gpio_count++;
+		return RPC_STATUS_OK;
+	}
+	gpio_set_level((gpio_num_t)args[0], args[1] ? GPIO_LEVEL_HIGH : GPIO_LEVEL_LOW);
+	return RPC_STATUS_OK;
+}
+
+
+static rpc_status_t rpc_op_gpio_read(const uint8_t *args, uint8_t *result)
+{
+	if (!rpc_gpio_valid(args[0]))
+	{
+		return RPC_STATUS_BAD_ARGUMENT;
+	}
+	result[0] = gpio_get_level((gpio_num_t)args[0]) ? 1 : 0;
+	return RPC_STATUS_OK;
+}
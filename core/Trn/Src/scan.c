@@ -0,0 +1,149 @@
+/*
+************************************************************
+* SCAN Source File                                         *
+* (Process-image scan cycle)                               *
+************************************************************
+* File:    scan.c                                          *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+#include <scan.h>
+#include <systick.h>
+
+
+static scan_inputs_t    _scan_inputs;
+static scan_outputs_t   _scan_outputs;
+static scan_callback_t  _scan_callback;
+
+static uint16_t         _scan_mask_a;
+static uint16_t         _scan_mask_b;
+static uint16_t         _scan_pwm_mask;
+static float            _scan_duty_committed[PWM_NUM_COUNT];
+
+
+const scan_inputs_t * scan_get_inputs(void)
+{
+	return &_scan_inputs;
+}
+
+
+scan_outputs_t * scan_get_outputs(void)
+{
+	return &_scan_outputs;
+}
+
+
+sys_error_t scan_set_outputs(gpio_group_t gpio_group, uint16_t mask)
+{
+	if (gpio_group == GPIO_GROUP_A)
+	{
+		_scan_mask_a        = mask;
+		_scan_outputs.lat_a = LATA & mask;
+	}
+	else if (gpio_group == GPIO_GROUP_B)
+	{
+		_scan_mask_b        = mask;
+		_scan_outputs.lat_b = LATB & mask;
+	}
+	else
+	{
+		return SYS_ERR;
+	}
+	return SYS_OK;
+}
+
+
+sys_error_t scan_set_pwm_outputs(uint16_t pwm_mask)
+{
+	int16_t i;
+
+	pwm_mask &= (1 << PWM_NUM_COUNT) - 1;
+	for (i = 0; i < PWM_NUM_COUNT; i++)
+	{
+		if (pwm_mask & (1 << i))
+		{
+			pwm_t *pwm = pwm_get_object((pwm_num_t)i);
+			_scan_outputs.duty_ratio[i] = pwm->duty_ratio;
+			_scan_duty_committed[i]     = pwm->duty_ratio;
+		}
+	}
+	_scan_pwm_mask = pwm_mask;
+	return SYS_OK;
+}
+
+
+sys_error_t scan_set_callback(scan_callback_t scan_callback)
+{
+	_scan_callback = scan_callback;
+	return SYS_OK;
+}
+
+
+void scan_read_inputs(void)
+{
+	scan_inputs_t *in = &_scan_inputs;
+	int16_t i;
+
+	in->tick   = system_tick_get_ticks();
+	in->port_a = PORTA;
+	in->port_b = PORTB;
+
+	in->switches = 0;
+	for (i = 0; i < SWITCH_NUM_COUNT; i++)
+	{
+		switch_state_t state = switch_get_object((switch_num_t)i)->state;
+		in->switch_states[i] = state;
+		if (state != SWITCH_STATE_OFF)
+		{
+			in->switches |= 1 << i;
+		}
+	}
+
+	for (i = 0; i < ANALOG_NUM_COUNT; i++)
+	{
+		in->analog[i] = analog_read_raw((analog_num_t)i);
+	}
+
+	in->scan_count++;
+}
+
+
+void scan_write_outputs(void)
+{
+	scan_outputs_t *out = &_scan_outputs;
+	int16_t i;
+
+	if (_scan_mask_a)
+	{
+		fastio_port_write(GPIO_GROUP_A, _scan_mask_a, out->lat_a);
+	}
+	if (_scan_mask_b)
+	{
+		fastio_port_write(GPIO_GROUP_B, _scan_mask_b, out->lat_b);
+	}
+
+	/** Only the changed duty ratios are written */
+	for (i = 0; i < PWM_NUM_COUNT; i++)
+	{
+		if ((_scan_pwm_mask & (1 << i)) && out->duty_ratio[i] != _scan_duty_committed[i])
+		{
+			_scan_duty_committed[i] = out->duty_ratio[i];
+			pwm_set_duty_ratio((pwm_num_t)i, out->duty_ratio[i]);
+		}
+	}
+}
+
+
+void scan_exec(void *param)
+{
+	scan_read_inputs();
+	if (_scan_callback)
+	{
+		_scan_callback(&_scan_inputs, &_scan_outputs);
+	}
+	scan_write_outputs();
+}
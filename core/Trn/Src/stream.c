@@ -0,0 +1,193 @@
+/*
+************************************************************
+* STREAM Source File                                       *
+* (Multi-channel ADC streaming to the host)                *
+************************************************************
+* File:    stream.c                                        *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+#include <stream.h>
+#include <systick.h>
+
+
+static stream_t _stream;
+static uint8_t  _stream_frame[STREAM_FRAME_MAX];
+
+
+stream_t * stream_get_object(void)
+{
+	return &_stream;
+}
+
+
+/**
+ * Clears the frame and writes the header of a new frame.
+ */
+static void stream_frame_begin(stream_t *stream)
+{
+	uint32_t timestamp = system_tick_get_ticks();
+	uint8_t *p = _stream_frame;
+
+	p[0]  = STREAM_FRAME_SYNC_0;
+	p[1]  = STREAM_FRAME_SYNC_1;
+	p[2]  = (uint8_t)(stream->sequence);
+	p[3]  = (uint8_t)(stream->sequence >> 8);
+	p[4]  = (uint8_t)(timestamp);
+	p[5]  = (uint8_t)(timestamp >> 8);
+	p[6]  = (uint8_t)(timestamp >> 16);
+	p[7]  = (uint8_t)(timestamp >> 24);
+	p[8]  = stream->channel_mask;
+	p[9]  = stream->records;
+	p[10] = (uint8_t)(stream->sampling_interval);
+	p[11] = (uint8_t)(stream->sampling_interval >> 8);
+
+	stream->length       = STREAM_HEADER_SIZE;
+	stream->record_count = 0;
+	stream->pending      = 0;
+}
+
+
+/**
+ * Packs the 4 pending samples (10-bit) into 5 bytes.
+ */
+static void stream_pack_group(stream_t *stream)
+{
+	uint8_t *p = &_stream_frame[stream->length];
+	int16_t *s = stream->group;
+
+	p[0] = (uint8_t)s[0];
+	p[1] = (uint8_t)s[1];
+	p[2] = (uint8_t)s[2];
+	p[3] = (uint8_t)s[3];
+	p[4] = (uint8_t)(((s[0] >> 8) & 0x03)      |
+					 ((s[1] >> 8) & 0x03) << 2 |
+					 ((s[2] >> 8) & 0x03) << 4 |
+					 ((s[3] >> 8) & 0x03) << 6);
+
+	stream->length += 5;
+	stream->pending = 0;
+}
+
+
+/**
+ * Pads the last group, appends the checksum and puts the frame into the TX queue,
+ * the frame is dropped if it does not fit.
+ */
+static void stream_frame_send(stream_t *stream)
+{
+	if (stream->pending)
+	{
+		while (stream->pending < 4)
+		{
+			stream->group[stream->pending++] = 0;
+		}
+		stream_pack_group(stream);
+	}
+
+	uint16_t crc = crc16_compute(CRC16_INIT, _stream_frame, stream->length);
+	_stream_frame[stream->length++] = (uint8_t)(crc);
+	_stream_frame[stream->length++] = (uint8_t)(crc >> 8);
+
+	/** The whole frame or nothing, serial_write_bytes_async() checks the free space first */
+	if (serial_write_bytes_async(stream->serial_num, _stream_frame, stream->length) == QUEUE_OK)
+	{
+		stream->frames_sent++;
+	}
+	else
+	{
+		stream->frames_dropped++;
+	}
+	stream->sequence++;
+}
+
+
+sys_error_t stream_start(serial_num_t serial_num, uint8_t channel_mask, uint16_t sampling_interval, uint8_t records)
+{
+	uint8_t count = 0;
+	int16_t i;
+
+	channel_mask &= (1 << ANALOG_NUM_COUNT) - 1;
+	for (i = 0; i < ANALOG_NUM_COUNT; i++)
+	{
+		if (channel_mask & (1 << i))
+		{
+			count++;
+		}
+	}
+
+	if (count == 0 || sampling_interval == 0 || records == 0 || records > STREAM_RECORDS_MAX)
+	{
+		return SYS_ERR;
+	}
+
+	stream_t *stream = &_stream;
+	stream->running           = false;
+	stream->serial_num        = serial_num;
+	stream->channel_mask      = channel_mask;
+	stream->channel_count     = count;
+	stream->records           = records;
+	stream->sampling_interval = sampling_interval;
+	stream->sequence          = 0;
+	stream->frames_sent       = 0;
+	stream->frames_dropped    = 0;
+	stream->ticks             = 0;
+	stream->length            = 0;
+	stream->running           = true;
+
+	return SYS_OK;
+}
+
+
+sys_error_t stream_stop(void)
+{
+	_stream.running = false;
+	_stream.length  = 0;
+	return SYS_OK;
+}
+
+
+void stream_exec(void)
+{
+	stream_t *stream = &_stream;
+	int16_t i;
+
+	if (!stream->running)
+	{
+		return;
+	}
+
+	if (++stream->ticks < stream->sampling_interval)
+	{
+		return;
+	}
+	stream->ticks = 0;
+
+	if (stream->length == 0)
+	{
+		stream_frame_begin(stream);
+	}
+
+	/** All channels of a record are read in the same tick from the scan buffer */
+	for (i = 0; i < ANALOG_NUM_COUNT; i++)
+	{
+		if (stream->channel_mask & (1 << i))
+		{
+			stream->group[stream->pending++] = analog_read_raw((analog_num_t)i);
+			if (stream->pending == 4)
+			{
+				stream_pack_group(stream);
+			}
+		}
+	}
+
+	if (++stream->record_count >= stream->records)
+	{
+		stream_frame_send(stream);
+		stream->length = 0;
+	}
+}
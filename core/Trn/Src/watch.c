@@ -0,0 +1,222 @@
+/*
+************************************************************
+* WATCH Source File                                        *
+* (Live variable watch and telemetry frames)               *
+************************************************************
+* File:    watch.c                                         *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+#include <watch.h>
+#include <systick.h>
+
+
+typedef struct WATCH_TYPE_NAME_STRUCT
+{
+	const char		*name;
+	watch_type_t	type;
+}watch_type_name_t;
+
+static const watch_type_name_t _watch_type_names[] = {
+	{ "u8",  WATCH_TYPE_U8  },
+	{ "i8",  WATCH_TYPE_I8  },
+	{ "u16", WATCH_TYPE_U16 },
+	{ "i16", WATCH_TYPE_I16 },
+	{ "u32", WATCH_TYPE_U32 },
+	{ "i32", WATCH_TYPE_I32 },
+	{ "f32", WATCH_TYPE_F32 }
+};
+
+#define WATCH_TYPE_COUNT		(sizeof(_watch_type_names) / sizeof(_watch_type_names[0]))
+
+
+static watch_t		_watch;
+static uint8_t		_watch_frame[WATCH_FRAME_MAX];
+
+
+watch_t * watch_get_object(void)
+{
+	return &_watch;
+}
+
+
+/**
+ * Returns the index of the type in the name table, or WATCH_TYPE_COUNT.
+ */
+static uint16_t watch_type_index(watch_type_t type)
+{
+	uint16_t i;
+	for (i = 0; i < WATCH_TYPE_COUNT; i++)
+	{
+		if (_watch_type_names[i].type == type)
+		{
+			break;
+		}
+	}
+	return i;
+}
+
+
+sys_error_t watch_parse_type(const char *name, watch_type_t *type)
+{
+	uint16_t i;
+	for (i = 0; i < WATCH_TYPE_COUNT; i++)
+	{
+		if (strcmp(name, _watch_type_names[i].name) == 0)
+		{
+			*type = _watch_type_names[i].type;
+			return SYS_OK;
+		}
+	}
+	return SYS_ERR;
+}
+
+
+const char * watch_type_name(watch_type_t type)
+{
+	uint16_t i = watch_type_index(type);
+	return (i < WATCH_TYPE_COUNT) ? _watch_type_names[i].name : "?";
+}
+
+
+sys_error_t watch_add(uint16_t address, watch_type_t type)
+{
+	watch_t *watch = &_watch;
+	uint8_t width = WATCH_TYPE_WIDTH(type);
+
+	if (watch_type_index(type) >= WATCH_TYPE_COUNT || watch->count >= WATCH_ENTRY_MAX)
+	{
+		return SYS_ERR;
+	}
+	if (address < WATCH_RAM_START || address + width > WATCH_RAM_END || (width > 1 && (address & 1)))
+	{
+		return SYS_ERR;
+	}
+	watch->entries[watch->count].address = address;
+	watch->entries[watch->count].type    = type;
+	watch->count++;
+	return SYS_OK;
+}
+
+
+sys_error_t watch_clear(void)
+{
+	_watch.running = false;
+	_watch.count   = 0;
+	return SYS_OK;
+}
+
+
+sys_error_t watch_start(serial_num_t serial_num, uint16_t interval)
+{
+	watch_t *watch = &_watch;
+
+	if (interval == 0 || watch->count == 0)
+	{
+		return SYS_ERR;
+	}
+	watch->running        = false;
+	watch->serial_num     = serial_num;
+	watch->interval       = interval;
+	watch->sequence       = 0;
+	watch->frames_sent    = 0;
+	watch->frames_dropped = 0;
+	watch->ticks          = 0;
+	watch->running        = true;
+	return SYS_OK;
+}
+
+
+sys_error_t watch_stop(void)
+{
+	_watch.running = false;
+	return SYS_OK;
+}
+
+
+/**
+ * Copies the values of all entries to the frame, returns the frame length without the CRC.
+ */
+static uint16_t watch_snapshot(watch_t *watch, uint8_t *p)
+{
+	uint16_t length = WATCH_HEADER_SIZE + watch->count;
+	uint32_t timestamp;
+	uint8_t i;
+
+	PERFORM_CRITICAL_SECTION({
+		timestamp = system_tick_get_ticks();
+		for (i = 0; i < watch->count; i++)
+		{
+			uint16_t address = watch->entries[i].address;
+			if (WATCH_TYPE_WIDTH(watch->entries[i].type) == 1)
+			{
+				p[length++] = *(volatile uint8_t *)(uintptr_t)address;
+			}
+			else
+			{
+				/** Word reads, the 16-bit halves of a 32-bit value are read together */
+				uint16_t low = *(volatile uint16_t *)(uintptr_t)address;
+				p[length++] = (uint8_t)(low);
+				p[length++] = (uint8_t)(low >> 8);
+				if (WATCH_TYPE_WIDTH(watch->entries[i].type) == 4)
+				{
+					uint16_t high = *(volatile uint16_t *)(uintptr_t)(address + 2);
+					p[length++] = (uint8_t)(high);
+					p[length++] = (uint8_t)(high >> 8);
+				}
+			}
+		}
+	});
+
+	p[0] = WATCH_FRAME_SYNC_0;
+	p[1] = WATCH_FRAME_SYNC_1;
+	p[2] = (uint8_t)(watch->sequence);
+	p[3] = (uint8_t)(watch->sequence >> 8);
+	p[4] = (uint8_t)(timestamp);
+	p[5] = (uint8_t)(timestamp >> 8);
+	p[6] = (uint8_t)(timestamp >> 16);
+	p[7] = (uint8_t)(timestamp >> 24);
+	p[8] = watch->count;
+	for (i = 0; i < watch->count; i++)
+	{
+		p[WATCH_HEADER_SIZE + i] = (uint8_t)watch->entries[i].type;
+	}
+	return length;
+}
+
+
+void watch_exec(void)
+{
+	watch_t *watch = &_watch;
+	uint16_t length;
+
+	if (!watch->running)
+	{
+		return;
+	}
+	if (++watch->ticks < watch->interval)
+	{
+		return;
+	}
+	watch->ticks = 0;
+
+	length = watch_snapshot(watch, _watch_frame);
+	uint16_t crc = crc16_compute(CRC16_INIT, _watch_frame, length);
+	_watch_frame[length++] = (uint8_t)(crc);
+	_watch_frame[length++] = (uint8_t)(crc >> 8);
+
+	/** The whole frame or nothing, serial_write_bytes_async() checks the free space first */
+	if (serial_write_bytes_async(watch->serial_num, _watch_frame, length) == QUEUE_OK)
+	{
+		watch->frames_sent++;
+	}
+	else
+	{
+		watch->frames_dropped++;
+	}
+	watch->sequence++;
+}
@@ -0,0 +1,6 @@
+/*
+ * Host stand-in of libpic30.h.
+ */
+
+#define __delay_ms(ms)
+#define __delay_us(us)
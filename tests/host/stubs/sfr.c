@@ -0,0 +1,6 @@
+/*
+ * Definitions of the SFR variables declared by the host xc.h.
+ */
+
+#define HOST_SFR_DEFINE
+#include <xc.h>
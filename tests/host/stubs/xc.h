@@ -0,0 +1,75 @@
+/*
+ * Host stand-in of the XC16 device header for the host tests.
+ * The SFRs are plain variables defined by sfr.c, the registers that the drivers address
+ * by offset (OCxRS/OCxR/OCxCON, ICxBUF/ICxCON) are laid out in arrays like on the device.
+ */
+
+#ifndef __HOST_XC_H__
+#define __HOST_XC_H__
+
+#include <stdint.h>
+
+#ifdef HOST_SFR_DEFINE
+	#define SFR(name)			volatile uint16_t name
+	#define SFR_BITS(name, body)	volatile struct { body } name##bits
+#else
+	#define SFR(name)			extern volatile uint16_t name
+	#define SFR_BITS(name, body)	extern volatile struct { body } name##bits
+#endif
+
+SFR(PORTA); SFR(PORTB); SFR(LATA); SFR(LATB); SFR(TRISA); SFR(TRISB); SFR(OSCCON);
+SFR(TMR1); SFR(PR1); SFR(T1CON); SFR(TMR2); SFR(PR2); SFR(T2CON); SFR(TMR3); SFR(PR3); SFR(T3CON);
+SFR(TMR4); SFR(PR4); SFR(T4CON); SFR(TMR5); SFR(PR5); SFR(T5CON); SFR(TMR3HLD); SFR(TMR5HLD);
+SFR(IFS0); SFR(IFS1); SFR(IFS2); SFR(IEC0); SFR(IEC1); SFR(IEC2); SFR(IPC0); SFR(IPC1); SFR(IPC9);
+SFR(RPOR0); SFR(RPINR7); SFR(RPINR8); SFR(RPINR9); SFR(CNEN1); SFR(CNEN2); SFR(ADC1BUF0);
+
+/** OC1-OC5: OCxRS, OCxR, OCxCON */
+#ifdef HOST_SFR_DEFINE
+volatile uint16_t host_oc_regs[5 * 3];
+volatile uint16_t host_ic_regs[5 * 2];
+#else
+extern volatile uint16_t host_oc_regs[5 * 3];
+extern volatile uint16_t host_ic_regs[5 * 2];
+#endif
+
+#define OC1RS	host_oc_regs[0]
+#define OC1R	host_oc_regs[1]
+#define OC1CON	host_oc_regs[2]
+
+/** IC1-IC5: ICxBUF, ICxCON */
+#define IC1BUF	host_ic_regs[0]
+#define IC1CON	host_ic_regs[1]
+#define IC2BUF	host_ic_regs[2]
+#define IC2CON	host_ic_regs[3]
+#define IC3BUF	host_ic_regs[4]
+#define IC3CON	host_ic_regs[5]
+#define IC4BUF	host_ic_regs[6]
+#define IC4CON	host_ic_regs[7]
+#define IC5BUF	host_ic_regs[8]
+#define IC5CON	host_ic_regs[9]
+
+SFR_BITS(IFS0, unsigned T1IF:1; unsigned T2IF:1; unsigned T3IF:1; unsigned OC1IF:1; unsigned OC2IF:1; unsigned IC1IF:1; unsigned IC2IF:1;);
+SFR_BITS(IFS1, unsigned T4IF:1; unsigned T5IF:1; unsigned OC3IF:1; unsigned OC4IF:1; unsigned CNIF:1;);
+SFR_BITS(IEC0, unsigned T1IE:1; unsigned T2IE:1; unsigned T3IE:1;);
+SFR_BITS(IEC1, unsigned T4IE:1; unsigned T5IE:1;);
+SFR_BITS(T1CON, unsigned TON:1; unsigned TCKPS:2;);
+SFR_BITS(T2CON, unsigned TON:1; unsigned TCKPS:2; unsigned T32:1;);
+SFR_BITS(T3CON, unsigned TON:1; unsigned TCKPS:2;);
+SFR_BITS(T4CON, unsigned TON:1; unsigned TCKPS:2; unsigned T32:1;);
+SFR_BITS(T5CON, unsigned TON:1; unsigned TCKPS:2;);
+SFR_BITS(RPINR7, unsigned IC1R:5; unsigned IC2R:5;);
+SFR_BITS(RPINR8, unsigned IC3R:5; unsigned IC4R:5;);
+SFR_BITS(RPINR9, unsigned IC5R:5;);
+
+/** The host tests run single-threaded, the ISRs are called by the tests */
+#define SET_AND_SAVE_CPU_IPL(old, new)	((old) = 0)
+#define RESTORE_CPU_IPL(old)			((void)(old))
+#define Nop()
+#define __builtin_write_OSCCONL(value)	(OSCCON = (value))
+#define __builtin_mulss(a, b)			((int32_t)(a) * (int32_t)(b))
+#define __builtin_mulsu(a, b)			((int32_t)(a) * (int32_t)(uint32_t)(b))
+#define __builtin_muluu(a, b)			((uint32_t)(a) * (uint32_t)(b))
+#define __builtin_divud(a, b)			((uint16_t)((a) / (b)))
+#define __builtin_disi(n)
+
+#endif // __HOST_XC_H__
@@ -0,0 +1,35 @@
+/*
+ * Common part of the host tests: the CHECK macro, the result and the pwm object stub.
+ * Included once by each test program.
+ */
+
+#ifndef __HOST_TEST_H__
+#define __HOST_TEST_H__
+
+#include <stdio.h>
+#include <pwm.h>
+
+static int _test_failures;
+
+#define CHECK(cond)		do { if (!(cond)) { printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); _test_failures++; } } while (0)
+
+/** PWM objects of the pwm module, which is not linked */
+static pwm_t _test_pwm[PWM_NUM_COUNT];
+
+
+pwm_t *pwm_get_object(pwm_num_t pwm_num)
+{
+	return &_test_pwm[pwm_num];
+}
+
+
+/**
+ * Prints the result, returns the exit code of the test.
+ */
+static int test_result(void)
+{
+	printf("%s\n", _test_failures ? "FAILED" : "PASSED");
+	return _test_failures ? 1 : 0;
+}
+
+#endif // __HOST_TEST_H__
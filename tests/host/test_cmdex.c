@@ -0,0 +1,291 @@
+/*
+************************************************************
+* CMDEX Host Test                                          *
+* (Integer arguments and batches of the command lines)     *
+************************************************************
+* File:    test_cmdex.c                                    *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+#include <stdarg.h>
+#include <string.h>
+#include <cmdex.h>
+#include "test.h"
+
+#define TEST_PR			1599
+
+static uint32_t _test_ticks;
+static char _test_reply[128];
+static int _test_applied;
+static int _test_unmasked;
+
+void _T2Interrupt(void);
+
+
+pwm_group_t pwm_get_group_from_num(pwm_num_t pwm_num)
+{
+	return _test_pwm[pwm_num].group;
+}
+
+
+int16_t analog_read_raw(analog_num_t analog_num)
+{
+	return 512;
+}
+
+
+uint32_t system_tick_get_ticks(void)
+{
+	return _test_ticks;
+}
+
+
+int16_t serial_printf(serial_num_t serial_num, const char *format, ...)
+{
+	size_t length = strlen(_test_reply);
+	va_list args;
+
+	va_start(args, format);
+	vsnprintf(&_test_reply[length], sizeof(_test_reply) - length, format, args);
+	va_end(args);
+	return 0;
+}
+
+
+/**
+ * Checks that the token parses to `expected`.
+ */
+static void test_int(const char *token, int32_t expected)
+{
+	int32_t value = 0x5A5A5A5A;
+	sys_error_t error = cmdex_parse_int(token, &value);
+
+	if (error != SYS_OK || value != expected)
+	{
+		printf("%-14s -> %s %ld (expected %ld)\n", token, (error == SYS_OK) ? "SYS_OK" : "SYS_ERR", (long)value, (long)expected);
+	}
+	CHECK(error == SYS_OK && value == expected);
+}
+
+
+/**
+ * Checks that the token is rejected and the value is not written.
+ */
+static void test_reject(const char *token)
+{
+	int32_t value = 0x5A5A5A5A;
+	sys_error_t error = cmdex_parse_int(token, &value);
+
+	if (error == SYS_OK)
+	{
+		printf("%-14s -> SYS_OK %ld (expected SYS_ERR)\n", token, (long)value);
+	}
+	CHECK(error != SYS_OK && value == 0x5A5A5A5A);
+}
+
+
+static void test_decimal(void)
+{
+	test_int("0", 0);
+	test_int("-0", 0);
+	test_int("+17", 17);
+	test_int("-17", -17);
+	test_int("2147483647", INT32_MAX);
+	test_int("-2147483648", INT32_MIN);
+	test_int("-2147483647", -INT32_MAX);
+	test_reject("2147483648");
+	test_reject("-2147483649");
+	test_reject("4294967296");
+	test_reject("99999999999");
+	test_reject("");
+	test_reject("-");
+	test_reject("12a");
+}
+
+
+static void test_hex(void)
+{
+	test_int("0x0", 0);
+	test_int("-0x0", 0);
+	test_int("0xff", 255);
+	test_int("0XfF", 255);
+	test_int("0x7FFFFFFF", INT32_MAX);
+	test_int("-0x80000000", INT32_MIN);
+	test_int("-0x7FFFFFFF", -INT32_MAX);
+	test_int("0x00000000007FFFFFFF", INT32_MAX);
+	test_reject("0x80000000");
+	test_reject("0x7FFFFFFF0");
+	test_reject("-0x80000001");
+	test_reject("-0x8000000F");
+	test_reject("-0x80000010");
+	test_reject("0xFFFFFFFF");
+	test_reject("0x100000000");
+	test_reject("0x");
+	test_reject("0xg");
+}
+
+
+static void test_binary(void)
+{
+	test_int("0b101", 5);
+	test_int("-0b1", -1);
+	test_int("0b1111111111111111111111111111111", INT32_MAX);
+	test_int("-0b10000000000000000000000000000000", INT32_MIN);
+	test_reject("0b10000000000000000000000000000000");
+	test_reject("-0b10000000000000000000000000000001");
+	test_reject("0b2");
+	test_reject("0b");
+}
+
+
+/**
+ * User commands: `set` counts the applied calls and the calls with the system tick unmasked,
+ * `slow` takes more than a tick to apply, `tick` applies across a tick boundary in 15 Timer1 counts.
+ * The masked tick is left pending in T1IF like on the device.
+ */
+static sys_error_t test_cmd_set(const cmdex_args_t *args)
+{
+	if (args->value[1] < 0)
+	{
+		return SYS_ERR;
+	}
+	if (!cmdex_batch_checking())
+	{
+		_test_applied++;
+		_test_unmasked += IEC0bits.T1IE;
+	}
+	return SYS_OK;
+}
+
+
+static sys_error_t test_cmd_slow(const cmdex_args_t *args)
+{
+	if (!cmdex_batch_checking())
+	{
+		IFS0bits.T1IF = 1;
+		TMR1 += 100;
+	}
+	return SYS_OK;
+}
+
+
+static sys_error_t test_cmd_tick(const cmdex_args_t *args)
+{
+	if (!cmdex_batch_checking())
+	{
+		_test_unmasked += IEC0bits.T1IE;
+		IFS0bits.T1IF = 1;
+		TMR1 = 5;
+	}
+	return SYS_OK;
+}
+
+
+/**
+ * The system tick ISR, taken when the tick is unmasked after the batch.
+ */
+static void test_tick_isr(void)
+{
+	if (IEC0bits.T1IE && IFS0bits.T1IF)
+	{
+		IFS0bits.T1IF = 0;
+		_test_ticks++;
+	}
+}
+
+
+static const cmdex_command_t _test_commands[] = {
+	{ "set",  test_cmd_set,  "i", "set <n>" },
+	{ "slow", test_cmd_slow, "",  "slow" },
+	{ "tick", test_cmd_tick, "",  "tick" }
+};
+
+
+static void test_exec(const char *text)
+{
+	char line[64];
+
+	strcpy(line, text);
+	_test_reply[0] = '\0';
+	cmdex_exec_on(line, SERIAL_NUM_2);
+}
+
+
+static void test_batch(void)
+{
+	PR2    = TEST_PR;
+	T2CON  = 0x8000;
+	PR1    = 15999;
+	OC1CON = 0x0005;
+	IEC0bits.T1IE = 1;
+	cmdex_register(_test_commands, 3);
+
+	/** Both channels are committed together, the registers change at the next period */
+	test_exec("pwm 0 250; set 1; pwm 1 750");
+	printf("batch:              %s", _test_reply);
+	CHECK(strcmp(_test_reply, "OK 3\r\n") == 0);
+	CHECK(_test_applied == 1);
+	CHECK(pwmfx_get_pending() == 0x0003);
+	CHECK(!cmdex_batch_active());
+	IFS0 |= 1 << 7;
+	_T2Interrupt();
+	CHECK(pwmfx_get_pending() == 0);
+	CHECK(OC1RS - OC1R == (TEST_PR + 1) / 4);
+
+	/** A command that fails its check: nothing is applied, the channel is not staged */
+	test_exec("pwm 0 500; set 2; pwm 9 100");
+	printf("batch, bad channel: %s", _test_reply);
+	CHECK(strcmp(_test_reply, "ERR 2 pwm <channel> <duty 0-1000>\r\n") == 0);
+	CHECK(_test_applied == 1);
+	CHECK(pwmfx_get_pending() == 0);
+	pwmfx_commit(0x0001);
+	CHECK(pwmfx_get_pending() == 0);
+
+	test_exec("set 3; set -1");
+	CHECK(strcmp(_test_reply, "ERR 1 set <n>\r\n") == 0);
+	CHECK(_test_applied == 1);
+
+	/** Watch cannot be staged, it is refused in a batch */
+	test_exec("pwm 0 500; watch stop");
+	CHECK(strncmp(_test_reply, "ERR 1 ", 6) == 0);
+	CHECK(pwmfx_get_pending() == 0);
+
+	/** An apply pass longer than a tick is reported before the commit, no channel changes */
+	TMR1 = 100;
+	test_exec("pwm 0 500; slow");
+	printf("batch, overrun:     %s", _test_reply);
+	CHECK(strcmp(_test_reply, "ERR 2 tick overrun\r\n") == 0);
+	CHECK(pwmfx_get_pending() == 0);
+	CHECK(IEC0bits.T1IE);
+	test_tick_isr();
+	pwmfx_commit(0x0001);
+	CHECK(pwmfx_get_pending() == 0);
+	CHECK(OC1RS - OC1R == (TEST_PR + 1) / 4);
+
+	/** A tick boundary in the apply pass: the tick is held until the batch is committed */
+	TMR1 = 15990;
+	test_exec("pwm 0 500; tick; set 4");
+	printf("batch, tick edge:   %s", _test_reply);
+	CHECK(strcmp(_test_reply, "OK 3\r\n") == 0);
+	CHECK(_test_applied == 2);
+	CHECK(_test_unmasked == 0);
+	CHECK(pwmfx_get_pending() == 0x0001);
+	CHECK(_test_ticks == 1 && IFS0bits.T1IF && IEC0bits.T1IE);
+	test_tick_isr();
+	CHECK(_test_ticks == 2);
+}
+
+
+int main(void)
+{
+	test_decimal();
+	test_hex();
+	test_binary();
+	test_batch();
+
+	return test_result();
+}
@@ -0,0 +1,275 @@
+/*
+************************************************************
+* MOTION Host Test                                         *
+* (Servo frames and step trains on a model of Timer3/OCx)  *
+************************************************************
+* File:    test_motion.c                                   *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+/**
+ * The model counts the free-running Timer3 (FCY/8, 0.5 us) tick by tick. An OC module in the
+ * single-pulse mode raises its output at the OCxR match, drops it at the OCxRS match and sets its
+ * interrupt flag, the ISR is taken `latency` ticks later. The rising edges are logged per pin
+ * through the pin mapping of the OC output.
+ */
+
+#include <motion.h>
+#include "test.h"
+
+#define TEST_OC_FIRST		3				/** OC4, OC5	*/
+#define TEST_OC_COUNT		2
+#define TEST_PINS			32
+#define TEST_EDGES			64
+
+void _OC4Interrupt(void);
+void _OC5Interrupt(void);
+
+/** Pin of each OC output, logged rising edges of each pin */
+static int _test_map[TEST_OC_FIRST + TEST_OC_COUNT];
+static uint64_t _test_rise[TEST_PINS][TEST_EDGES];
+static uint64_t _test_fall[TEST_PINS][TEST_EDGES];
+static int _test_edges[TEST_PINS];
+
+static const uint16_t _test_ifs_mask[TEST_OC_COUNT] = { 1 << 10, 1 << 9 };
+static volatile uint16_t *const _test_ifs[TEST_OC_COUNT] = { &IFS1, &IFS2 };
+static volatile uint16_t *const _test_iec[TEST_OC_COUNT] = { &IEC1, &IEC2 };
+
+
+sys_error_t gpio_set_mode(gpio_num_t gpio_num, gpio_mode_t gpio_mode)
+{
+	return SYS_OK;
+}
+
+
+sys_error_t gpio_set_level(gpio_num_t gpio_num, gpio_level_t gpio_level)
+{
+	return SYS_OK;
+}
+
+
+sys_error_t gpio_set_direction(gpio_num_t gpio_num, gpio_direction_t gpio_direction)
+{
+	return SYS_OK;
+}
+
+
+sys_error_t pmap_map_peripheral_to_pin(pf_num_t pf_num, rpo_num_t rpo_num)
+{
+	int oc;
+
+	for (oc = 0; oc < TEST_OC_FIRST + TEST_OC_COUNT; oc++)
+	{
+		if (_test_map[oc] == (int)(rpo_num & 0x0F))
+		{
+			_test_map[oc] = -1;
+		}
+	}
+	if (pf_num >= PF_OC1 && pf_num < PF_OC1 + TEST_OC_FIRST + TEST_OC_COUNT)
+	{
+		_test_map[pf_num - PF_OC1] = (int)(rpo_num & 0x0F);
+	}
+	return SYS_OK;
+}
+
+
+static void test_setup(void)
+{
+	int i;
+
+	for (i = 0; i < TEST_OC_FIRST + TEST_OC_COUNT; i++)
+	{
+		_test_map[i] = -1;
+	}
+	for (i = 0; i < TEST_PINS; i++)
+	{
+		_test_edges[i] = 0;
+	}
+	T3CON = 0x8010;
+	PR3   = 0xFFFF;
+	TMR3  = 0;
+	IFS1  = IFS2 = IEC1 = IEC2 = 0;
+	ocgen_init(OCGEN_TIMER_3, 0x18);
+}
+
+
+/**
+ * Runs the model for `ticks` from `*now`. The ISRs are entered `latency` ticks after the flag,
+ * `stall` adds a one-time latency at tick `stall_at` (a long critical section).
+ */
+static void test_run(uint64_t *now, uint64_t ticks, uint16_t latency, uint64_t stall_at, uint16_t stall)
+{
+	static int level[TEST_OC_COUNT];
+	static bool done[TEST_OC_COUNT];
+	uint64_t isr_at[TEST_OC_COUNT] = { 0, 0 };
+	uint64_t end = *now + ticks;
+	int i;
+
+	for (; *now < end; (*now)++)
+	{
+		TMR3 = (uint16_t)*now;
+		for (i = 0; i < TEST_OC_COUNT; i++)
+		{
+			volatile uint16_t *regs = ocgen_oc_regs(TEST_OC_FIRST + i);
+			int pin = _test_map[TEST_OC_FIRST + i];
+
+			if ((regs[2] & 0x0007) != OCGEN_OCM_SINGLE_PULSE || done[i])
+			{
+				continue;
+			}
+			if (TMR3 == regs[1] && !level[i])
+			{
+				level[i] = 1;
+				if (pin >= 0 && _test_edges[pin] < TEST_EDGES)
+				{
+					_test_rise[pin][_test_edges[pin]] = *now;
+				}
+			}
+			else if (TMR3 == regs[0] && level[i])
+			{
+				level[i] = 0;
+				done[i]  = true;
+				if (pin >= 0 && _test_edges[pin] < TEST_EDGES)
+				{
+					_test_fall[pin][_test_edges[pin]++] = *now;
+				}
+				*_test_ifs[i] |= _test_ifs_mask[i];
+				isr_at[i] = *now + latency + ((*now >= stall_at && *now < stall_at + stall) ? stall : 0);
+			}
+		}
+		for (i = 0; i < TEST_OC_COUNT; i++)
+		{
+			if ((*_test_ifs[i] & _test_ifs_mask[i]) && (*_test_iec[i] & _test_ifs_mask[i]) && *now >= isr_at[i])
+			{
+				done[i] = false;
+				if (i == 0)
+				{
+					_OC4Interrupt();
+				}
+				else
+				{
+					_OC5Interrupt();
+				}
+			}
+		}
+	}
+}
+
+
+/**
+ * Checks the rising edges of a pin from edge `first`: one per frame (40000 ticks), `width` wide.
+ */
+static void test_check_frames(int pin, int first, uint16_t width)
+{
+	int n;
+
+	CHECK(_test_edges[pin] > first + 2);
+	for (n = first; n < _test_edges[pin]; n++)
+	{
+		CHECK(_test_fall[pin][n] - _test_rise[pin][n] == width);
+		if (n > first)
+		{
+			CHECK(_test_rise[pin][n] - _test_rise[pin][n - 1] == 40000);
+		}
+	}
+}
+
+
+static void test_servo_frames(void)
+{
+	static const gpio_num_t one[1] = { GPIO_NUM_24 };
+	static const gpio_num_t two[2] = { GPIO_NUM_24, GPIO_NUM_25 };
+	uint64_t now = 0;
+
+	/** One servo: the wait to the next frame is longer than 0x7FFF ticks on every frame */
+	test_setup();
+	CHECK(motion_servo_init(one, 1) == SYS_OK);
+	CHECK(motion_servo_set_us(0, 1500) == SYS_OK);
+	test_run(&now, 12 * 40000UL, 20, ~0ULL, 0);
+	printf("servo x1:           %d pulses, %u slips\n", _test_edges[8], motion_servo_get_slips());
+	CHECK(motion_servo_get_slips() == 0);
+	test_check_frames(8, 1, 3000);
+
+	/** Two servos, the second width leaves more than 0x7FFF ticks to the next frame */
+	test_setup();
+	CHECK(motion_servo_init(two, 2) == SYS_OK);
+	CHECK(motion_servo_set_us(0, 1000) == SYS_OK);
+	CHECK(motion_servo_set_us(1, 600) == SYS_OK);
+	test_run(&now, 12 * 40000UL, 20, ~0ULL, 0);
+	printf("servo x2:           %d/%d pulses, %u slips\n", _test_edges[8], _test_edges[9], motion_servo_get_slips());
+	CHECK(motion_servo_get_slips() == 0);
+	test_check_frames(8, 0, 2000);
+	test_check_frames(9, 0, 1200);
+	CHECK((_test_rise[9][4] - _test_rise[8][0]) % 40000 == 5000);
+	motion_servo_stop();
+}
+
+
+static void test_servo_slip(void)
+{
+	static const gpio_num_t two[2] = { GPIO_NUM_24, GPIO_NUM_25 };
+	uint64_t now = 0;
+
+	/** The ISR after the pulse of the first servo in frame 2 is held for 8 ms, past the slot of the second */
+	test_setup();
+	CHECK(motion_servo_init(two, 2) == SYS_OK);
+	CHECK(motion_servo_set_us(0, 1000) == SYS_OK);
+	CHECK(motion_servo_set_us(1, 1000) == SYS_OK);
+	test_run(&now, 3 * 40000UL + 1000, 20, 0, 0);
+	test_run(&now, 12 * 40000UL, 20, now, 16000);
+	printf("servo slip:         %d/%d pulses, %u slips\n", _test_edges[8], _test_edges[9], motion_servo_get_slips());
+	CHECK(motion_servo_get_slips() == 1);
+
+	/** The late slot starts as soon as the ISR runs */
+	CHECK(_test_rise[9][3] - _test_fall[8][2] == 20 + 16000 + (uint64_t)ocgen_get_lead_ticks());
+
+	/** The frames are re-based on it, the frame time and the slot order are kept */
+	CHECK(_test_rise[8][3] - _test_rise[9][3] == 35000);
+	test_check_frames(8, 3, 2000);
+	test_check_frames(9, 3, 2000);
+	motion_servo_stop();
+}
+
+
+static void test_stepper_rate(void)
+{
+	motion_stepper_t *stepper;
+	uint64_t now = 0;
+	uint32_t rate;
+
+	/** 5000 steps/s (400 ticks), the rate measured on the pin is the cruise rate */
+	test_setup();
+	CHECK(motion_stepper_create(MOTION_STEPPER_0, GPIO_NUM_26, GPIO_NUM_27) == SYS_OK);
+	stepper = motion_stepper_get_object(MOTION_STEPPER_0);
+	CHECK(motion_stepper_get_peak_rate(MOTION_STEPPER_0) == 0);
+	CHECK(motion_stepper_move(MOTION_STEPPER_0, 2000, 5000, 50000, NULL) == SYS_OK);
+	test_run(&now, 1000000UL, 20, ~0ULL, 0);
+	rate = motion_stepper_get_peak_rate(MOTION_STEPPER_0);
+	printf("stepper 5000/s:     measured %lu steps/s, %u slips\n", (unsigned long)rate, stepper->slips);
+	CHECK(stepper->state == MOTION_STATE_IDLE && stepper->position == 2000);
+	CHECK(stepper->slips == 0);
+	CHECK(rate >= 4990 && rate <= 5010);
+
+	/** 40000 steps/s (50 ticks) with an ISR latency of 60 ticks: the steps are late, the rate is lower */
+	CHECK(motion_stepper_move(MOTION_STEPPER_0, 20000, 40000, 4000000UL, NULL) == SYS_OK);
+	test_run(&now, 3000000UL, 60, ~0ULL, 0);
+	rate = motion_stepper_get_peak_rate(MOTION_STEPPER_0);
+	printf("stepper 40000/s:    measured %lu steps/s, %u slips\n", (unsigned long)rate, stepper->slips);
+	CHECK(stepper->state == MOTION_STATE_IDLE && stepper->position == 22000);
+	CHECK(stepper->slips > 0);
+	CHECK(rate < 40000 && rate > 20000);
+}
+
+
+int main(void)
+{
+	test_servo_frames();
+	test_servo_slip();
+	test_stepper_rate();
+
+	return test_result();
+}
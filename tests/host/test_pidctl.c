@@ -0,0 +1,171 @@
+/*
+************************************************************
+* PIDCTL Host Test                                         *
+* (Step responses and saturation of the control loops)     *
+************************************************************
+* File:    test_pidctl.c                                   *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+/**
+ * The loops run in the Timer2 ISR of pwmfx, like on the target, and write the OC1 registers.
+ * The plant is a first-order lag on the duty read back from the registers:
+ *
+ *   y[n+1] = y[n] + alpha * (gain * 1023 * duty[n] - y[n])      (ADC units)
+ */
+
+#include <pidctl.h>
+#include "test.h"
+
+#define TEST_PR			1599		/** 10 kHz at 1:1	*/
+
+void _T2Interrupt(void);
+
+static double _test_y;
+
+
+int16_t analog_read_raw(analog_num_t analog_num)
+{
+	return (int16_t)(_test_y + 0.5);
+}
+
+
+static double test_duty(void)
+{
+	return (double)pwmfx_get_duty_ticks(PWM_NUM_0) / (TEST_PR + 1);
+}
+
+
+static void test_setup(double y, uint16_t duty_ticks, int16_t kp, int16_t ki, int16_t kd, int16_t setpoint)
+{
+	PR2    = TEST_PR;
+	T2CON  = 0x8000;
+	TMR2   = 0;
+	IFS0   = 0;
+	IEC0   = 0;
+	OC1CON = 0x0005;
+	OC1R   = 0;
+	OC1RS  = 0;
+	_test_pwm[PWM_NUM_0].group = PWM_GROUP_A;
+	_test_y = y;
+	pwmfx_set_duty_ticks(PWM_NUM_0, duty_ticks);
+
+	pidctl_create(PIDCTL_NUM_0, ANALOG_NUM_0, PWM_NUM_0, kp, ki, kd);
+	pidctl_set_setpoint(PIDCTL_NUM_0, setpoint);
+	pidctl_enable(PIDCTL_NUM_0, true);
+	pidctl_init(PWM_GROUP_A, 1);
+}
+
+
+/**
+ * Runs the loop for `samples` periods on the plant, returns the largest y.
+ */
+static double test_run(int samples, double gain, double alpha)
+{
+	double peak = _test_y;
+	int n;
+
+	for (n = 0; n < samples; n++)
+	{
+		IFS0 |= 1 << 7;
+		_T2Interrupt();
+		_test_y += alpha * (gain * 1023.0 * test_duty() - _test_y);
+		if (_test_y > peak)
+		{
+			peak = _test_y;
+		}
+	}
+	return peak;
+}
+
+
+static void test_step_p(void)
+{
+	/** P only: y = kp * (r - y), the steady state is r * kp / (1 + kp) */
+	test_setup(0, 0, PIDCTL_GAIN(2.0), 0, 0, PIDCTL_ADC_TO_Q15(600));
+	test_run(500, 1.0, 0.05);
+	printf("P step:      y = %6.1f (expected %6.1f)\n", _test_y, 600 * 2.0 / 3.0);
+	CHECK(_test_y > 400 - 3 && _test_y < 400 + 3);
+	CHECK(!pidctl_get_object(PIDCTL_NUM_0)->saturated);
+}
+
+
+static void test_step_pi(void)
+{
+	double peak;
+
+	/** The integral removes the steady-state error */
+	test_setup(0, 0, PIDCTL_GAIN(1.0), PIDCTL_GAIN(0.1), 0, PIDCTL_ADC_TO_Q15(512));
+	peak = test_run(1000, 1.0, 0.05);
+	printf("PI step:     y = %6.1f, peak %6.1f (setpoint 512)\n", _test_y, peak);
+	CHECK(_test_y > 512 - 1.5 && _test_y < 512 + 1.5);
+	CHECK(peak < 512 * 1.25);
+
+	/** Bumpless: re-enabling at the current duty does not move the output */
+	double duty = test_duty();
+	pidctl_enable(PIDCTL_NUM_0, false);
+	pidctl_enable(PIDCTL_NUM_0, true);
+	test_run(1, 1.0, 0.05);
+	CHECK(test_duty() > duty - 0.01 && test_duty() < duty + 0.01);
+}
+
+
+static void test_windup(void)
+{
+	/** The plant reaches 511 at most: the output saturates, the integral is held at the limit */
+	test_setup(0, 0, PIDCTL_GAIN(1.0), PIDCTL_GAIN(0.1), 0, PIDCTL_ADC_TO_Q15(800));
+	test_run(2000, 0.5, 0.05);
+	CHECK(pidctl_get_object(PIDCTL_NUM_0)->saturated);
+	CHECK(pidctl_get_object(PIDCTL_NUM_0)->duty == PWMFX_Q15_ONE);
+	CHECK(pidctl_get_object(PIDCTL_NUM_0)->integral <= (int32_t)PWMFX_Q15_ONE << 8);
+
+	/** No wound-up integral to unwind, the new setpoint is reached without a long overshoot */
+	pidctl_set_setpoint(PIDCTL_NUM_0, PIDCTL_ADC_TO_Q15(300));
+	test_run(300, 0.5, 0.05);
+	printf("Windup:      y = %6.1f after 300 samples (setpoint 300)\n", _test_y);
+	CHECK(_test_y > 300 - 3 && _test_y < 300 + 3);
+}
+
+
+static void test_saturation(void)
+{
+	/** kp * e and -kd * dy are both near +2^30, with the integral at 1.0 (2^23) the sum overflows int32 */
+	test_setup(1023, TEST_PR + 1, INT16_MAX, 0, INT16_MAX, INT16_MAX);
+	_test_y = 0;
+	test_run(1, 0.0, 0.0);
+	CHECK(pidctl_get_object(PIDCTL_NUM_0)->duty == PWMFX_Q15_ONE);
+	CHECK(test_duty() == 1.0);
+
+	/** Both terms near -2^30: clamped low */
+	test_setup(0, (TEST_PR + 1) / 2, INT16_MAX, 0, INT16_MAX, INT16_MIN);
+	_test_y = 1023;
+	test_run(1, 0.0, 0.0);
+	CHECK(pidctl_get_object(PIDCTL_NUM_0)->duty == 0);
+
+	/** setpoint - y = -65504 does not fit int16_t, it is limited instead of wrapping to +32 */
+	test_setup(1023, (TEST_PR + 1) / 2, PIDCTL_GAIN(1.0), 0, 0, INT16_MIN);
+	test_run(1, 0.0, 0.0);
+	CHECK(pidctl_get_object(PIDCTL_NUM_0)->duty == 0);
+
+	/** The limits of pidctl_set_limits() apply to the saturated sums */
+	test_setup(1023, TEST_PR + 1, INT16_MAX, 0, INT16_MAX, INT16_MAX);
+	pidctl_set_limits(PIDCTL_NUM_0, PWMFX_Q15(0.1), PWMFX_Q15(0.9));
+	_test_y = 0;
+	test_run(1, 0.0, 0.0);
+	CHECK(pidctl_get_object(PIDCTL_NUM_0)->duty == PWMFX_Q15(0.9));
+}
+
+
+int main(void)
+{
+	test_step_p();
+	test_step_pi();
+	test_windup();
+	test_saturation();
+
+	return test_result();
+}
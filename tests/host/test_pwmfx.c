@@ -0,0 +1,286 @@
+/*
+************************************************************
+* PWMFX Host Test                                          *
+* (Staged updates on a register model of Timer2 and OCx)   *
+************************************************************
+* File:    test_pwmfx.c                                    *
+* Author:  Asst.Prof.Dr.Santi Nuratch                      *
+*          Embedded Computing and Control Laboratory       *
+*          ECC-Lab, INC, KMUTT, Thailand                   *
+* Update:  19 October 2026                                 *
+************************************************************
+*/
+
+/**
+ * The model counts Timer2 tick by tick and drives the outputs of OC1-OC3 in the dual-compare
+ * continuous-pulse mode: the output rises when TMR2 matches OCxR and falls when it matches OCxRS.
+ * The period interrupt is taken `latency` ticks after the period starts, like an ISR entry.
+ *
+ * Every period, the output of each channel is compared with the output of the same period
+ * written at its exact start (the registers at the end of the period applied from tick 0).
+ * Any difference is a partial update: an old edge mixed with new values, or a new edge missed.
+ * The registers of all channels of a commit must change in the same period.
+ */
+
+#include <stdlib.h>
+#include <pwmfx.h>
+#include "test.h"
+
+#define TEST_PR				1999
+#define TEST_CHANNELS		3
+#define TEST_PERIODS		4000
+#define TEST_EDGE_MIN		PWMFX_STAGE_EDGE_MIN_CYCLES		/** 1:1 prescaler	*/
+
+void _T2Interrupt(void);
+
+
+static volatile uint16_t *test_oc(int ch)
+{
+	return &OC1RS + 3 * ch;
+}
+
+
+/**
+ * One timer tick of an OC output.
+ */
+static int test_oc_tick(int level, uint16_t tmr, uint16_t rise, uint16_t fall)
+{
+	if (tmr == rise)
+	{
+		level = 1;
+	}
+	if (tmr == fall)
+	{
+		level = 0;
+	}
+	return level;
+}
+
+
+/**
+ * Compare values of a staged channel as documented in pwmfx.h.
+ */
+static void test_expected(uint16_t shift, uint16_t duty, uint16_t *rise, uint16_t *fall)
+{
+	uint32_t period = TEST_PR + 1;
+	uint32_t r = (shift < TEST_EDGE_MIN) ? TEST_EDGE_MIN : shift;
+	uint32_t f;
+
+	if (r > TEST_PR)
+	{
+		r = TEST_PR;
+	}
+	if (duty >= period)
+	{
+		f = period;
+	}
+	else
+	{
+		f = r + duty;
+		if (f >= period)
+		{
+			f -= period;
+		}
+	}
+	if (f < TEST_EDGE_MIN)
+	{
+		f = (TEST_EDGE_MIN < r) ? TEST_EDGE_MIN : period;
+	}
+	*rise = (uint16_t)r;
+	*fall = (uint16_t)f;
+}
+
+
+static void test_setup(void)
+{
+	int ch;
+
+	PR2 = TEST_PR;
+	TMR2 = 0;
+	T2CON = 0x8000;
+	IFS0 = 0;
+	IEC0 = 0;
+	for (ch = 0; ch < PWM_NUM_COUNT; ch++)
+	{
+		_test_pwm[ch].id    = (pwm_num_t)ch;
+		_test_pwm[ch].group = (ch < TEST_CHANNELS) ? PWM_GROUP_A : PWM_GROUP_B;
+		test_oc(ch)[0] = 0;
+		test_oc(ch)[1] = 0;
+		test_oc(ch)[2] = (ch < TEST_CHANNELS) ? 0x0005 : 0;
+	}
+}
+
+
+/**
+ * Runs random staged updates, returns the number of periods with a partial update.
+ * Parameters:
+ * - latency_max: Largest ISR latency in ticks, random per period.
+ * - shift_max: Largest requested shift, small shifts make the early edges likely.
+ */
+static int test_run(uint16_t latency_max, uint16_t shift_max, bool check_values)
+{
+	int level[TEST_CHANNELS] = { 0 };
+	int trace[TEST_CHANNELS][TEST_PR + 1];
+	uint16_t expect_rise[TEST_CHANNELS], expect_fall[TEST_CHANNELS];
+	uint16_t expect_mask = 0;
+	int partial = 0;
+	int period, ch;
+
+	test_setup();
+	for (period = 0; period < TEST_PERIODS; period++)
+	{
+		int carry[TEST_CHANNELS];
+		uint16_t latency = (uint16_t)(rand() % (latency_max + 1));
+		uint16_t commit_at = (uint16_t)(latency + 1 + rand() % (TEST_PR - latency));
+		uint16_t t;
+
+		for (ch = 0; ch < TEST_CHANNELS; ch++)
+		{
+			carry[ch] = level[ch];
+		}
+
+		for (t = 0; t <= TEST_PR; t++)
+		{
+			TMR2 = t;
+			if (t == latency && (IFS0 & (1 << 7)) && (IEC0 & (1 << 7)))
+			{
+				_T2Interrupt();
+				CHECK(pwmfx_get_pending() == 0);
+				if (check_values)
+				{
+					/** All channels of the commit change in this period */
+					for (ch = 0; ch < TEST_CHANNELS; ch++)
+					{
+						if (expect_mask & (1 << ch))
+						{
+							CHECK(test_oc(ch)[1] == expect_rise[ch] && test_oc(ch)[0] == expect_fall[ch]);
+						}
+					}
+				}
+				expect_mask = 0;
+			}
+
+			if (t == commit_at && (rand() & 3) == 0)
+			{
+				uint16_t mask = (uint16_t)(1 + rand() % ((1 << TEST_CHANNELS) - 1));
+				for (ch = 0; ch < TEST_CHANNELS; ch++)
+				{
+					if (mask & (1 << ch))
+					{
+						uint16_t shift = (uint16_t)(rand() % (shift_max + 1));
+						uint16_t duty  = (uint16_t)(rand() % (TEST_PR + 2));
+						pwmfx_stage_ticks((pwm_num_t)ch, shift, duty);
+						test_expected(shift, duty, &expect_rise[ch], &expect_fall[ch]);
+					}
+				}
+				pwmfx_commit(mask);
+				expect_mask |= mask;
+			}
+
+			for (ch = 0; ch < TEST_CHANNELS; ch++)
+			{
+				level[ch] = test_oc_tick(level[ch], t, test_oc(ch)[1], test_oc(ch)[0]);
+				trace[ch][t] = level[ch];
+			}
+		}
+		/** End of the period, the timer interrupt flag is set */
+		IFS0 |= 1 << 7;
+
+		/** The same period written at its start */
+		for (ch = 0; ch < TEST_CHANNELS; ch++)
+		{
+			int ideal = carry[ch];
+			bool same = true;
+			for (t = 0; t <= TEST_PR; t++)
+			{
+				ideal = test_oc_tick(ideal, t, test_oc(ch)[1], test_oc(ch)[0]);
+				if (ideal != trace[ch][t])
+				{
+					same = false;
+				}
+			}
+			if (!same)
+			{
+				partial++;
+			}
+		}
+	}
+	return partial;
+}
+
+
+static void test_stage_limits(void)
+{
+	test_setup();
+
+	/** A shift of 0 is moved to the earliest edge, the duty is kept */
+	pwmfx_stage_ticks(PWM_NUM_0, 0, 100);
+	/** The active time wraps to tick 50 of the next period, it is extended to the earliest edge */
+	pwmfx_stage_ticks(PWM_NUM_1, 1950, 100);
+	/** The wrapped end is not later than the rise, the output stays high */
+	pwmfx_stage_ticks(PWM_NUM_2, 0, 1990);
+	pwmfx_commit(0x0007);
+	CHECK(pwmfx_get_pending() == 0x0007);
+	CHECK(OC1R == 0 && OC1RS == 0);
+
+	IFS0 |= 1 << 7;
+	_T2Interrupt();
+	CHECK(pwmfx_get_pending() == 0);
+	CHECK(test_oc(0)[1] == TEST_EDGE_MIN && test_oc(0)[0] == TEST_EDGE_MIN + 100);
+	CHECK(test_oc(1)[1] == 1950 && test_oc(1)[0] == TEST_EDGE_MIN);
+	CHECK(test_oc(2)[1] == TEST_EDGE_MIN && test_oc(2)[0] == TEST_PR + 1);
+	CHECK((IEC0 & (1 << 7)) == 0);
+}
+
+
+static bool _test_period_end;
+
+static void test_long_handler(pwm_group_t pwm_group)
+{
+	/** The next period ends while the handlers run */
+	IFS0 |= 1 << 7;
+	_test_period_end = true;
+}
+
+
+static void test_flag_order(void)
+{
+	test_setup();
+	pwmfx_period_attach(PWM_GROUP_A, PWMFX_PERIOD_SLOT_CONTROL, test_long_handler);
+	CHECK((IEC0 & (1 << 7)) != 0);
+
+	IFS0 |= 1 << 7;
+	_test_period_end = false;
+	_T2Interrupt();
+	CHECK(_test_period_end);
+	CHECK((IFS0 & (1 << 7)) != 0);
+
+	pwmfx_period_attach(PWM_GROUP_A, PWMFX_PERIOD_SLOT_CONTROL, NULL);
+	CHECK((IEC0 & (1 << 7)) == 0);
+}
+
+
+int main(void)
+{
+	int partial;
+
+	srand(224);
+
+	test_stage_limits();
+	test_flag_order();
+
+	partial = test_run(TEST_EDGE_MIN - 1, TEST_PR, true);
+	printf("staged updates, latency < %d ticks: %d partial periods\n", TEST_EDGE_MIN, partial);
+	CHECK(partial == 0);
+
+	partial = test_run(TEST_EDGE_MIN - 1, 2 * TEST_EDGE_MIN, true);
+	printf("staged updates, early shifts:      %d partial periods\n", partial);
+	CHECK(partial == 0);
+
+	/** The model detects partial updates when the ISR is later than the earliest edge */
+	partial = test_run(3 * TEST_EDGE_MIN, 2 * TEST_EDGE_MIN, false);
+	printf("model check, late ISR:             %d partial periods\n", partial);
+	CHECK(partial > 0);
+
+	return test_result();
+}
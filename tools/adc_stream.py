@@ -0,0 +1,160 @@
+#!/usr/bin/env python3
+"""
+ADC stream receiver of the Ternion board (see core/Trn/Inc/stream.h).
+
+Reads the packed stream frames from a serial port (or a raw capture file),
+writes the samples to a CSV file and reports the sustained throughput,
+sequence gaps and CRC errors.
+
+Usage:
+    python adc_stream.py --port /dev/tty.usbserial-140 --baud 115200 --out adc.csv
+    python adc_stream.py --file raw.bin --out adc.csv
+
+Requires pyserial when reading from a serial port.
+"""
+
+import argparse
+import struct
+import sys
+import time
+
+SYNC = b"\xA5\x5A"
+HEADER_SIZE = 12
+CHANNEL_COUNT = 6
+
+
+def crc16(data, crc=0xFFFF):
+    """CRC-16/CCITT-FALSE, the same as crc16_compute() of the firmware."""
+    for byte in data:
+        x = ((crc >> 8) ^ byte) & 0xFF
+        x ^= x >> 4
+        crc = ((crc << 8) ^ (x << 12) ^ (x << 5) ^ x) & 0xFFFF
+    return crc
+
+
+def unpack_samples(payload, count):
+    """Unpacks 10-bit samples, 4 samples in 5 bytes."""
+    samples = []
+    for i in range(0, len(payload) - 4, 5):
+        high = payload[i + 4]
+        for k in range(4):
+            samples.append(payload[i + k] | (((high >> (2 * k)) & 0x03) << 8))
+    return samples[:count]
+
+
+def frame_length(mask, records):
+    channels = bin(mask & ((1 << CHANNEL_COUNT) - 1)).count("1")
+    samples = channels * records
+    return HEADER_SIZE + ((samples + 3) // 4) * 5 + 2, channels, samples
+
+
+class Receiver:
+    def __init__(self, writer):
+        self.writer = writer
+        self.buffer = bytearray()
+        self.frames = 0
+        self.samples = 0
+        self.gaps = 0
+        self.lost_frames = 0
+        self.crc_errors = 0
+        self.sequence = None
+        self.columns = None
+
+    def feed(self, data):
+        self.buffer.extend(data)
+        while True:
+            start = self.buffer.find(SYNC)
+            if start < 0:
+                del self.buffer[:-1]
+                return
+            del self.buffer[:start]
+            if len(self.buffer) < HEADER_SIZE:
+                return
+            sequence, timestamp, mask, records, interval = struct.unpack_from("<HIBBH", self.buffer, 2)
+            length, channels, count = frame_length(mask, records)
+            if channels == 0 or records == 0:
+                del self.buffer[:2]
+                continue
+            if len(self.buffer) < length:
+                return
+            frame = bytes(self.buffer[:length])
+            if crc16(frame[:-2]) != struct.unpack_from("<H", frame, length - 2)[0]:
+                self.crc_errors += 1
+                del self.buffer[:2]
+                continue
+            del self.buffer[:length]
+            self.on_frame(sequence, timestamp, mask, records, interval, unpack_samples(frame[HEADER_SIZE:-2], count), channels)
+
+    def on_frame(self, sequence, timestamp, mask, records, interval, samples, channels):
+        if self.sequence is not None:
+            missing = (sequence - self.sequence - 1) & 0xFFFF
+            if missing:
+                self.gaps += 1
+                self.lost_frames += missing
+        self.sequence = sequence
+
+        if self.columns is None:
+            self.columns = [n for n in range(CHANNEL_COUNT) if mask & (1 << n)]
+            self.writer.write("sequence,time_ms," + ",".join("ch%d" % n for n in self.columns) + "\n")
+
+        for r in range(records):
+            row = samples[r * channels:(r + 1) * channels]
+            self.writer.write("%d,%d,%s\n" % (sequence, timestamp + r * interval, ",".join(map(str, row))))
+
+        self.frames += 1
+        self.samples += len(samples)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Ternion ADC stream receiver")
+    parser.add_argument("--port", help="serial port, e.g. COM3 or /dev/tty.usbserial-140")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--file", help="read a raw stream capture instead of a serial port")
+    parser.add_argument("--out", default="adc_stream.csv", help="output CSV file")
+    parser.add_argument("--duration", type=float, default=0, help="stop after N seconds (0: until Ctrl+C)")
+    args = parser.parse_args()
+
+    if not args.port and not args.file:
+        parser.error("--port or --file is required")
+
+    with open(args.out, "w") as writer:
+        receiver = Receiver(writer)
+        received = 0
+        start = time.time()
+        report = start
+
+        try:
+            if args.file:
+                with open(args.file, "rb") as source:
+                    data = source.read()
+                    received = len(data)
+                    receiver.feed(data)
+            else:
+                import serial
+                with serial.Serial(args.port, args.baud, timeout=0.1) as port:
+                    while not args.duration or time.time() - start < args.duration:
+                        data = port.read(4096)
+                        received += len(data)
+                        receiver.feed(data)
+                        now = time.time()
+                        if now - report >= 1.0:
+                            report = now
+                            elapsed = now - start
+                            sys.stderr.write("\r%8.1f s  %9.0f samples/s  %7.0f B/s  gaps %d  lost %d  crc %d " % (
+                                elapsed, receiver.samples / elapsed, received / elapsed,
+                                receiver.gaps, receiver.lost_frames, receiver.crc_errors))
+        except KeyboardInterrupt:
+            pass
+
+        elapsed = max(time.time() - start, 1e-9)
+        sys.stderr.write("\n")
+        print("frames:      %d" % receiver.frames)
+        print("samples:     %d" % receiver.samples)
+        print("gaps:        %d (%d frames lost)" % (receiver.gaps, receiver.lost_frames))
+        print("crc errors:  %d" % receiver.crc_errors)
+        if not args.file:
+            print("throughput:  %.0f samples/s, %.0f bytes/s" % (receiver.samples / elapsed, received / elapsed))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,424 @@
+#!/usr/bin/env python3
+"""
+Binary RPC client of the Ternion board (see core/Trn/Inc/rpc.h).
+
+The client pipelines the requests: up to `window` requests are in flight and
+the responses are matched by their request id. The same client runs on a
+serial port or on a simulated serial link (byte times of the baudrate and the
+service time of the firmware main loop), which is used by the round-trip
+latency benchmark.
+
+Usage:
+    python rpc_client.py --sim --baud 115200 --count 2000
+    python rpc_client.py --port /dev/tty.usbserial-140 --baud 115200 --count 2000
+
+    from rpc_client import RpcClient, SerialTransport
+    client = RpcClient(SerialTransport("COM3", 115200))
+    client.pwm_duty(0, 0x4000)
+    print(client.analog(0))
+    client.batch([(OP_PWM_DUTY, struct.pack("<BH", 0, 0x2000)),
+                  (OP_PWM_DUTY, struct.pack("<BH", 1, 0x6000))])   # same tick, same PWM period
+
+Requires pyserial when a serial port is used.
+"""
+
+import argparse
+import collections
+import struct
+import sys
+import time
+
+SYNC = 0xA5
+SYNC_REQUEST = 0xC3
+SYNC_RESPONSE = 0xC4
+STREAM_SYNC = 0x5A
+
+OP_PING = 0x01
+OP_PWM_DUTY = 0x10
+OP_PWM_Q15 = 0x11
+OP_ANALOG = 0x20
+OP_ANALOG_ALL = 0x21
+OP_GPIO_WRITE = 0x30
+OP_GPIO_READ = 0x31
+OP_BATCH = 0x40
+
+STATUS_NAMES = ["OK", "UNKNOWN_OPCODE", "BAD_LENGTH", "BAD_ARGUMENT", "FAILED"]
+
+ANALOG_NUM_COUNT = 6
+ARG_MAX = 32
+BATCH_MAX = 8
+BATCH_NONE = 0xFF
+
+# Argument sizes of the built-in opcodes.
+ARG_SIZES = {OP_PING: 0, OP_PWM_DUTY: 3, OP_PWM_Q15: 5, OP_ANALOG: 1, OP_ANALOG_ALL: 0, OP_GPIO_WRITE: 2, OP_GPIO_READ: 1}
+
+
+def crc16(data, crc=0xFFFF):
+    """CRC-16/CCITT-FALSE, the same as crc16_compute() of the firmware."""
+    for byte in data:
+        x = ((crc >> 8) ^ byte) & 0xFF
+        x ^= x >> 4
+        crc = ((crc << 8) ^ (x << 12) ^ (x << 5) ^ x) & 0xFFFF
+    return crc
+
+
+def encode_request(request_id, opcode, args=b""):
+    frame = bytes([SYNC, SYNC_REQUEST, request_id & 0xFF, opcode, len(args)]) + bytes(args)
+    return frame + struct.pack("<H", crc16(frame))
+
+
+def encode_response(request_id, opcode, status, result=b""):
+    frame = bytes([SYNC, SYNC_RESPONSE, request_id, opcode, status, len(result)]) + bytes(result)
+    return frame + struct.pack("<H", crc16(frame))
+
+
+class RpcError(Exception):
+    pass
+
+
+class ResponseParser:
+    """Finds the response frames in the received bytes, other bytes (text, stream frames) are skipped."""
+
+    def __init__(self):
+        self.buffer = bytearray()
+        self.crc_errors = 0
+
+    def feed(self, data):
+        self.buffer.extend(data)
+        responses = []
+        while True:
+            start = self.buffer.find(bytes([SYNC, SYNC_RESPONSE]))
+            if start < 0:
+                del self.buffer[:-1]
+                return responses
+            del self.buffer[:start]
+            if len(self.buffer) < 6:
+                return responses
+            length = self.buffer[5]
+            size = 6 + length + 2
+            if len(self.buffer) < size:
+                return responses
+            frame = bytes(self.buffer[:size])
+            if crc16(frame[:-2]) != struct.unpack_from("<H", frame, size - 2)[0]:
+                self.crc_errors += 1
+                del self.buffer[:2]
+                continue
+            del self.buffer[:size]
+            responses.append((frame[2], frame[3], frame[4], frame[6:6 + length]))
+
+
+class SerialTransport:
+    """pyserial port with the clock of the host."""
+
+    def __init__(self, port, baud):
+        import serial
+        self.port = serial.Serial(port, baud, timeout=0)
+
+    def now(self):
+        return time.perf_counter()
+
+    def write(self, data):
+        self.port.write(data)
+
+    def read(self, timeout):
+        deadline = time.perf_counter() + timeout
+        while True:
+            data = self.port.read(4096)
+            if data or time.perf_counter() >= deadline:
+                return data
+
+
+class DeviceModel:
+    """Python model of the firmware request handling (rpc_handle), with simulated inputs."""
+
+    def __init__(self):
+        self.duty = [0] * 5
+        self.shift = [0] * 5
+        self.gpio = {}
+        self.buffer = bytearray()
+        self.requests = 0
+
+    def analog(self, channel):
+        return (100 * (channel + 1) + self.requests) & 0x3FF
+
+    def handle(self, frame):
+        request_id, opcode, length = frame[2], frame[3], frame[4]
+        args = frame[5:5 + length]
+        self.requests += 1
+        if opcode == OP_BATCH:
+            status, result = self.batch(args)
+            return encode_response(request_id, opcode, status, result)
+        if opcode not in ARG_SIZES:
+            return encode_response(request_id, opcode, 1)
+        if length != ARG_SIZES[opcode]:
+            return encode_response(request_id, opcode, 2)
+        return self.execute(request_id, opcode, args)
+
+    def batch(self, args):
+        commands = []
+        offset = 0
+        while offset < len(args):
+            opcode = args[offset]
+            if opcode not in ARG_SIZES:
+                return 1, bytes([len(commands), len(commands)])
+            size = ARG_SIZES[opcode]
+            if len(commands) >= BATCH_MAX or offset + 1 + size > len(args):
+                return 2, bytes([len(commands), len(commands)])
+            commands.append((opcode, args[offset + 1:offset + 1 + size]))
+            offset += 1 + size
+        # Like the check pass of the firmware: nothing is applied if one command fails
+        saved = (list(self.duty), list(self.shift), dict(self.gpio))
+        for i, (opcode, command_args) in enumerate(commands):
+            command_status = self.execute(0, opcode, command_args)[4]
+            if command_status:
+                self.duty, self.shift, self.gpio = saved
+                return command_status, bytes([len(commands), i])
+        return 0, bytes([len(commands), BATCH_NONE])
+
+    def execute(self, request_id, opcode, args):
+        if opcode == OP_PING:
+            return encode_response(request_id, opcode, 0, struct.pack("<I", self.requests))
+        if opcode == OP_PWM_DUTY:
+            pwm, duty = struct.unpack("<BH", args)
+            if pwm >= 5 or duty > 0x8000:
+                return encode_response(request_id, opcode, 3)
+            self.duty[pwm] = duty
+            return encode_response(request_id, opcode, 0)
+        if opcode == OP_PWM_Q15:
+            pwm, shift, duty = struct.unpack("<BHH", args)
+            if pwm >= 5 or shift > 0x8000 or duty > 0x8000:
+                return encode_response(request_id, opcode, 3)
+            self.shift[pwm], self.duty[pwm] = shift, duty
+            return encode_response(request_id, opcode, 0)
+        if opcode == OP_ANALOG:
+            if args[0] >= ANALOG_NUM_COUNT:
+                return encode_response(request_id, opcode, 3)
+            return encode_response(request_id, opcode, 0, struct.pack("<H", self.analog(args[0])))
+        if opcode == OP_ANALOG_ALL:
+            return encode_response(request_id, opcode, 0, struct.pack("<%dH" % ANALOG_NUM_COUNT, *[self.analog(n) for n in range(ANALOG_NUM_COUNT)]))
+        if opcode == OP_GPIO_WRITE:
+            self.gpio[args[0]] = args[1]
+            return encode_response(request_id, opcode, 0)
+        return encode_response(request_id, opcode, 0, bytes([self.gpio.get(args[0], 0)]))
+
+    def feed(self, byte):
+        """Returns the response frame when the byte completes a request."""
+        self.buffer.append(byte)
+        if self.buffer[0] != SYNC or (len(self.buffer) > 1 and self.buffer[1] != SYNC_REQUEST):
+            self.buffer.clear()
+            return None
+        if len(self.buffer) < 5:
+            return None
+        if self.buffer[4] > ARG_MAX:
+            self.buffer.clear()
+            return None
+        size = 5 + self.buffer[4] + 2
+        if len(self.buffer) < size:
+            return None
+        frame = bytes(self.buffer)
+        self.buffer.clear()
+        if crc16(frame[:-2]) != struct.unpack_from("<H", frame, size - 2)[0]:
+            return None
+        return self.handle(frame)
+
+
+class SimulatedLink:
+    """
+    Full-duplex serial link with virtual time: each byte takes 10 bit times, the firmware
+    handles the requests in order, `service` seconds after the last byte of the request
+    (main loop latency and handler time).
+    """
+
+    def __init__(self, baud=115200, service=100e-6):
+        self.byte_time = 10.0 / baud
+        self.service = service
+        self.device = DeviceModel()
+        self.clock = 0.0
+        self.host_tx_free = 0.0
+        self.device_free = 0.0
+        self.device_tx_free = 0.0
+        self.pending = collections.deque()   # (arrival time at the host, bytes)
+
+    def now(self):
+        return self.clock
+
+    def write(self, data):
+        start = max(self.clock, self.host_tx_free)
+        for i, byte in enumerate(data):
+            arrival = start + (i + 1) * self.byte_time
+            response = self.device.feed(byte)
+            if response is not None:
+                handled = max(arrival, self.device_free) + self.service
+                self.device_free = handled
+                send = max(handled, self.device_tx_free)
+                self.device_tx_free = send + len(response) * self.byte_time
+                self.pending.append((self.device_tx_free, response))
+        self.host_tx_free = start + len(data) * self.byte_time
+
+    def read(self, timeout):
+        if not self.pending:
+            self.clock += timeout
+            return b""
+        arrival, data = self.pending[0]
+        if arrival > self.clock + timeout:
+            self.clock += timeout
+            return b""
+        self.clock = max(self.clock, arrival)
+        received = bytearray()
+        while self.pending and self.pending[0][0] <= self.clock:
+            received.extend(self.pending.popleft()[1])
+        return bytes(received)
+
+
+class RpcClient:
+    def __init__(self, transport, window=8, timeout=0.5):
+        self.transport = transport
+        self.window = window
+        self.timeout = timeout
+        self.parser = ResponseParser()
+        self.next_id = 0
+        self.inflight = collections.OrderedDict()   # id -> (opcode, send time)
+        self.results = {}
+        self.latencies = []
+
+    def submit(self, opcode, args=b""):
+        """Sends a request without waiting for its response, returns the request id."""
+        while len(self.inflight) >= self.window:
+            self.poll(self.timeout, raise_timeout=True)
+        request_id = self.next_id
+        self.next_id = (self.next_id + 1) & 0xFF
+        if request_id in self.inflight:
+            raise RpcError("request id %d is still in flight" % request_id)
+        self.inflight[request_id] = (opcode, self.transport.now())
+        self.transport.write(encode_request(request_id, opcode, args))
+        return request_id
+
+    def poll(self, timeout=0.0, raise_timeout=False):
+        """Reads the responses, returns the number of completed requests."""
+        data = self.transport.read(timeout)
+        completed = 0
+        for request_id, opcode, status, result in self.parser.feed(data):
+            entry = self.inflight.pop(request_id, None)
+            if entry is None or entry[0] != opcode:
+                continue
+            self.latencies.append(self.transport.now() - entry[1])
+            self.results[request_id] = (status, result)
+            completed += 1
+        if raise_timeout and not completed and self.inflight:
+            oldest = next(iter(self.inflight.items()))
+            if self.transport.now() - oldest[1][1] > self.timeout:
+                raise RpcError("request %d timed out" % oldest[0])
+        return completed
+
+    def wait(self, request_id):
+        """Waits for the response of the request, returns its result bytes."""
+        while request_id not in self.results:
+            if request_id not in self.inflight:
+                raise RpcError("unknown request %d" % request_id)
+            self.poll(self.timeout, raise_timeout=True)
+        status, result = self.results.pop(request_id)
+        if status != 0:
+            name = STATUS_NAMES[status] if status < len(STATUS_NAMES) else str(status)
+            raise RpcError("request %d failed: %s" % (request_id, name))
+        return result
+
+    def drain(self):
+        while self.inflight:
+            self.poll(self.timeout, raise_timeout=True)
+
+    def call(self, opcode, args=b""):
+        return self.wait(self.submit(opcode, args))
+
+    def ping(self):
+        return struct.unpack("<I", self.call(OP_PING))[0]
+
+    def pwm_duty(self, pwm, duty_q15):
+        self.call(OP_PWM_DUTY, struct.pack("<BH", pwm, duty_q15))
+
+    def pwm_q15(self, pwm, shift_q15, duty_q15):
+        self.call(OP_PWM_Q15, struct.pack("<BHH", pwm, shift_q15, duty_q15))
+
+    def analog(self, channel):
+        return struct.unpack("<H", self.call(OP_ANALOG, bytes([channel])))[0]
+
+    def analog_all(self):
+        return list(struct.unpack("<%dH" % ANALOG_NUM_COUNT, self.call(OP_ANALOG_ALL)))
+
+    def gpio_write(self, gpio, level):
+        self.call(OP_GPIO_WRITE, bytes([gpio, 1 if level else 0]))
+
+    def gpio_read(self, gpio):
+        return self.call(OP_GPIO_READ, bytes([gpio]))[0]
+
+    def batch(self, commands):
+        """
+        Applies the (opcode, args) commands together, none if one of them fails, e.g.
+        client.batch([(OP_PWM_DUTY, struct.pack("<BH", 0, 0x2000)), (OP_GPIO_WRITE, bytes([17, 1]))]).
+        Returns the number of commands, raises RpcError with the index of the failed command.
+        """
+        args = b"".join(bytes([opcode]) + bytes(command_args) for opcode, command_args in commands)
+        if len(commands) > BATCH_MAX or len(args) > ARG_MAX:
+            raise RpcError("batch of %d commands, %d bytes is too large" % (len(commands), len(args)))
+        request_id = self.submit(OP_BATCH, args)
+        while request_id not in self.results:
+            self.poll(self.timeout, raise_timeout=True)
+        status, result = self.results.pop(request_id)
+        if status != 0:
+            name = STATUS_NAMES[status] if status < len(STATUS_NAMES) else str(status)
+            raise RpcError("batch failed at command %d: %s" % (result[1], name))
+        return result[0]
+
+
+def benchmark(make_transport, count, windows):
+    """Alternates set-PWM and read-analog requests, reports the round-trip latency per window size."""
+    print("%6s %10s %10s %10s %12s" % ("window", "mean ms", "p50 ms", "p99 ms", "requests/s"))
+    for window in windows:
+        client = RpcClient(make_transport(), window=window)
+        start = client.transport.now()
+        ids = []
+        for i in range(count):
+            if i & 1:
+                ids.append(client.submit(OP_ANALOG, bytes([i % ANALOG_NUM_COUNT])))
+            else:
+                ids.append(client.submit(OP_PWM_DUTY, struct.pack("<BH", 0, (i * 64) & 0x7FFF)))
+            client.poll()
+        client.drain()
+        elapsed = client.transport.now() - start
+        latencies = sorted(client.latencies)
+        if len(latencies) != count:
+            raise RpcError("%d of %d responses received" % (len(latencies), count))
+        print("%6d %10.3f %10.3f %10.3f %12.0f" % (
+            window, 1e3 * sum(latencies) / count, 1e3 * latencies[count // 2],
+            1e3 * latencies[min(count - 1, int(count * 0.99))], count / elapsed))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Ternion binary RPC client and latency benchmark")
+    parser.add_argument("--port", help="serial port, e.g. COM3 or /dev/tty.usbserial-140")
+    parser.add_argument("--sim", action="store_true", help="use the simulated serial link")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--service-us", type=float, default=100.0, help="firmware time per request of the simulated link")
+    parser.add_argument("--count", type=int, default=2000, help="requests per window size")
+    parser.add_argument("--windows", default="1,2,4,8,16", help="numbers of requests in flight")
+    args = parser.parse_args()
+
+    if not args.port and not args.sim:
+        parser.error("--port or --sim is required")
+
+    windows = [int(w) for w in args.windows.split(",")]
+    if args.sim:
+        make_transport = lambda: SimulatedLink(args.baud, args.service_us * 1e-6)
+        print("simulated link: %d baud, %.0f us service time" % (args.baud, args.service_us))
+    else:
+        port = SerialTransport(args.port, args.baud)
+        make_transport = lambda: port
+        print("serial port %s: %d baud" % (args.port, args.baud))
+
+    try:
+        benchmark(make_transport, args.count, windows)
+    except RpcError as error:
+        sys.exit(str(error))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,291 @@
+#!/usr/bin/env python3
+"""
+Live variable watch of the Ternion board (see core/Trn/Inc/watch.h).
+
+Resolves the variables in the symbol table of ternion-app.elf, configures the watch list with
+the `watch` command of cmdex, then records the watch frames to a CSV file and optionally
+plots them. A raw capture of the frames can be decoded with --file.
+
+Variables: name[+offset][:type] or 0xADDRESS:type, type is u8, i8, u16, i16, u32, i32 or f32.
+Without a type, the size of the symbol gives i8, i16 or i32. The C names of XC16 are
+prefixed with '_' in the ELF, both forms are accepted.
+
+Usage:
+    python watch.py --list
+    python watch.py --port /dev/tty.usbserial-140 --interval 10 --out watch.csv speed:i16 gain:f32
+    python watch.py --port COM3 --plot _pidctl+4:i32 0x0852:u16
+    python watch.py --file raw.bin --out watch.csv
+
+Requires pyserial when reading from a serial port and matplotlib for --plot.
+"""
+
+import argparse
+import struct
+import sys
+import time
+
+SYNC = b"\xA5\x57"
+HEADER_SIZE = 9
+ENTRY_MAX = 8
+RAM_START = 0x0800
+RAM_END = 0x2800
+DEFAULT_ELF = "App/Main/build/ternion-app.elf"
+
+TYPES = {"u8": 0x01, "i8": 0x11, "u16": 0x02, "i16": 0x12, "u32": 0x04, "i32": 0x14, "f32": 0x24}
+TYPE_NAMES = {code: name for name, code in TYPES.items()}
+FORMATS = {0x01: "B", 0x11: "b", 0x02: "H", 0x12: "h", 0x04: "I", 0x14: "i", 0x24: "f"}
+
+
+def crc16(data, crc=0xFFFF):
+    """CRC-16/CCITT-FALSE, the same as crc16_compute() of the firmware."""
+    for byte in data:
+        x = ((crc >> 8) ^ byte) & 0xFF
+        x ^= x >> 4
+        crc = ((crc << 8) ^ (x << 12) ^ (x << 5) ^ x) & 0xFFFF
+    return crc
+
+
+def read_symbols(path):
+    """Returns {name: (address, size)} of the data objects in the symbol table of an ELF32 file."""
+    with open(path, "rb") as source:
+        elf = source.read()
+    if elf[:4] != b"\x7fELF" or elf[4] != 1 or elf[5] != 1:
+        raise ValueError("%s is not a little-endian ELF32 file" % path)
+    shoff, = struct.unpack_from("<I", elf, 0x20)
+    shentsize, shnum = struct.unpack_from("<HH", elf, 0x2E)
+    sections = [struct.unpack_from("<IIIIIIIIII", elf, shoff + i * shentsize) for i in range(shnum)]
+
+    symbols = {}
+    for section in sections:
+        if section[1] != 2:                         # SHT_SYMTAB
+            continue
+        strtab = sections[section[6]]               # sh_link
+        for offset in range(section[4], section[4] + section[5], 16):
+            name, value, size, info, _, shndx = struct.unpack_from("<IIIBBH", elf, offset)
+            if (info & 0x0F) != 1 or shndx == 0:    # STT_OBJECT, defined
+                continue
+            start = strtab[4] + name
+            symbol = elf[start:elf.index(b"\0", start)].decode("ascii", "replace")
+            symbols[symbol] = (value, size)
+    return symbols
+
+
+def resolve(spec, symbols):
+    """Returns (label, address, type code) of a variable spec."""
+    target, _, type_name = spec.partition(":")
+    base, _, offset = target.partition("+")
+    offset = int(offset, 0) if offset else 0
+
+    if base[:1].isdigit():
+        address, size = int(base, 0), None
+    else:
+        entry = symbols.get(base) or symbols.get("_" + base)
+        if entry is None:
+            raise ValueError("symbol %s not found" % base)
+        address, size = entry
+    address += offset
+
+    if type_name:
+        if type_name not in TYPES:
+            raise ValueError("unknown type %s" % type_name)
+        code = TYPES[type_name]
+    elif size in (1, 2, 4) and not offset:
+        code = {1: 0x11, 2: 0x12, 4: 0x14}[size]
+    else:
+        raise ValueError("%s needs a type" % spec)
+
+    if address < RAM_START or address + (code & 0x0F) > RAM_END or ((code & 0x0F) > 1 and address & 1):
+        raise ValueError("%s: address 0x%04X is not a watchable RAM address" % (spec, address))
+    return target, address, code
+
+
+class Receiver:
+    def __init__(self, writer, labels=None, plotter=None):
+        self.writer = writer
+        self.labels = labels
+        self.plotter = plotter
+        self.buffer = bytearray()
+        self.frames = 0
+        self.gaps = 0
+        self.lost_frames = 0
+        self.crc_errors = 0
+        self.sequence = None
+        self.types = None
+
+    def feed(self, data):
+        self.buffer.extend(data)
+        while True:
+            start = self.buffer.find(SYNC)
+            if start < 0:
+                del self.buffer[:-1]
+                return
+            del self.buffer[:start]
+            if len(self.buffer) < HEADER_SIZE:
+                return
+            count = self.buffer[8]
+            if count == 0 or count > ENTRY_MAX:
+                del self.buffer[:2]
+                continue
+            if len(self.buffer) < HEADER_SIZE + count:
+                return
+            types = bytes(self.buffer[HEADER_SIZE:HEADER_SIZE + count])
+            if any(t not in FORMATS for t in types):
+                del self.buffer[:2]
+                continue
+            length = HEADER_SIZE + count + sum(t & 0x0F for t in types) + 2
+            if len(self.buffer) < length:
+                return
+            frame = bytes(self.buffer[:length])
+            if crc16(frame[:-2]) != struct.unpack_from("<H", frame, length - 2)[0]:
+                self.crc_errors += 1
+                del self.buffer[:2]
+                continue
+            del self.buffer[:length]
+            sequence, timestamp = struct.unpack_from("<HI", frame, 2)
+            values = struct.unpack_from("<" + "".join(FORMATS[t] for t in types), frame, HEADER_SIZE + count)
+            self.on_frame(sequence, timestamp, types, values)
+
+    def on_frame(self, sequence, timestamp, types, values):
+        if self.sequence is not None:
+            missing = (sequence - self.sequence - 1) & 0xFFFF
+            if missing:
+                self.gaps += 1
+                self.lost_frames += missing
+        self.sequence = sequence
+
+        if self.types != types:
+            self.types = types
+            if not self.labels or len(self.labels) != len(types):
+                self.labels = ["var%d_%s" % (n, TYPE_NAMES[t]) for n, t in enumerate(types)]
+            self.writer.write("sequence,time_ms," + ",".join(self.labels) + "\n")
+            if self.plotter:
+                self.plotter.reset(self.labels)
+
+        self.writer.write("%d,%d,%s\n" % (sequence, timestamp, ",".join(
+            "%g" % v if isinstance(v, float) else str(v) for v in values)))
+        if self.plotter:
+            self.plotter.add(timestamp, values)
+        self.frames += 1
+
+
+class Plotter:
+    """Live plot of the last `window` frames (0: all frames), redrawn every 0.2 s."""
+
+    def __init__(self, window=1000):
+        import matplotlib.pyplot as plt
+        self.plt = plt
+        self.window = window
+        self.figure, self.axes = plt.subplots()
+        self.lines = []
+        self.times = []
+        self.values = []
+        self.drawn = 0.0
+        plt.ion()
+        plt.show()
+
+    def reset(self, labels):
+        self.axes.clear()
+        self.axes.set_xlabel("time (ms)")
+        self.lines = [self.axes.plot([], [], label=label)[0] for label in labels]
+        self.axes.legend(loc="upper left")
+        self.times = []
+        self.values = [[] for _ in labels]
+
+    def add(self, timestamp, values):
+        self.times.append(timestamp)
+        for series, value in zip(self.values, values):
+            series.append(value)
+        if self.window and len(self.times) > self.window:
+            del self.times[0]
+            for series in self.values:
+                del series[0]
+
+    def draw(self):
+        if time.time() - self.drawn < 0.2 or not self.times:
+            return
+        self.drawn = time.time()
+        for line, series in zip(self.lines, self.values):
+            line.set_data(self.times, series)
+        self.axes.relim()
+        self.axes.autoscale_view()
+        self.plt.pause(0.001)
+
+
+def configure(port, variables, interval):
+    """Sends the watch list with the `watch` command, the replies are not waited for."""
+    lines = ["watch stop", "watch clear"]
+    lines += ["watch add 0x%04X %s" % (address, TYPE_NAMES[code]) for _, address, code in variables]
+    lines += ["watch start %d" % interval]
+    for line in lines:
+        port.write((line + "\r\n").encode("ascii"))
+        port.flush()
+        time.sleep(0.02)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Ternion live variable watch")
+    parser.add_argument("variables", nargs="*", help="name[+offset][:type] or 0xADDRESS:type")
+    parser.add_argument("--elf", default=DEFAULT_ELF, help="ELF file of the application")
+    parser.add_argument("--list", action="store_true", help="list the data symbols of the ELF file")
+    parser.add_argument("--port", help="serial port, e.g. COM3 or /dev/tty.usbserial-140")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--interval", type=int, default=10, help="ticks (ms) between the frames")
+    parser.add_argument("--file", help="decode a raw capture instead of a serial port")
+    parser.add_argument("--out", default="watch.csv", help="output CSV file")
+    parser.add_argument("--plot", action="store_true", help="live plot (matplotlib)")
+    parser.add_argument("--duration", type=float, default=0, help="stop after N seconds (0: until Ctrl+C)")
+    args = parser.parse_args()
+
+    symbols = {}
+    if args.list or any(not v[:1].isdigit() for v in args.variables):
+        symbols = read_symbols(args.elf)
+    if args.list:
+        for name, (address, size) in sorted(symbols.items(), key=lambda item: item[1]):
+            if RAM_START <= address < RAM_END:
+                print("0x%04X %4d %s" % (address, size, name))
+        return
+
+    if not args.port and not args.file:
+        parser.error("--port or --file is required")
+    if len(args.variables) > ENTRY_MAX:
+        parser.error("at most %d variables" % ENTRY_MAX)
+    try:
+        variables = [resolve(spec, symbols) for spec in args.variables]
+    except ValueError as error:
+        sys.exit(str(error))
+    if args.port and not variables:
+        parser.error("no variables to watch")
+
+    plotter = Plotter(0 if args.file else 1000) if args.plot else None
+    with open(args.out, "w") as writer:
+        receiver = Receiver(writer, [label for label, _, _ in variables], plotter)
+        start = time.time()
+
+        try:
+            if args.file:
+                with open(args.file, "rb") as source:
+                    receiver.feed(source.read())
+                if plotter:
+                    plotter.draw()
+                    plotter.plt.show(block=True)
+            else:
+                import serial
+                with serial.Serial(args.port, args.baud, timeout=0.05) as port:
+                    configure(port, variables, args.interval)
+                    try:
+                        while not args.duration or time.time() - start < args.duration:
+                            receiver.feed(port.read(4096))
+                            if plotter:
+                                plotter.draw()
+                    finally:
+                        port.write(b"watch stop\r\n")
+        except KeyboardInterrupt:
+            pass
+
+        print("frames:      %d" % receiver.frames)
+        print("gaps:        %d (%d frames lost)" % (receiver.gaps, receiver.lost_frames))
+        print("crc errors:  %d" % receiver.crc_errors)
+
+
+if __name__ == "__main__":
+    main()